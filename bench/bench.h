@@ -0,0 +1,172 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace apollo
+{
+namespace bench
+{
+using Clock = std::chrono::steady_clock;
+
+struct BenchmarkResult
+{
+    std::string name_;         // Benchmark name, e.g. "snapshot-read"
+    std::string label_;        // Variant of the benchmark, e.g. "getSnapshot/threads=4"
+    std::uint64_t iterations_;  // Number of operations performed
+    double seconds_;           // Wall time spent on the operations
+    std::map<std::string, double> counters_;  // Extra measurements, e.g. "bytes"
+};
+
+class Reporter
+{
+public:
+    void report(const std::string& name, const std::string& label, std::uint64_t iterations, double seconds)
+    {
+        results_.push_back({name, label, iterations, seconds, {}});
+    }
+
+    void report(const std::string& name,
+                const std::string& label,
+                std::uint64_t iterations,
+                double seconds,
+                std::map<std::string, double> counters)
+    {
+        results_.push_back({name, label, iterations, seconds, std::move(counters)});
+    }
+
+    const std::vector<BenchmarkResult>& results() const
+    {
+        return results_;
+    }
+
+private:
+    std::vector<BenchmarkResult> results_;
+};
+
+// Sizes of the synthetic payloads and load of the benchmarks, set from the command line in main.cpp.
+struct Options
+{
+    std::vector<int> keys_ = {100, 1000, 10000};  // Keys per namespace, each benchmark runs once per count
+    std::vector<int> namespaces_ = {1, 16, 128};  // Namespaces per notifications request
+    int value_size_ = 64;                          // Bytes per configuration value
+    std::chrono::milliseconds duration_{300};      // Measurement time of the time bound benchmarks
+
+    // Reader threads double from 1 up to max_threads_.
+    int max_threads_ = std::max(8, static_cast<int>(std::thread::hardware_concurrency()));
+};
+
+Options& options();
+
+// Synthetic configurations of `keys` dotted keys, values of options().value_size_ bytes with characters
+// to escape in JSON. Values differ from one release to the next.
+std::map<std::string, std::string> syntheticConfigures(int keys, int release = 0);
+
+// Label of a synthetic payload, e.g. "keys=1000/value=64".
+std::string payloadLabel(int keys);
+
+using BenchmarkFunc = void (*)(Reporter& reporter);
+
+struct Benchmark
+{
+    const char* name_;
+    BenchmarkFunc func_;
+};
+
+inline std::vector<Benchmark>& benchmarks()
+{
+    static std::vector<Benchmark> registered;
+    return registered;
+}
+
+struct BenchmarkRegistrar
+{
+    BenchmarkRegistrar(const char* name, BenchmarkFunc func)
+    {
+        benchmarks().push_back({name, func});
+    }
+};
+
+#define APOLLO_BENCH_CONCAT_IMPL(a, b) a##b
+#define APOLLO_BENCH_CONCAT(a, b) APOLLO_BENCH_CONCAT_IMPL(a, b)
+#define APOLLO_BENCHMARK(name, reporter)                                                          \
+    static void APOLLO_BENCH_CONCAT(apollo_benchmark_, __LINE__)(::apollo::bench::Reporter & reporter); \
+    static ::apollo::bench::BenchmarkRegistrar APOLLO_BENCH_CONCAT(apollo_benchmark_registrar_, __LINE__)( \
+        name, &APOLLO_BENCH_CONCAT(apollo_benchmark_, __LINE__));                                \
+    static void APOLLO_BENCH_CONCAT(apollo_benchmark_, __LINE__)(::apollo::bench::Reporter & reporter)
+
+// Heap bytes currently allocated and the number of allocations so far,
+// tracked by the global operator new replacement in main.cpp.
+std::size_t allocatedBytes();
+std::uint64_t allocationCount();
+
+// Keeps the compiler from optimizing away a computed value.
+template <class T>
+inline void doNotOptimize(const T& value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "g"(&value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+inline double secondsSince(Clock::time_point start)
+{
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// Runs op() on `threads` threads concurrently for `duration`, returns the total number of calls.
+template <class Op>
+std::uint64_t runConcurrently(int threads, std::chrono::milliseconds duration, const Op& op)
+{
+    std::atomic<bool> started{false};
+    std::atomic<bool> stopped{false};
+    std::atomic<std::uint64_t> total{0};
+    std::vector<std::thread> workers;
+
+    for (int i = 0; i < threads; ++i)
+    {
+        workers.emplace_back(
+            [&]()
+            {
+                while (!started.load(std::memory_order_acquire))
+                {
+                    std::this_thread::yield();
+                }
+
+                std::uint64_t count = 0;
+                while (!stopped.load(std::memory_order_relaxed))
+                {
+                    // Check the stop flag once per batch to keep it out of the measured loop.
+                    for (int j = 0; j < 64; ++j)
+                    {
+                        op();
+                    }
+                    count += 64;
+                }
+                total.fetch_add(count, std::memory_order_relaxed);
+            });
+    }
+
+    started.store(true, std::memory_order_release);
+    std::this_thread::sleep_for(duration);
+    stopped.store(true, std::memory_order_relaxed);
+
+    for (auto& worker : workers)
+    {
+        worker.join();
+    }
+    return total.load();
+}
+
+}  // namespace bench
+}  // namespace apollo
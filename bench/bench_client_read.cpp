@@ -0,0 +1,73 @@
+#include <string>
+#include "apollo/apollo_client.h"
+#include "bench.h"
+#include "mock_apollo_server.h"
+
+namespace ac = apollo::client;
+namespace ab = apollo::bench;
+
+namespace
+{
+const ac::NamespaceType read_namespace = "application";
+
+// Measures the reads of the public API on 1 to options().max_threads_ threads, against a client
+// initialized from the mock server with a namespace of `keys` keys.
+template <class Read>
+void runClientReads(ab::Reporter& reporter, const ac::ClientPtr& client, const std::string& variant, int keys, const Read& read)
+{
+    for (int threads = 1; threads <= ab::options().max_threads_; threads *= 2)
+    {
+        auto start = ab::Clock::now();
+        auto iterations = ab::runConcurrently(threads, ab::options().duration_, [&]() { read(*client); });
+        reporter.report("client-read",
+                        variant + "/" + ab::payloadLabel(keys) + "/threads=" + std::to_string(threads),
+                        iterations,
+                        ab::secondsSince(start));
+    }
+}
+}  // namespace
+
+APOLLO_BENCHMARK("client-read", reporter)
+{
+    apollo::mock::MockApolloServer server;
+    server.start();
+
+    for (int keys : ab::options().keys_)
+    {
+        auto configures = ab::syntheticConfigures(keys);
+        const std::string key = configures.begin()->first;
+        server.setRelease(read_namespace, configures, "release-" + std::to_string(keys));
+
+        ac::Opts opts;
+        opts.namespaces_ = {read_namespace};
+        auto client = ac::makeApolloClient(server.url(), "bench_app", std::move(opts));
+
+        runClientReads(reporter,
+                       client,
+                       "getConfigures",
+                       keys,
+                       [](ac::ApolloClient& c)
+                       {
+                           auto read = c.getConfigures(read_namespace);
+                           ab::doNotOptimize(read);
+                       });
+        runClientReads(reporter,
+                       client,
+                       "getSnapshot",
+                       keys,
+                       [](ac::ApolloClient& c)
+                       {
+                           auto read = c.getSnapshot(read_namespace);
+                           ab::doNotOptimize(read);
+                       });
+        runClientReads(reporter,
+                       client,
+                       "getValue",
+                       keys,
+                       [&key](ac::ApolloClient& c)
+                       {
+                           auto read = c.getValue(read_namespace, key);
+                           ab::doNotOptimize(read);
+                       });
+    }
+}
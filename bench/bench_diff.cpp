@@ -0,0 +1,105 @@
+#include <string>
+#include <utility>
+#include "apollo_utility.h"
+#include "bench.h"
+
+namespace ac = apollo::client;
+namespace ab = apollo::bench;
+
+namespace
+{
+constexpr int diff_rounds = 20;
+
+// The lookup based diff ConfiguresDiff replaced, kept as the baseline.
+ac::Changes lookupDiff(const ac::Configures& old_config, const ac::Configures& new_config)
+{
+    ac::Changes changes;
+    for (const auto& pair : new_config)
+    {
+        auto it = old_config.find(pair.first);
+        if (it == old_config.end())
+        {
+            changes.emplace_back(ac::ChangeType::Added, pair.first, pair.second);
+        }
+        else if (it->second != pair.second)
+        {
+            changes.emplace_back(ac::ChangeType::Updated, pair.first, pair.second);
+        }
+    }
+
+    for (const auto& pair : old_config)
+    {
+        if (new_config.find(pair.first) == new_config.end())
+        {
+            changes.emplace_back(ac::ChangeType::Deleted, pair.first, pair.second);
+        }
+    }
+    return changes;
+}
+
+// Changes one key in every `every` keys: a third updated, a third deleted, a third added.
+ac::Configures changeEvery(const ac::Configures& configures, int every)
+{
+    ac::Configures changed = configures;
+    int i = 0;
+    for (const auto& p : configures)
+    {
+        if (i % every == 0)
+        {
+            switch (i / every % 3)
+            {
+                case 0:
+                    changed[p.first] = p.second + "-updated";
+                    break;
+                case 1:
+                    changed.erase(p.first);
+                    break;
+                default:
+                    changed.emplace(p.first + "-added", p.second);
+                    break;
+            }
+        }
+        ++i;
+    }
+    return changed;
+}
+
+template <class Diff>
+void runDiff(ab::Reporter& reporter,
+             const std::string& variant,
+             int keys,
+             const ac::Configures& old_config,
+             const ac::Configures& new_config,
+             const std::string& changes_label,
+             Diff diff)
+{
+    std::size_t changes = 0;
+    auto start = ab::Clock::now();
+    for (int round = 0; round < diff_rounds; ++round)
+    {
+        auto result = diff(old_config, new_config);
+        changes = result.size();
+        ab::doNotOptimize(result);
+    }
+    reporter.report("configures-diff",
+                    variant + "/" + ab::payloadLabel(keys) + "/changes=" + changes_label,
+                    diff_rounds,
+                    ab::secondsSince(start),
+                    {{"changes", static_cast<double>(changes)}});
+}
+}  // namespace
+
+APOLLO_BENCHMARK("configures-diff", reporter)
+{
+    for (int keys : ab::options().keys_)
+    {
+        auto configures = ab::syntheticConfigures(keys);
+        for (const auto& fraction : {std::make_pair(1000, "0.1%"), std::make_pair(100, "1%")})
+        {
+            auto changed = changeEvery(configures, fraction.first);
+            std::string label = fraction.second;
+            runDiff(reporter, "lookup", keys, configures, changed, label, lookupDiff);
+            runDiff(reporter, "merge-walk", keys, configures, changed, label, ac::ConfiguresDiff);
+        }
+    }
+}
@@ -0,0 +1,82 @@
+#include <string>
+#include "apollo_internal.h"
+#include "bench.h"
+#include "frozen_configures.h"
+
+namespace ac = apollo::client;
+namespace ab = apollo::bench;
+
+namespace
+{
+constexpr std::size_t frozen_iteration_bytes = 64 * 1024 * 1024;  // bytes scanned per iteration measurement
+
+ac::Configures makeConfigures(int keys)
+{
+    ac::Configures configures;
+    for (int i = 0; i < keys; ++i)
+    {
+        // Keys and values longer than the small string buffer, as typical dotted Apollo keys are.
+        configures.emplace("service.module.feature.setting." + std::to_string(i),
+                           "value-" + std::to_string(i * 7919) + std::string(i % 24, 'x'));
+    }
+    return configures;
+}
+
+std::size_t scan(const ac::Configures& configures)
+{
+    std::size_t bytes = 0;
+    for (const auto& p : configures)
+    {
+        bytes += p.first.size() + p.second.size() + static_cast<unsigned char>(p.second.back());
+    }
+    return bytes;
+}
+
+std::size_t scan(const ac::FrozenConfigures& frozen)
+{
+    std::size_t bytes = 0;
+    frozen.forEach([&bytes](ac::StringView key, ac::StringView value)
+                   { bytes += key.size() + value.size() + static_cast<unsigned char>(value.back()); });
+    return bytes;
+}
+
+template <class Storage>
+void runStorage(ab::Reporter& reporter, const std::string& variant, int keys, const ac::Configures& source)
+{
+    // Memory: heap bytes and allocations held by the storage.
+    auto bytes_before = ab::allocatedBytes();
+    auto allocations_before = ab::allocationCount();
+    auto build_start = ab::Clock::now();
+    Storage storage(source);
+    auto build_seconds = ab::secondsSince(build_start);
+    auto bytes = ab::allocatedBytes() - bytes_before;
+    auto allocations = ab::allocationCount() - allocations_before;
+
+    std::string label = variant + "/keys=" + std::to_string(keys);
+    reporter.report("frozen-build",
+                    label,
+                    static_cast<std::uint64_t>(keys),
+                    build_seconds,
+                    {{"bytes", static_cast<double>(bytes)}, {"allocations", static_cast<double>(allocations)}});
+
+    // Iteration: scan the same amount of entries whatever the namespace size.
+    int rounds = static_cast<int>(frozen_iteration_bytes / (bytes ? bytes : 1)) + 1;
+    auto scan_start = ab::Clock::now();
+    for (int i = 0; i < rounds; ++i)
+    {
+        auto scanned = scan(storage);
+        ab::doNotOptimize(scanned);
+    }
+    reporter.report("frozen-iterate", label, static_cast<std::uint64_t>(rounds) * keys, ab::secondsSince(scan_start));
+}
+}  // namespace
+
+APOLLO_BENCHMARK("frozen-storage", reporter)
+{
+    for (int keys : {1000, 10000, 100000})
+    {
+        auto source = makeConfigures(keys);
+        runStorage<ac::Configures>(reporter, "Configures", keys, source);
+        runStorage<ac::FrozenConfigures>(reporter, "FrozenConfigures", keys, source);
+    }
+}
@@ -0,0 +1,83 @@
+#include <string>
+#include "apollo_utility.h"
+#include "bench.h"
+
+namespace ac = apollo::client;
+namespace ab = apollo::bench;
+
+namespace
+{
+constexpr int json_rounds = 20000;
+
+ac::Notifications makeNotifications(int namespaces)
+{
+    ac::Notifications notifications;
+    for (int i = 0; i < namespaces; ++i)
+    {
+        notifications.push_back({"application.namespace." + std::to_string(i), 1000 + i});
+    }
+    return notifications;
+}
+
+template <class Op>
+void runJson(ab::Reporter& reporter, const std::string& variant, const std::string& label, std::size_t bytes, Op op)
+{
+    auto allocations_before = ab::allocationCount();
+    auto start = ab::Clock::now();
+    for (int round = 0; round < json_rounds; ++round)
+    {
+        op();
+    }
+    auto seconds = ab::secondsSince(start);
+    auto allocations = ab::allocationCount() - allocations_before;
+
+    reporter.report("notifications-json",
+                    variant + "/" + label,
+                    json_rounds,
+                    seconds,
+                    {{"MB/s", static_cast<double>(bytes) * json_rounds / seconds / 1e6},
+                     {"allocations/op", static_cast<double>(allocations) / json_rounds}});
+}
+}  // namespace
+
+// The bodies of /notifications/v2: the request parameter written per long poll and the response read back.
+APOLLO_BENCHMARK("notifications-json", reporter)
+{
+    ac::Notification single{"application", 1000};
+    auto single_body = ac::toJsonString(single);
+    runJson(reporter, "toJsonString(Notification)", "namespaces=1", single_body.size(),
+            [&single]()
+            {
+                auto body = ac::toJsonString(single);
+                ab::doNotOptimize(body);
+            });
+    runJson(reporter, "fromJsonString(Notification)", "namespaces=1", single_body.size(),
+            [&single_body]()
+            {
+                ac::Notification notification;
+                bool ok = ac::fromJsonString(single_body, notification);
+                ab::doNotOptimize(ok);
+                ab::doNotOptimize(notification);
+            });
+
+    for (int namespaces : ab::options().namespaces_)
+    {
+        auto notifications = makeNotifications(namespaces);
+        auto body = ac::toJsonString(notifications);
+        auto label = "namespaces=" + std::to_string(namespaces);
+        runJson(reporter, "toJsonString(Notifications)", label, body.size(),
+                [&notifications]()
+                {
+                    auto written = ac::toJsonString(notifications);
+                    ab::doNotOptimize(written);
+                });
+        runJson(reporter, "fromJsonString(Notifications)", label, body.size(),
+                [&body]()
+                {
+                    ac::Notifications parsed;
+                    bool ok = ac::fromJsonString(body, parsed);
+                    ab::doNotOptimize(ok);
+                    ab::doNotOptimize(parsed);
+                });
+    }
+}
@@ -0,0 +1,76 @@
+#include <string>
+#include "apollo_utility.h"
+#include "bench.h"
+#include "nlohmann/json.hpp"
+
+namespace ac = apollo::client;
+namespace ab = apollo::bench;
+
+namespace
+{
+constexpr std::size_t parse_bytes_per_variant = 64 * 1024 * 1024;  // bytes parsed per measurement
+
+// The DOM based parse fromJsonString replaced, kept as the baseline.
+bool domParse(const std::string& body, std::string& release_key, ac::Configures& configures)
+{
+    try
+    {
+        auto j = nlohmann::json::parse(body);
+        j.at("releaseKey").get_to(release_key);
+        j.at("configurations").get_to(configures);
+        return true;
+    }
+    catch (const std::exception&)
+    {
+        return false;
+    }
+}
+
+// A /configs response as served by Apollo with the synthetic configurations of `keys` keys.
+std::string makeBody(int keys)
+{
+    nlohmann::json j = {{"appId", "bench_app"},
+                        {"cluster", "default"},
+                        {"namespaceName", "application"},
+                        {"configurations", ab::syntheticConfigures(keys)},
+                        {"releaseKey", "20240101000000-0123456789abcdef"}};
+    return j.dump();
+}
+
+template <class Parse>
+void runParse(ab::Reporter& reporter, const std::string& variant, const std::string& label, const std::string& body, Parse parse)
+{
+    int rounds = static_cast<int>(parse_bytes_per_variant / body.size()) + 1;
+    auto allocations_before = ab::allocationCount();
+    auto start = ab::Clock::now();
+    for (int round = 0; round < rounds; ++round)
+    {
+        std::string release_key;
+        ac::Configures configures;
+        bool ok = parse(body, release_key, configures);
+        ab::doNotOptimize(ok);
+        ab::doNotOptimize(configures);
+    }
+    auto seconds = ab::secondsSince(start);
+    auto allocations = ab::allocationCount() - allocations_before;
+
+    reporter.report("configs-parse",
+                    variant + "/" + label,
+                    static_cast<std::uint64_t>(rounds),
+                    seconds,
+                    {{"MB/s", static_cast<double>(body.size()) * rounds / seconds / 1e6},
+                     {"allocations/op", static_cast<double>(allocations) / rounds}});
+}
+}  // namespace
+
+APOLLO_BENCHMARK("configs-parse", reporter)
+{
+    for (int keys : ab::options().keys_)
+    {
+        auto body = makeBody(keys);
+        auto label = ab::payloadLabel(keys) + "/bytes=" + std::to_string(body.size());
+        runParse(reporter, "dom", label, body, domParse);
+        runParse(reporter, "sax", label, body, [](const std::string& b, std::string& release_key, ac::Configures& c)
+                 { return ac::fromJsonString(b, release_key, c); });
+    }
+}
@@ -0,0 +1,144 @@
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "apollo_internal.h"
+#include "bench.h"
+
+namespace ac = apollo::client;
+namespace ab = apollo::bench;
+
+namespace
+{
+constexpr int snapshot_keys = 200;
+constexpr auto snapshot_publish_interval = std::chrono::milliseconds(10);
+
+ac::Configures makeConfigures(int keys, int release)
+{
+    ac::Configures configures;
+    for (int i = 0; i < keys; ++i)
+    {
+        configures.emplace("app.config.key." + std::to_string(i),
+                           "value-" + std::to_string(release) + "-" + std::to_string(i));
+    }
+    return configures;
+}
+
+// The publication of the baseline: the configures copied under the namespace mutex.
+class MutexConfigures
+{
+public:
+    void SetConfigures(ac::Configures&& configures)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        configures_ = std::move(configures);
+    }
+
+    ac::Configures GetConfigures() const
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        return configures_;
+    }
+
+private:
+    ac::Configures configures_;
+    mutable std::mutex mutex_;
+};
+
+// A snapshot guarded by a mutex, only the pointer is copied under it.
+class MutexSnapshot
+{
+public:
+    void SetConfigures(ac::Configures&& configures)
+    {
+        auto snapshot = std::make_shared<const ac::Configures>(std::move(configures));
+        std::unique_lock<std::mutex> lock(mutex_);
+        snapshot_.swap(snapshot);
+    }
+
+    ac::ConfiguresPtr GetSnapshot() const
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        return snapshot_;
+    }
+
+private:
+    ac::ConfiguresPtr snapshot_;
+    mutable std::mutex mutex_;
+};
+
+// A snapshot published by the atomic operations of std::shared_ptr, locked by libstdc++ in a global pool.
+class StdAtomicSnapshot
+{
+public:
+    void SetConfigures(ac::Configures&& configures)
+    {
+        std::atomic_store(&snapshot_, std::make_shared<const ac::Configures>(std::move(configures)));
+    }
+
+    ac::ConfiguresPtr GetSnapshot() const
+    {
+        return std::atomic_load(&snapshot_);
+    }
+
+private:
+    ac::ConfiguresPtr snapshot_;
+};
+
+// Measures read throughput while a writer keeps publishing new releases, as the long polling thread would.
+template <class Store, class Read>
+void runReaders(ab::Reporter& reporter, const std::string& variant, const Read& read)
+{
+    for (int threads = 1; threads <= ab::options().max_threads_; threads *= 2)
+    {
+        Store store;
+        store.SetConfigures(makeConfigures(snapshot_keys, 0));
+
+        std::atomic<bool> stop_writer{false};
+        std::thread writer(
+            [&]()
+            {
+                int release = 1;
+                while (!stop_writer.load())
+                {
+                    store.SetConfigures(makeConfigures(snapshot_keys, release++));
+                    std::this_thread::sleep_for(snapshot_publish_interval);
+                }
+            });
+
+        auto start = ab::Clock::now();
+        auto iterations = ab::runConcurrently(threads, ab::options().duration_, [&]() { read(store); });
+        auto seconds = ab::secondsSince(start);
+
+        stop_writer.store(true);
+        writer.join();
+
+        reporter.report("snapshot-read", variant + "/threads=" + std::to_string(threads), iterations, seconds);
+    }
+}
+
+template <class Store>
+void readConfigures(const Store& store)
+{
+    auto configures = store.GetConfigures();
+    ab::doNotOptimize(configures);
+}
+
+template <class Store>
+void readSnapshot(const Store& store)
+{
+    auto snapshot = store.GetSnapshot();
+    ab::doNotOptimize(snapshot);
+}
+}  // namespace
+
+// The baselines guard the configures by a mutex, or publish them by std::atomic_load and std::atomic_store,
+// NamespaceAttributes publishes its releases without lock.
+APOLLO_BENCHMARK("snapshot-read", reporter)
+{
+    runReaders<MutexConfigures>(reporter, "mutex/GetConfigures", readConfigures<MutexConfigures>);
+    runReaders<MutexSnapshot>(reporter, "mutex/GetSnapshot", readSnapshot<MutexSnapshot>);
+    runReaders<StdAtomicSnapshot>(reporter, "std::atomic_load/GetSnapshot", readSnapshot<StdAtomicSnapshot>);
+    runReaders<ac::NamespaceAttributes>(reporter, "GetConfigures", readConfigures<ac::NamespaceAttributes>);
+    runReaders<ac::NamespaceAttributes>(reporter, "GetSnapshot", readSnapshot<ac::NamespaceAttributes>);
+}
@@ -0,0 +1,78 @@
+#include <cstdio>
+#include <string>
+#include "apollo/apollo_client.h"
+#include "bench.h"
+#include "mock_apollo_server.h"
+#include "snapshot_cache.h"
+
+namespace ac = apollo::client;
+namespace ab = apollo::bench;
+
+namespace
+{
+constexpr int startup_namespaces = 40;
+constexpr int startup_keys = 100;
+constexpr int startup_rounds = 3;
+constexpr auto startup_latency = std::chrono::milliseconds(20);  // simulated server round trip
+}  // namespace
+
+APOLLO_BENCHMARK("startup-latency", reporter)
+{
+    apollo::mock::MockApolloServer server;
+    std::vector<ac::NamespaceType> namespaces;
+    for (int n = 0; n < startup_namespaces; ++n)
+    {
+        ac::Configures configures;
+        for (int k = 0; k < startup_keys; ++k)
+        {
+            configures.emplace("key." + std::to_string(k), "value-" + std::to_string(k));
+        }
+        auto ns = "namespace" + std::to_string(n);
+        server.setRelease(ns, configures, "release-" + std::to_string(n));
+        namespaces.push_back(ns);
+    }
+    server.setLatency(startup_latency);
+    server.start();
+
+    for (int concurrency : {1, 4, 8, startup_namespaces})
+    {
+        auto start = ab::Clock::now();
+        for (int round = 0; round < startup_rounds; ++round)
+        {
+            ac::Opts opts;
+            opts.namespaces_ = namespaces;
+            opts.initial_fetch_concurrency_ = concurrency;
+            auto client = ac::makeApolloClient(server.url(), "bench_app", std::move(opts));
+            ab::doNotOptimize(client);
+        }
+        reporter.report("startup-latency",
+                        "namespaces=" + std::to_string(startup_namespaces) +
+                            "/concurrency=" + std::to_string(concurrency),
+                        startup_rounds,
+                        ab::secondsSince(start));
+    }
+
+    // Startup from the on-disk cache, written by a first client; the server is not contacted.
+    ac::Opts cache_opts;
+    cache_opts.namespaces_ = namespaces;
+    cache_opts.initial_fetch_concurrency_ = startup_namespaces;
+    cache_opts.cache_dir_ = ".";
+    ac::makeApolloClient(server.url(), "bench_app", ac::Opts(cache_opts));
+
+    auto start = ab::Clock::now();
+    for (int round = 0; round < startup_rounds; ++round)
+    {
+        auto client = ac::makeApolloClient(server.url(), "bench_app", ac::Opts(cache_opts));
+        ab::doNotOptimize(client);
+    }
+    reporter.report("startup-latency",
+                    "namespaces=" + std::to_string(startup_namespaces) + "/cache",
+                    startup_rounds,
+                    ab::secondsSince(start));
+
+    ac::SnapshotCache cache(".", "bench_app", "default");
+    for (const auto& ns : namespaces)
+    {
+        std::remove(cache.path(ns).c_str());
+    }
+}
@@ -0,0 +1,92 @@
+#include <memory>
+#include <string>
+#include "apollo_utility.h"
+#include "bench.h"
+#include "url_builder.h"
+
+namespace ac = apollo::client;
+namespace ab = apollo::bench;
+
+namespace
+{
+constexpr int url_rounds = 20000;
+const std::string url_server = "http://127.0.0.1:8080";
+const std::string url_app_id = "bench_app";
+const std::string url_cluster = "default";
+const std::string url_label = "gray-release";
+
+template <class Build>
+void runUrl(ab::Reporter& reporter, const std::string& variant, const Build& build)
+{
+    std::size_t bytes = 0;
+    auto allocations_before = ab::allocationCount();
+    auto start = ab::Clock::now();
+    for (int round = 0; round < url_rounds; ++round)
+    {
+        const auto& url = build();
+        bytes = url.size();
+        ab::doNotOptimize(url);
+    }
+    auto seconds = ab::secondsSince(start);
+    auto allocations = ab::allocationCount() - allocations_before;
+
+    reporter.report("url-build",
+                    variant,
+                    url_rounds,
+                    seconds,
+                    {{"bytes", static_cast<double>(bytes)},
+                     {"allocations/op", static_cast<double>(allocations) / url_rounds}});
+}
+}  // namespace
+
+// The urls built for every long poll and for every changed namespace fetched.
+APOLLO_BENCHMARK("url-build", reporter)
+{
+    for (int namespaces : ab::options().namespaces_)
+    {
+        ac::NamespaceAttributesMap attributes;
+        for (int i = 0; i < namespaces; ++i)
+        {
+            auto namespace_attributes = std::make_shared<ac::NamespaceAttributes>();
+            namespace_attributes->SetNotificationId(1000 + i);
+            attributes.emplace("application.namespace." + std::to_string(i), std::move(namespace_attributes));
+        }
+
+        runUrl(reporter,
+               "createNotificationsV2URL/namespaces=" + std::to_string(namespaces),
+               [&attributes]()
+               { return ac::createNotificationsV2URL(url_app_id, url_server, url_cluster, url_label, attributes); });
+
+        // Every poll follows a release of one namespace.
+        ac::NotificationsURLBuilder builder(url_app_id, url_server, url_cluster, url_label, attributes);
+        auto& changed = *attributes.begin()->second;
+        runUrl(reporter,
+               "NotificationsURLBuilder/namespaces=" + std::to_string(namespaces),
+               [&builder, &attributes, &changed]() -> const std::string&
+               {
+                   changed.SetNotificationId(changed.GetNotificationId() + 1);
+                   return builder.build(attributes);
+               });
+    }
+
+    const ac::NamespaceType s_namespace = "application.namespace.0";
+    const std::string release_key = "20240101000000-0123456789abcdef";
+    ac::NamespaceAttributesMap attributes = {{s_namespace, std::make_shared<ac::NamespaceAttributes>()}};
+    ac::ConfigsURLBuilder builder(url_app_id, url_server, url_cluster, url_label, attributes);
+    runUrl(reporter,
+           "ConfigsURLBuilder",
+           [&]() { return builder.build(s_namespace, release_key, 1000); });
+
+    runUrl(reporter,
+           "createNoCacheConfigsURL",
+           []()
+           {
+               return ac::createNoCacheConfigsURL(url_app_id,
+                                                  url_server,
+                                                  url_cluster,
+                                                  "application.namespace.0",
+                                                  url_label,
+                                                  "20240101000000-0123456789abcdef",
+                                                  1000);
+           });
+}
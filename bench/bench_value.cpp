@@ -0,0 +1,93 @@
+#include <string>
+#include <vector>
+#include "apollo_internal.h"
+#include "bench.h"
+
+namespace ac = apollo::client;
+namespace ab = apollo::bench;
+
+namespace
+{
+constexpr int value_namespace_keys = 1000;
+constexpr int value_keys_per_request = 50;
+constexpr int value_requests = 20000;
+
+// Looks up value_keys_per_request keys per simulated request, the way a request handler reads its settings.
+template <class Lookup>
+void runLookups(ab::Reporter& reporter, const std::string& variant, const Lookup& lookup)
+{
+    ac::Configures configures;
+    for (int i = 0; i < value_namespace_keys; ++i)
+    {
+        configures.emplace("service.feature.key." + std::to_string(i), "value-" + std::to_string(i));
+    }
+    ac::NamespaceAttributes attributes;
+    attributes.SetConfigures(std::move(configures));
+
+    std::vector<std::string> keys;
+    for (int i = 0; i < value_keys_per_request; ++i)
+    {
+        keys.push_back("service.feature.key." + std::to_string(i * 19 % value_namespace_keys));
+    }
+
+    auto start = ab::Clock::now();
+    for (int r = 0; r < value_requests; ++r)
+    {
+        lookup(attributes, keys);
+    }
+    reporter.report("value-lookup",
+                    variant + "/keys=" + std::to_string(value_keys_per_request),
+                    static_cast<std::uint64_t>(value_requests) * value_keys_per_request,
+                    ab::secondsSince(start));
+}
+}  // namespace
+
+APOLLO_BENCHMARK("value-lookup", reporter)
+{
+    runLookups(reporter,
+               "GetConfigures+find",
+               [](const ac::NamespaceAttributes& attributes, const std::vector<std::string>& keys)
+               {
+                   auto configures = attributes.GetConfigures();
+                   for (const auto& key : keys)
+                   {
+                       auto it = configures.find(key);
+                       ab::doNotOptimize(it);
+                   }
+               });
+
+    runLookups(reporter,
+               "GetSnapshot+find",
+               [](const ac::NamespaceAttributes& attributes, const std::vector<std::string>& keys)
+               {
+                   auto snapshot = attributes.GetSnapshot();
+                   for (const auto& key : keys)
+                   {
+                       auto it = snapshot->find(key);
+                       ab::doNotOptimize(it);
+                   }
+               });
+
+    runLookups(reporter,
+               "GetValue",
+               [](const ac::NamespaceAttributes& attributes, const std::vector<std::string>& keys)
+               {
+                   for (const auto& key : keys)
+                   {
+                       auto value = attributes.GetValue(key);
+                       ab::doNotOptimize(value);
+                   }
+               });
+
+    runLookups(reporter,
+               "GetRelease+index",
+               [](const ac::NamespaceAttributes& attributes, const std::vector<std::string>& keys)
+               {
+                   auto release = attributes.GetRelease();
+                   for (const auto& key : keys)
+                   {
+                       auto value = release->index_.find(key);
+                       ab::doNotOptimize(value);
+                   }
+               });
+}
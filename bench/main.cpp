@@ -0,0 +1,232 @@
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <boost/program_options.hpp>
+#include "bench.h"
+#include "nlohmann/json.hpp"
+
+namespace po = boost::program_options;
+namespace ab = apollo::bench;
+
+namespace
+{
+// Every allocation carries its size in a header so operator delete can account for it.
+constexpr std::size_t allocation_header = alignof(std::max_align_t);
+std::atomic<std::size_t> allocated_bytes{0};
+std::atomic<std::uint64_t> allocation_count{0};
+}  // namespace
+
+void* operator new(std::size_t size)
+{
+    auto* p = static_cast<unsigned char*>(std::malloc(size + allocation_header));
+    if (p == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    *reinterpret_cast<std::size_t*>(p) = size;
+    allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    return p + allocation_header;
+}
+
+void operator delete(void* ptr) noexcept
+{
+    if (ptr == nullptr)
+    {
+        return;
+    }
+    auto* p = static_cast<unsigned char*>(ptr) - allocation_header;
+    allocated_bytes.fetch_sub(*reinterpret_cast<std::size_t*>(p), std::memory_order_relaxed);
+    std::free(p);
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    operator delete(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    operator delete(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept
+{
+    operator delete(ptr);
+}
+
+std::size_t apollo::bench::allocatedBytes()
+{
+    return allocated_bytes.load(std::memory_order_relaxed);
+}
+
+std::uint64_t apollo::bench::allocationCount()
+{
+    return allocation_count.load(std::memory_order_relaxed);
+}
+
+ab::Options& apollo::bench::options()
+{
+    static Options parsed;
+    return parsed;
+}
+
+namespace
+{
+void printTable(std::FILE* out, const ab::Reporter& reporter)
+{
+    std::fprintf(out, "%-28s %-56s %14s %14s %16s\n", "benchmark", "label", "iterations", "ns/op", "ops/s");
+    for (const auto& r : reporter.results())
+    {
+        double ns_per_op = r.iterations_ ? r.seconds_ * 1e9 / static_cast<double>(r.iterations_) : 0.0;
+        double ops_per_sec = r.seconds_ > 0 ? static_cast<double>(r.iterations_) / r.seconds_ : 0.0;
+        std::fprintf(out,
+                     "%-28s %-56s %14llu %14.1f %16.0f",
+                     r.name_.c_str(),
+                     r.label_.c_str(),
+                     static_cast<unsigned long long>(r.iterations_),
+                     ns_per_op,
+                     ops_per_sec);
+        for (const auto& counter : r.counters_)
+        {
+            std::fprintf(out, "  %s=%.0f", counter.first.c_str(), counter.second);
+        }
+        std::fprintf(out, "\n");
+    }
+}
+
+// One object per result, keyed by benchmark and label so runs of two commits can be joined.
+nlohmann::json toJson(const ab::Reporter& reporter, const std::string& tag)
+{
+    const auto& options = ab::options();
+    nlohmann::json results = nlohmann::json::array();
+    for (const auto& r : reporter.results())
+    {
+        results.push_back({{"benchmark", r.name_},
+                           {"label", r.label_},
+                           {"iterations", r.iterations_},
+                           {"seconds", r.seconds_},
+                           {"ns_per_op", r.iterations_ ? r.seconds_ * 1e9 / static_cast<double>(r.iterations_) : 0.0},
+                           {"counters", r.counters_}});
+    }
+    return {{"tag", tag},
+            {"options",
+             {{"keys", options.keys_},
+              {"namespaces", options.namespaces_},
+              {"value_size", options.value_size_},
+              {"max_threads", options.max_threads_},
+              {"duration_ms", options.duration_.count()}}},
+            {"results", results}};
+}
+}  // namespace
+
+int main(int argc, char* argv[])
+{
+    auto& options = ab::options();
+    std::string filter;
+    std::string format = "table";
+    std::string output;
+    std::string tag;
+    int duration_ms = static_cast<int>(options.duration_.count());
+
+    po::options_description desc("Apollo C++ Client Benchmarks");
+
+    // clang-format off
+    desc.add_options()
+    ("help,h", "Print help message")
+    ("filter,f", po::value<std::string>(&filter), "Only run the benchmarks whose name contains the filter")
+    ("keys,k", po::value<std::vector<int>>(&options.keys_)->multitoken(), "Keys per synthetic namespace (default: 100 1000 10000)")
+    ("namespaces,n", po::value<std::vector<int>>(&options.namespaces_)->multitoken(), "Namespaces per notifications request (default: 1 16 128)")
+    ("value-size,v", po::value<int>(&options.value_size_), "Bytes per synthetic value (default: 64)")
+    ("threads,t", po::value<int>(&options.max_threads_), "Maximum reader threads (default: the larger of 8 and the cores)")
+    ("duration-ms,d", po::value<int>(&duration_ms), "Measurement time of the time bound benchmarks (default: 300)")
+    ("format", po::value<std::string>(&format), "Results format: table or json (default: table)")
+    ("output,o", po::value<std::string>(&output), "Write the results to this file instead of stdout")
+    ("tag", po::value<std::string>(&tag), "Recorded with json results, e.g. the commit measured");
+    // clang-format on
+
+    po::positional_options_description positional;
+    positional.add("filter", 1);
+
+    try
+    {
+        po::variables_map vm;
+        po::store(po::command_line_parser(argc, argv).options(desc).positional(positional).run(), vm);
+        if (vm.count("help"))
+        {
+            std::cout << desc << std::endl;
+            return 0;
+        }
+        po::notify(vm);
+
+        if (format != "table" && format != "json")
+        {
+            throw std::invalid_argument("format must be table or json");
+        }
+        if (options.value_size_ <= 0 || options.max_threads_ <= 0 || duration_ms <= 0)
+        {
+            throw std::invalid_argument("value-size, threads and duration-ms must be greater than 0");
+        }
+        for (int count : options.keys_)
+        {
+            if (count <= 0)
+            {
+                throw std::invalid_argument("keys must be greater than 0");
+            }
+        }
+        for (int count : options.namespaces_)
+        {
+            if (count <= 0)
+            {
+                throw std::invalid_argument("namespaces must be greater than 0");
+            }
+        }
+        options.duration_ = std::chrono::milliseconds(duration_ms);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Error: " << e.what() << std::endl;
+        std::cerr << desc << std::endl;
+        return 1;
+    }
+
+    ab::Reporter reporter;
+    for (const auto& benchmark : ab::benchmarks())
+    {
+        if (!filter.empty() && std::string(benchmark.name_).find(filter) == std::string::npos)
+        {
+            continue;
+        }
+        std::cerr << "running " << benchmark.name_ << " ..." << std::endl;
+        benchmark.func_(reporter);
+    }
+
+    std::FILE* out = output.empty() ? stdout : std::fopen(output.c_str(), "w");
+    if (out == nullptr)
+    {
+        std::cerr << "Error: cannot write " << output << std::endl;
+        return 1;
+    }
+
+    if (format == "json")
+    {
+        std::fprintf(out, "%s\n", toJson(reporter, tag).dump(2).c_str());
+    }
+    else
+    {
+        printTable(out, reporter);
+    }
+
+    if (out != stdout)
+    {
+        std::fclose(out);
+    }
+    return 0;
+}
@@ -0,0 +1,28 @@
+#include <string>
+#include "bench.h"
+
+namespace apollo
+{
+namespace bench
+{
+std::map<std::string, std::string> syntheticConfigures(int keys, int release)
+{
+    std::map<std::string, std::string> configures;
+    auto value_size = static_cast<std::size_t>(options().value_size_);
+    for (int i = 0; i < keys; ++i)
+    {
+        std::string value =
+            "{\"release\":" + std::to_string(release) + ",\"endpoint\":\"http://service-" + std::to_string(i) + "\"}";
+        value.resize(value_size, 'v');
+        configures.emplace("service.module.feature.setting." + std::to_string(i), std::move(value));
+    }
+    return configures;
+}
+
+std::string payloadLabel(int keys)
+{
+    return "keys=" + std::to_string(keys) + "/value=" + std::to_string(options().value_size_);
+}
+
+}  // namespace bench
+}  // namespace apollo
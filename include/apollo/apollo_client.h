@@ -6,7 +6,9 @@
 
 #pragma once
 #include <functional>
+#include <typeinfo>
 #include "apollo_types.h"
+#include "apollo_value_parser.h"
 
 namespace apollo
 {
@@ -39,8 +41,9 @@ public:
      * @brief Starts a long polling thread for configuration updates
      *
      * Starts a background thread that periodically polls the Apollo server for
-     * configuration updates. When changes are detected, the notification callback
-     * (if set) will be invoked from the background thread.
+     * configuration updates. When changes are detected, they are published and the notification
+     * callback (if set) is invoked from a listener thread, see Opts::listener_threads_. The polling thread checks every
+     * namespace once per Opts::refresh_interval_ms_, in case a change notification was missed.
      *
      * @param long_polling_interval_ms Interval in milliseconds between polling requests.
      * If set to 0 or negative, long polling thread will not be started and configuration will not be updated.
@@ -54,7 +57,8 @@ public:
      *
      * Stops the background polling thread if it's running. After calling this method,
      * no further configuration updates will be received and no callbacks will be triggered.
-     * This method blocks until the polling thread has terminated.
+     * This method blocks until the polling thread has terminated; requests in flight,
+     * including a long poll held by the server, are aborted rather than waited for.
      */
     virtual void stopLongPolling() = 0;
 
@@ -74,6 +78,99 @@ public:
      */
     virtual Configures getConfigures(const NamespaceType& s_namespace) = 0;
 
+    /**
+     * @brief Retrieves an immutable snapshot of the configuration values
+     *
+     * Returns the current configuration snapshot for the specified namespace without copying it.
+     * Snapshots are published atomically by the long polling thread, so the returned snapshot
+     * never changes; a newer release is visible to the next call only.
+     *
+     * @param s_namespace The namespace to retrieve the snapshot from
+     * @return A shared pointer to the configuration key-value pairs,
+     *         or nullptr if the namespace is not in the configured namespaces list
+     *
+     * @note Prefer this over getConfigures() on hot paths: it takes no lock and
+     *       does not allocate.
+     */
+    virtual ConfiguresPtr getSnapshot(const NamespaceType& s_namespace) = 0;
+
+    /**
+     * @brief Retrieves a single configuration value without copying
+     *
+     * Looks the key up in a hash index built once per release, so the lookup costs O(1)
+     * and does not allocate. The returned pointer pins the release the value belongs to,
+     * it stays valid after newer releases are published.
+     *
+     * @param s_namespace The namespace to retrieve the value from
+     * @param key The configuration key
+     * @return A shared pointer to the value, or nullptr if the namespace is not in the
+     *         configured namespaces list or the key does not exist
+     */
+    virtual ValuePtr getValue(const NamespaceType& s_namespace, const std::string& key) = 0;
+
+    /**
+     * @brief Retrieves a single configuration value, or a default if it does not exist
+     *
+     * Same as getValue(), but never returns nullptr.
+     *
+     * @param s_namespace The namespace to retrieve the value from
+     * @param key The configuration key
+     * @param default_value The value returned if the namespace or the key does not exist
+     * @return A shared pointer to the value or to a copy of default_value
+     *
+     * @note The default path allocates, to copy default_value. Hot paths pass a default
+     *       created once to the ValuePtr overload instead.
+     */
+    virtual ValuePtr getValueOr(const NamespaceType& s_namespace,
+                                const std::string& key,
+                                const std::string& default_value) = 0;
+
+    /**
+     * @brief Retrieves a single configuration value, or a shared default if it does not exist
+     *
+     * Same as getValue(), but returns default_value instead of nullptr. Neither path allocates.
+     *
+     * @param s_namespace The namespace to retrieve the value from
+     * @param key The configuration key
+     * @param default_value The value returned if the namespace or the key does not exist, e.g. created once
+     * @return A shared pointer to the value, or default_value
+     */
+    virtual ValuePtr getValueOr(const NamespaceType& s_namespace,
+                                const std::string& key,
+                                const ValuePtr& default_value) = 0;
+
+    /**
+     * @brief Retrieves a single configuration value parsed as T
+     *
+     * The value is parsed by ValueParser<T> on the first read of the key as T and cached with the
+     * release, until a newer release is published. Repeated reads neither parse nor allocate.
+     * The returned pointer pins the release the value was parsed from.
+     *
+     * @tparam T bool, an integer or floating point type, std::string, a std::chrono::duration,
+     *         or any type ValueParser is specialized for
+     * @param s_namespace The namespace to retrieve the value from
+     * @param key The configuration key
+     * @return A shared pointer to the parsed value, or nullptr if the namespace is not in the
+     *         configured namespaces list, the key does not exist or its value cannot be parsed as T
+     */
+    template <class T>
+    std::shared_ptr<const T> get(const NamespaceType& s_namespace, const std::string& key)
+    {
+        return std::static_pointer_cast<const T>(getParsedValue(s_namespace, key, typeid(T), &parseValue<T>));
+    }
+
+    /**
+     * @brief Retrieves a single configuration value parsed as T, or a default
+     *
+     * Same as get(), but returns default_value instead of nullptr.
+     */
+    template <class T>
+    T getOr(const NamespaceType& s_namespace, const std::string& key, const T& default_value)
+    {
+        auto value = get<T>(s_namespace, key);
+        return value ? *value : default_value;
+    }
+
     /**
      * @brief Sets a callback for configuration change notifications
      *
@@ -88,14 +185,140 @@ public:
      * @note It's recommended to set the callback before calling startLongPolling() to avoid
      *       missing any changes. The callback should be thread-safe as it's called from a
      *       background thread. This function can be called repeatedly to change the callback.
+     * @note The callback runs after the change was published, getSnapshot() already returns the new
+     *       configurations. Changes of a namespace are delivered in order; those published while the
+     *       previous one still waits for the callback are merged, the callback then receives the
+     *       configurations it saw last and the latest ones.
      */
     virtual void setNotificationsListener(NotificationCallbackPtr notificationCallback) = 0;
+
+    /**
+     * @brief Adds a callback for the changes of some keys of a namespace
+     *
+     * Any number of listeners can be added besides the one of setNotificationsListener(). A listener is
+     * invoked only if the change of a release touches its keys, and receives only the changes of its keys
+     * along with the whole old and new configurations. Listeners are indexed by namespace and key, the
+     * cost of a change does not depend on the number of listeners it does not match.
+     *
+     * @param s_namespace The namespace to listen to
+     * @param notificationCallback A weak pointer to the callback function, an expired callback is skipped
+     * @param key The key, or key prefix, to listen to
+     * @param match Whether key is matched exactly or as a prefix; the defaults select every key
+     * @return The id to pass to removeNotificationsListener()
+     *
+     * @note The callback is invoked like the one of setNotificationsListener(), and may be added
+     *       or removed from any thread, including from a callback.
+     */
+    virtual ListenerId addNotificationsListener(const NamespaceType& s_namespace,
+                                                NotificationCallbackPtr notificationCallback,
+                                                const std::string& key = "",
+                                                KeyMatch match = KeyMatch::Prefix) = 0;
+
+    /**
+     * @brief Removes a listener added by addNotificationsListener()
+     *
+     * @param id The id returned by addNotificationsListener(), unknown ids are ignored
+     *
+     * @note A callback already queued for delivery may still be invoked once.
+     */
+    virtual void removeNotificationsListener(ListenerId id) = 0;
+
+    /**
+     * @brief Retrieves the propagation latency metrics of long polling
+     *
+     * @return A copy of the metrics accumulated since the client was created
+     */
+    virtual LongPollingMetrics getLongPollingMetrics() = 0;
+
+    /**
+     * @brief Retrieves the size of the responses received from the server
+     *
+     * @return A copy of the metrics accumulated since the client was created
+     */
+    virtual TransferMetrics getTransferMetrics() = 0;
+
+    /**
+     * @brief Retrieves the delivery metrics of the notification callback
+     *
+     * @return A copy of the metrics accumulated since the client was created,
+     *         of all the clients sharing the runtime if Opts::runtime_ is set
+     */
+    virtual ListenerMetrics getListenerMetrics() = 0;
+
+    /**
+     * @brief Retrieves every metric of the client at once
+     *
+     * Latency, parse time and payload size histograms, failures by cause, propagation delay and
+     * per-namespace staleness, along with the long polling, transfer and listener metrics.
+     * The counters are recorded without locks; see formatPrometheusMetrics() to export them.
+     *
+     * @return A snapshot of the metrics accumulated since the client was created
+     */
+    virtual ClientMetrics getClientMetrics() = 0;
+
+protected:
+    /**
+     * @brief Retrieves the value of key parsed by parse, cached by type for the current release, see get()
+     */
+    virtual ParsedValuePtr getParsedValue(const NamespaceType& s_namespace,
+                                          const std::string& key,
+                                          const std::type_info& type,
+                                          ValueParseFunction parse) = 0;
+};
+
+/**
+ * @class ApolloRuntime
+ * @brief Threads and connections shared by Apollo clients
+ *
+ * Clients created with the same runtime in Opts::runtime_ multiplex their long polls and fetches over
+ * its threads and its keep-alive connection pool, each client being serialized on a strand of its own.
+ * The number of threads does not depend on the number of clients. Clients keep their runtime alive.
+ */
+class ApolloRuntime
+{
+public:
+    /**
+     * @brief Virtual destructor to ensure proper cleanup in derived classes
+     */
+    virtual ~ApolloRuntime() = default;
+
+    /**
+     * @brief Returns the number of threads running the I/O of the clients
+     */
+    virtual std::size_t threadCount() const = 0;
 };
 
+/**
+ * @brief Creates a runtime to be shared by Apollo clients, its threads are started immediately
+ *
+ * @param opts Runtime options including the number of threads
+ * @return A shared pointer to the runtime, to be set in Opts::runtime_
+ * @throws std::invalid_argument If the options are invalid
+ *
+ * @note makeApolloClient() and ApolloClient::stopLongPolling() block until their requests completed,
+ *       they must not be called from a notification callback of a client sharing the runtime.
+ */
+RuntimePtr makeApolloRuntime(RuntimeOpts&& opts = RuntimeOpts());
+
+/**
+ * @brief Formats metrics in the Prometheus text exposition format
+ *
+ * Metrics are named apollo_client_*, durations are converted to seconds. Histograms are exported
+ * with cumulative buckets, staleness as a gauge per namespace.
+ *
+ * @param metrics The metrics returned by ApolloClient::getClientMetrics()
+ * @param labels Labels added to every sample, e.g. {{"app_id", "my_app"}} to tell clients apart
+ * @return The text to serve on a /metrics endpoint
+ */
+std::string formatPrometheusMetrics(const ClientMetrics& metrics, const std::map<std::string, std::string>& labels = {});
+
 /**
  * @brief Creates a new Apollo client instance
  *
  * The method will connect to the Apollo server and load configurations for initialization when created.
+ * If Opts::cache_dir_ holds a cached release of every namespace, the client is created from the cache
+ * without contacting the server, and the first long poll fetches the namespaces that changed since.
+ * Such a client is reconciled with the server only once startLongPolling() is called.
  *
  * @param apollo_url Apollo server URL (e.g., "http://apollo-service:8080" or "http://apollo-server.com")
  * @param app_id Application ID registered in Apollo Configuration Center
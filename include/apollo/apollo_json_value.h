@@ -0,0 +1,39 @@
+/**
+ * @file apollo_json_value.h
+ * @brief Parser of the JSON configuration values returned by ApolloClient::get(), requires nlohmann_json
+ * @copyright Licensed under the Apache License, Version 2.0
+ */
+
+#pragma once
+
+#include <string>
+#include <utility>
+#include <nlohmann/json.hpp>
+#include "apollo/apollo_value_parser.h"
+
+namespace apollo
+{
+namespace client
+{
+/**
+ * @brief Accepts a JSON document, parsed once per release like any other typed value
+ *
+ * Included on its own, so that only the applications reading JSON values depend on nlohmann_json.
+ */
+template <>
+struct ValueParser<nlohmann::json>
+{
+    static bool parse(const std::string& value, nlohmann::json& out)
+    {
+        auto parsed = nlohmann::json::parse(value, nullptr, false);
+        if (parsed.is_discarded())
+        {
+            return false;
+        }
+        out = std::move(parsed);
+        return true;
+    }
+};
+
+}  // namespace client
+}  // namespace apollo
@@ -6,6 +6,8 @@
 
 #pragma once
 
+#include <chrono>
+#include <cstdint>
 #include <map>
 #include <memory>
 #include <vector>
@@ -61,9 +63,45 @@ struct Change
 /** @brief List of configuration changes */
 using Changes = std::vector<Change>;
 
+/** @brief Identifier of a listener added by ApolloClient::addNotificationsListener() */
+using ListenerId = std::uint64_t;
+
+/**
+ * @enum KeyMatch
+ * @brief How the key of a listener selects the changes it receives
+ */
+enum class KeyMatch
+{
+    Exact, /**< The changes of the key itself */
+    Prefix /**< The changes of the keys starting with the key, an empty key selects every key */
+};
+
 /** @brief Map of key-value pairs representing a namespace's configuration */
 using Configures = std::map<std::string, std::string>;
 
+/** @brief Immutable snapshot of a namespace's configuration, shared between readers */
+using ConfiguresPtr = std::shared_ptr<const Configures>;
+
+/** @brief A single configuration value, keeps the snapshot it belongs to alive */
+using ValuePtr = std::shared_ptr<const std::string>;
+
+class ApolloRuntime;
+/** @brief Threads and connections shared by clients, see makeApolloRuntime() */
+using RuntimePtr = std::shared_ptr<ApolloRuntime>;
+
+/**
+ * @struct RuntimeOpts
+ * @brief Options for configuring a runtime shared by Apollo clients
+ */
+struct RuntimeOpts
+{
+    int thread_count_ = 1; /**< The number of threads running the I/O of all the clients */
+    int max_connections_per_host_ = 16; /**< The maximum number of keep-alive connections kept per host, shared by the clients */
+    int connection_idle_timeout_ms_ = 15000; /**< The time in milliseconds after which an idle keep-alive connection is closed */
+    int dns_cache_ttl_ms_ = 60000; /**< The time in milliseconds a host name resolution is cached, 0 disables the cache */
+    int listener_threads_ = 1; /**< The number of threads running the notification callbacks of all the clients, 0 runs them on the I/O threads */
+};
+
 /**
  * @struct Opts
  * @brief Options for configuring the Apollo client
@@ -77,6 +115,157 @@ struct Opts
     int connection_timeout_ms_ = 500; /**< The timeout for establishing a connection in milliseconds */
     int request_read_timeout_ms_ = 120000; /**< The timeout for read HTTP response in milliseconds*/
     int request_write_timeout_ms_ = 3000;  /**< The timeout for sent HTTP request in milliseconds */
+    int initial_fetch_concurrency_ = 8; /**< The maximum number of namespaces fetched concurrently at creation */
+    int update_fetch_concurrency_ = 8; /**< The maximum number of changed namespaces fetched concurrently by each long poll */
+    int long_polling_max_namespaces_ = 0; /**< The maximum number of namespaces per long poll, more are split into concurrent long polls, 0 for no limit */
+    int long_polling_max_url_length_ = 8000; /**< The maximum length in bytes of a long poll url, more namespaces are split into concurrent long polls, 0 for no limit */
+    int max_connections_per_host_ = 4; /**< The maximum number of keep-alive connections kept per host, 0 disables keep-alive */
+    int connection_idle_timeout_ms_ = 15000; /**< The time in milliseconds after which an idle keep-alive connection is closed */
+    int dns_cache_ttl_ms_ = 60000; /**< The time in milliseconds a host name resolution is cached, 0 disables the cache */
+    std::string cache_dir_ = ""; /**< Existing directory where releases are cached on disk, empty disables the cache. A client started from the cache is reconciled with the server only by long polling, without it the cached releases are served until the client is recreated */
+    bool compressed_transfer_ = false; /**< Whether responses are requested gzip or deflate compressed */
+    int refresh_interval_ms_ = 300000; /**< The interval in milliseconds at which every namespace is checked for a release missed by long polling, 0 disables it */
+    int listener_threads_ = 1; /**< The number of threads running the notification callbacks, 0 runs them on the long polling thread */
+    std::string meta_server_url_ = ""; /**< Meta server listing the config service instances at /services/config, requests go to the fastest healthy one. Empty sends every request to apollo_url, which is also used while no instance is listed */
+    int service_discovery_interval_ms_ = 60000; /**< The interval in milliseconds at which the config service instances are listed again */
+    RuntimePtr runtime_ = nullptr; /**< Runtime shared with other clients, nullptr for a thread and connections of the client's own. A shared runtime overrides max_connections_per_host_, connection_idle_timeout_ms_, dns_cache_ttl_ms_ and listener_threads_ */
+};
+
+/**
+ * @struct LongPollingMetrics
+ * @brief Propagation latency of the long polling cycles and outcome of the consistency refreshes
+ *
+ * A cycle starts when a long poll returns changed namespaces and ends once all of them were fetched.
+ * The long polls of the shards of the namespaces, see Opts::long_polling_max_url_length_, run cycles of their own.
+ * Latencies are measured from the long poll response to the publication of a namespace.
+ */
+struct LongPollingMetrics
+{
+    std::uint64_t cycles_ = 0;               /**< The number of completed cycles */
+    std::uint64_t namespaces_published_ = 0; /**< The number of namespaces published by all cycles */
+    std::uint64_t fetch_failures_ = 0;       /**< The number of changed namespaces that failed to be fetched */
+    std::size_t last_cycle_namespaces_ = 0;  /**< The number of namespaces published by the last cycle */
+    std::chrono::microseconds last_cycle_first_publish_{0}; /**< Latency of the first namespace published by the last cycle */
+    std::chrono::microseconds last_cycle_last_publish_{0};  /**< Latency of the last namespace published by the last cycle */
+    std::chrono::microseconds max_cycle_last_publish_{0};   /**< Highest last_cycle_last_publish_ of all cycles */
+    std::uint64_t refreshes_ = 0;              /**< The number of consistency refreshes completed */
+    std::uint64_t refreshes_not_modified_ = 0; /**< The number of refreshes answered 304, the release was current */
+    std::uint64_t refreshes_published_ = 0;    /**< The number of refreshes that published a release missed by long polling */
+    std::size_t shards_ = 0;                   /**< The number of concurrent long polls the namespaces are split into */
+};
+
+/**
+ * @struct TransferMetrics
+ * @brief Size of the responses received from the server
+ *
+ * Compressed responses are decoded while they are read, the ratio of wire_bytes_ to decoded_bytes_
+ * shows what compression saves.
+ */
+struct TransferMetrics
+{
+    std::uint64_t responses_ = 0;            /**< The number of responses received */
+    std::uint64_t compressed_responses_ = 0; /**< The number of responses received compressed */
+    std::uint64_t wire_bytes_ = 0;           /**< Bytes of the response bodies as received */
+    std::uint64_t decoded_bytes_ = 0;        /**< Bytes of the response bodies once decompressed */
+};
+
+/**
+ * @struct ResolverMetrics
+ * @brief Host name resolutions, cached for Opts::dns_cache_ttl_ms_
+ *
+ * The clients of a shared runtime share its cache, and so these counters.
+ */
+struct ResolverMetrics
+{
+    std::uint64_t hits_ = 0;             /**< Lookups served from the cache, fresh or expired */
+    std::uint64_t misses_ = 0;           /**< Lookups that waited for the resolver */
+    std::uint64_t refreshes_ = 0;        /**< Resolutions of expired entries started */
+    std::uint64_t refresh_failures_ = 0; /**< Refreshes that failed, the expired addresses were kept */
+};
+
+/**
+ * @struct ListenerMetrics
+ * @brief Delivery of the changes to the notification callback
+ *
+ * While a change of a namespace waits for a callback thread, a newer change of the same namespace is merged
+ * into it, so at most one change per namespace is queued and a slow callback sees fewer, larger changes.
+ * Latencies are measured from the publication of the oldest merged change to the start of the callback.
+ */
+struct ListenerMetrics
+{
+    std::uint64_t events_ = 0;     /**< The number of changes published */
+    std::uint64_t coalesced_ = 0;  /**< The number of changes merged into one still queued */
+    std::uint64_t callbacks_ = 0;  /**< The number of callbacks run */
+    std::size_t queue_depth_ = 0;     /**< The number of changes queued now */
+    std::size_t max_queue_depth_ = 0; /**< Highest queue_depth_ so far */
+    std::chrono::microseconds last_delivery_latency_{0};  /**< Time the last change waited for its callback */
+    std::chrono::microseconds max_delivery_latency_{0};   /**< Highest last_delivery_latency_ so far */
+    std::chrono::microseconds last_callback_duration_{0}; /**< Time the last callback ran */
+    std::chrono::microseconds max_callback_duration_{0};  /**< Highest last_callback_duration_ so far */
+};
+
+/**
+ * @struct ConfigServiceMetrics
+ * @brief Health of a config service instance discovered from the meta server, see Opts::meta_server_url_
+ *
+ * Averages are exponentially weighted, recent requests weigh most. Long polls, held by the server, count
+ * in the failure rate only.
+ */
+struct ConfigServiceMetrics
+{
+    std::string url_;                    /**< Base url of the instance */
+    std::chrono::microseconds latency_{0}; /**< Average latency of its successful requests, 0 until one completed */
+    double failure_rate_ = 0;            /**< Average failure rate of its requests, from 0 to 1 */
+    std::uint64_t requests_ = 0;         /**< The number of requests routed to the instance */
+    std::uint64_t failures_ = 0;         /**< The number of requests that failed */
+    bool selected_ = false;              /**< Whether the next requests are routed to the instance */
+};
+
+/**
+ * @struct HistogramMetrics
+ * @brief Distribution of a measure over fixed buckets
+ */
+struct HistogramMetrics
+{
+    std::vector<std::uint64_t> bounds_; /**< Inclusive upper bounds of the buckets, in increasing order */
+    std::vector<std::uint64_t> counts_; /**< Observations per bucket, the last one counts those above every bound */
+    std::uint64_t count_ = 0;           /**< The number of observations */
+    std::uint64_t sum_ = 0;             /**< The sum of the observations */
+};
+
+/**
+ * @struct FailureMetrics
+ * @brief Failed requests by cause, requests aborted by stopLongPolling() are not counted
+ */
+struct FailureMetrics
+{
+    std::uint64_t timeouts_ = 0;       /**< Connection, write or read timed out */
+    std::uint64_t network_errors_ = 0; /**< Resolution, connection or transfer failed */
+    std::uint64_t http_errors_ = 0;    /**< Answered with an unexpected HTTP status */
+    std::uint64_t parse_errors_ = 0;   /**< The body was not valid JSON of the expected shape, or could not be decoded */
+};
+
+/**
+ * @struct ClientMetrics
+ * @brief Snapshot of every metric of a client, see formatPrometheusMetrics()
+ *
+ * Latencies and times are in microseconds, sizes in bytes.
+ */
+struct ClientMetrics
+{
+    HistogramMetrics long_poll_latency_; /**< Round trip of the long polls, including the time the server held them */
+    HistogramMetrics fetch_latency_;     /**< Round trip of the configurations fetches, at creation, after a notification or to refresh */
+    HistogramMetrics parse_time_;        /**< Time spent parsing each response body as it was read */
+    HistogramMetrics payload_size_;      /**< Size of each response body, once decoded */
+    HistogramMetrics propagation_delay_; /**< From the long poll response to the publication of each changed namespace */
+    FailureMetrics long_poll_failures_;  /**< Failed long polls */
+    FailureMetrics fetch_failures_;      /**< Failed configurations fetches */
+    std::map<NamespaceType, std::chrono::milliseconds> staleness_; /**< Per namespace, time since the server last confirmed its release is current */
+    LongPollingMetrics long_polling_;
+    TransferMetrics transfer_;
+    ResolverMetrics resolver_;
+    ListenerMetrics listener_;
+    std::vector<ConfigServiceMetrics> config_services_; /**< The config service instances discovered, empty without meta server */
 };
 
 enum class LogLevel
@@ -0,0 +1,232 @@
+/**
+ * @file apollo_value_parser.h
+ * @brief Parsers of the typed configuration values returned by ApolloClient::get()
+ * @copyright Licensed under the Apache License, Version 2.0
+ */
+
+#pragma once
+
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <limits>
+#include <memory>
+#include <string>
+#include <type_traits>
+
+namespace apollo
+{
+namespace client
+{
+/**
+ * @struct ValueParser
+ * @brief Parses a configuration value into a T
+ *
+ * Specialized for bool, the integer and floating point types, std::string and std::chrono::duration,
+ * and for nlohmann::json by apollo/apollo_json_value.h. Applications can specialize it for their own
+ * types with a static `bool parse(const std::string& value, T& out)` returning false if the value is invalid.
+ */
+template <class T, class Enable = void>
+struct ValueParser;
+
+/**
+ * @brief Accepts true/false, yes/no, on/off and 1/0, case insensitive
+ */
+template <>
+struct ValueParser<bool>
+{
+    static bool parse(const std::string& value, bool& out)
+    {
+        std::string lower(value);
+        for (auto& c : lower)
+        {
+            c = static_cast<char>(c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c);
+        }
+
+        if (lower == "true" || lower == "yes" || lower == "on" || lower == "1")
+        {
+            out = true;
+            return true;
+        }
+        if (lower == "false" || lower == "no" || lower == "off" || lower == "0")
+        {
+            out = false;
+            return true;
+        }
+        return false;
+    }
+};
+
+/**
+ * @brief Accepts a decimal number that fits in T, the whole value must be consumed
+ *
+ * The value starts with a digit, or with '-' followed by a digit for a signed T: unlike strtoll, no
+ * leading whitespace nor '+' is accepted, and an unsigned T never wraps a negative value around.
+ */
+template <class T>
+struct ValueParser<T, typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value>::type>
+{
+    static bool parse(const std::string& value, T& out)
+    {
+        std::size_t digits = std::is_signed<T>::value && !value.empty() && value[0] == '-' ? 1 : 0;
+        if (value.size() <= digits || value[digits] < '0' || value[digits] > '9')
+        {
+            return false;
+        }
+
+        char* end = nullptr;
+        errno = 0;
+        T parsed;
+        if (std::is_signed<T>::value)
+        {
+            long long n = std::strtoll(value.c_str(), &end, 10);
+            if (errno != 0 || n < static_cast<long long>(std::numeric_limits<T>::min()) ||
+                n > static_cast<long long>(std::numeric_limits<T>::max()))
+            {
+                return false;
+            }
+            parsed = static_cast<T>(n);
+        }
+        else
+        {
+            unsigned long long n = std::strtoull(value.c_str(), &end, 10);
+            if (errno != 0 || n > static_cast<unsigned long long>(std::numeric_limits<T>::max()))
+            {
+                return false;
+            }
+            parsed = static_cast<T>(n);
+        }
+
+        // out is left untouched by a rejected value.
+        if (end != value.c_str() + value.size())
+        {
+            return false;
+        }
+        out = parsed;
+        return true;
+    }
+};
+
+/**
+ * @brief Accepts a decimal or scientific number, the whole value must be consumed
+ */
+template <class T>
+struct ValueParser<T, typename std::enable_if<std::is_floating_point<T>::value>::type>
+{
+    static bool parse(const std::string& value, T& out)
+    {
+        // strtold would skip leading whitespace, the value must be a number as a whole.
+        if (value.empty() || std::isspace(static_cast<unsigned char>(value[0])))
+        {
+            return false;
+        }
+
+        char* end = nullptr;
+        errno = 0;
+        long double parsed = std::strtold(value.c_str(), &end);
+        if (errno != 0 || end != value.c_str() + value.size())
+        {
+            return false;
+        }
+        out = static_cast<T>(parsed);
+        return true;
+    }
+};
+
+/**
+ * @brief Accepts any value
+ */
+template <>
+struct ValueParser<std::string>
+{
+    static bool parse(const std::string& value, std::string& out)
+    {
+        out = value;
+        return true;
+    }
+};
+
+/**
+ * @brief Accepts an integer count followed by an optional unit: ns, us, ms, s, m, h or d
+ *
+ * A count without unit is taken in the unit of the duration, e.g. "1500" is 1500 ms for
+ * std::chrono::milliseconds and "2s" is 2000 ms.
+ */
+template <class Rep, class Period>
+struct ValueParser<std::chrono::duration<Rep, Period>>
+{
+    static bool parse(const std::string& value, std::chrono::duration<Rep, Period>& out)
+    {
+        using Duration = std::chrono::duration<Rep, Period>;
+
+        auto unit_pos = value.find_first_not_of("-0123456789");
+        long long count = 0;
+        if (!ValueParser<long long>::parse(value.substr(0, unit_pos), count))
+        {
+            return false;
+        }
+
+        std::string unit = unit_pos == std::string::npos ? "" : value.substr(unit_pos);
+        if (unit.empty())
+        {
+            out = Duration(static_cast<Rep>(count));
+        }
+        else if (unit == "ns")
+        {
+            out = std::chrono::duration_cast<Duration>(std::chrono::nanoseconds(count));
+        }
+        else if (unit == "us")
+        {
+            out = std::chrono::duration_cast<Duration>(std::chrono::microseconds(count));
+        }
+        else if (unit == "ms")
+        {
+            out = std::chrono::duration_cast<Duration>(std::chrono::milliseconds(count));
+        }
+        else if (unit == "s")
+        {
+            out = std::chrono::duration_cast<Duration>(std::chrono::seconds(count));
+        }
+        else if (unit == "m")
+        {
+            out = std::chrono::duration_cast<Duration>(std::chrono::minutes(count));
+        }
+        else if (unit == "h")
+        {
+            out = std::chrono::duration_cast<Duration>(std::chrono::hours(count));
+        }
+        else if (unit == "d")
+        {
+            out = std::chrono::duration_cast<Duration>(std::chrono::hours(count * 24));
+        }
+        else
+        {
+            return false;
+        }
+        return true;
+    }
+};
+
+/** @brief A parsed value of any type, see ApolloClient::get() */
+using ParsedValuePtr = std::shared_ptr<const void>;
+
+/** @brief Parses a value into a new object, nullptr if the value is invalid */
+using ValueParseFunction = ParsedValuePtr (*)(const std::string& value);
+
+/**
+ * @brief Parses a value with ValueParser<T>, the ValueParseFunction of T
+ */
+template <class T>
+ParsedValuePtr parseValue(const std::string& value)
+{
+    T parsed;
+    if (!ValueParser<T>::parse(value, parsed))
+    {
+        return nullptr;
+    }
+    return std::make_shared<const T>(std::move(parsed));
+}
+
+}  // namespace client
+}  // namespace apollo
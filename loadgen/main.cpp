@@ -0,0 +1,403 @@
+#include <sys/resource.h>
+#include <time.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <boost/program_options.hpp>
+#include "apollo/apollo_client.h"
+#include "mock_apollo_server.h"
+#include "nlohmann/json.hpp"
+
+namespace po = boost::program_options;
+namespace ac = apollo::client;
+namespace am = apollo::mock;
+
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+// Key carrying the sequence number of each release, to match a notification to its publication.
+const std::string release_sequence_key = "loadgen.release.sequence";
+
+struct LoadOptions
+{
+    int namespaces_ = 2000;
+    int keys_ = 100000;  // Spread over the namespaces
+    int value_size_ = 64;
+    double release_rate_ = 50;  // Releases per second, each of a random namespace
+    int changed_keys_ = 1;      // Keys changed per release
+    int readers_ = 4;
+    int duration_s_ = 30;
+    int hold_ms_ = 1000;
+    int poll_interval_ms_ = 10;
+    int fetch_concurrency_ = 8;
+    int max_url_length_ = 8000;  // Of a long poll, the namespaces are split into concurrent long polls beyond it
+};
+
+double threadCpuSeconds()
+{
+    timespec ts{};
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return static_cast<double>(ts.tv_sec) + static_cast<double>(ts.tv_nsec) / 1e9;
+}
+
+double processCpuSeconds()
+{
+    timespec ts{};
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return static_cast<double>(ts.tv_sec) + static_cast<double>(ts.tv_nsec) / 1e9;
+}
+
+// Resident set size in bytes, 0 where /proc is not available.
+std::size_t residentBytes()
+{
+    std::ifstream statm("/proc/self/statm");
+    std::size_t pages = 0;
+    std::size_t resident = 0;
+    if (!(statm >> pages >> resident))
+    {
+        return 0;
+    }
+    return resident * static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+}
+
+std::size_t peakResidentBytes()
+{
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return static_cast<std::size_t>(usage.ru_maxrss) * 1024;
+}
+
+double percentile(const std::vector<double>& sorted, double p)
+{
+    if (sorted.empty())
+    {
+        return 0.0;
+    }
+    auto rank = static_cast<std::size_t>(p / 100.0 * static_cast<double>(sorted.size() - 1) + 0.5);
+    return sorted[std::min(rank, sorted.size() - 1)];
+}
+
+std::string namespaceName(int n)
+{
+    return "loadgen.namespace." + std::to_string(n);
+}
+
+ac::Configures makeConfigures(int keys, int value_size, std::uint64_t release)
+{
+    ac::Configures configures;
+    for (int i = 0; i < keys; ++i)
+    {
+        std::string value = "{\"release\":" + std::to_string(release) + ",\"key\":" + std::to_string(i) + "}";
+        value.resize(static_cast<std::size_t>(value_size), 'v');
+        configures.emplace("service.module.setting." + std::to_string(i), std::move(value));
+    }
+    configures[release_sequence_key] = std::to_string(release);
+    return configures;
+}
+
+// Publication time of every release, and the time it took to reach the listener.
+class PropagationRecorder
+{
+public:
+    void published(std::uint64_t sequence)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        published_.emplace(sequence, Clock::now());
+    }
+
+    void notified(const ac::Configures& news)
+    {
+        auto now = Clock::now();
+        auto sequence = news.find(release_sequence_key);
+        if (sequence == news.end())
+        {
+            return;
+        }
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        auto it = published_.find(std::stoull(sequence->second));
+        if (it != published_.end())
+        {
+            latencies_ms_.push_back(std::chrono::duration<double, std::milli>(now - it->second).count());
+        }
+    }
+
+    std::vector<double> sortedLatencies()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        auto sorted = latencies_ms_;
+        std::sort(sorted.begin(), sorted.end());
+        return sorted;
+    }
+
+private:
+    std::mutex mutex_;
+    std::map<std::uint64_t, Clock::time_point> published_;
+    std::vector<double> latencies_ms_;
+};
+}  // namespace
+
+int main(int argc, char* argv[])
+{
+    LoadOptions options;
+    std::string format = "table";
+
+    po::options_description desc("Apollo C++ Client Load Generator");
+
+    // clang-format off
+    desc.add_options()
+    ("help,h", "Print help message")
+    ("namespaces,n", po::value<int>(&options.namespaces_), "Namespaces of the client (default: 2000)")
+    ("keys,k", po::value<int>(&options.keys_), "Keys spread over the namespaces (default: 100000)")
+    ("value-size,v", po::value<int>(&options.value_size_), "Bytes per value (default: 64)")
+    ("release-rate,r", po::value<double>(&options.release_rate_), "Releases per second, each of a random namespace (default: 50)")
+    ("changed-keys", po::value<int>(&options.changed_keys_), "Keys changed per release (default: 1)")
+    ("readers,t", po::value<int>(&options.readers_), "Threads reading random keys during the churn (default: 4)")
+    ("duration-s,d", po::value<int>(&options.duration_s_), "Duration of the churn in seconds (default: 30)")
+    ("hold-ms", po::value<int>(&options.hold_ms_), "Longest time the server holds a long poll without change (default: 1000)")
+    ("interval-ms", po::value<int>(&options.poll_interval_ms_), "Long polling interval of the client (default: 10)")
+    ("fetch-concurrency", po::value<int>(&options.fetch_concurrency_), "Namespaces fetched concurrently (default: 8)")
+    ("max-url-length", po::value<int>(&options.max_url_length_), "Longest long poll url, more namespaces are split into concurrent long polls, 0 for no limit (default: 8000)")
+    ("format", po::value<std::string>(&format), "Report format: table or json (default: table)");
+    // clang-format on
+
+    try
+    {
+        po::variables_map vm;
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+        if (vm.count("help"))
+        {
+            std::cout << desc << std::endl;
+            return 0;
+        }
+        po::notify(vm);
+
+        if (options.namespaces_ <= 0 || options.keys_ < options.namespaces_ || options.value_size_ <= 0 ||
+            options.release_rate_ <= 0 || options.changed_keys_ <= 0 || options.readers_ < 0 ||
+            options.duration_s_ <= 0 || options.hold_ms_ < 0 || options.poll_interval_ms_ <= 0 ||
+            options.fetch_concurrency_ <= 0 || options.max_url_length_ < 0)
+        {
+            throw std::invalid_argument("invalid options, keys must be at least the number of namespaces");
+        }
+        if (format != "table" && format != "json")
+        {
+            throw std::invalid_argument("format must be table or json");
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Error: " << e.what() << std::endl;
+        std::cerr << desc << std::endl;
+        return 1;
+    }
+
+    const int keys_per_namespace = options.keys_ / options.namespaces_;
+    std::uint64_t sequence = 0;
+
+    // === Stand-in server and client ===
+    am::MockApolloServer server;
+    server.setLongPollHold(std::chrono::milliseconds(options.hold_ms_));
+    std::vector<ac::Configures> releases;
+    ac::Opts opts;
+    opts.namespaces_.clear();
+    for (int n = 0; n < options.namespaces_; ++n)
+    {
+        releases.push_back(makeConfigures(keys_per_namespace, options.value_size_, ++sequence));
+        server.setRelease(namespaceName(n), releases.back(), "release-" + std::to_string(sequence));
+        opts.namespaces_.push_back(namespaceName(n));
+    }
+    opts.initial_fetch_concurrency_ = options.fetch_concurrency_;
+    opts.update_fetch_concurrency_ = options.fetch_concurrency_;
+    opts.long_polling_max_url_length_ = options.max_url_length_;
+    server.start();
+
+    std::size_t rss_before_init = residentBytes();
+    auto init_start = Clock::now();
+    auto client = ac::makeApolloClient(server.url(), "loadgen_app", std::move(opts));
+    double init_seconds = std::chrono::duration<double>(Clock::now() - init_start).count();
+    std::size_t rss_after_init = residentBytes();
+
+    PropagationRecorder propagation;
+    auto listener = std::make_shared<ac::NotificationCallback>(
+        [&propagation](const ac::NamespaceType&, const ac::Configures&, const ac::Configures& news, ac::Changes&&)
+        { propagation.notified(news); });
+    client->setNotificationsListener(listener);
+    client->startLongPolling(options.poll_interval_ms_);
+
+    // === Churn and readers ===
+    std::atomic<bool> stop{false};
+    std::atomic<std::uint64_t> reads{0};
+    std::atomic<std::uint64_t> misses{0};
+    std::mutex cpu_mutex;
+    double tool_cpu_seconds = 0;  // CPU of the threads of the tool, not of the client
+    std::uint64_t published = 0;
+
+    double process_cpu_before = processCpuSeconds();
+    auto polls_before = client->getClientMetrics().long_poll_latency_.count_;
+    std::vector<std::thread> readers;
+    for (int r = 0; r < options.readers_; ++r)
+    {
+        readers.emplace_back(
+            [&, r]()
+            {
+                std::mt19937 random(static_cast<unsigned>(r + 1));
+                std::uniform_int_distribution<int> pick_namespace(0, options.namespaces_ - 1);
+                std::uniform_int_distribution<int> pick_key(0, keys_per_namespace - 1);
+                std::uint64_t count = 0;
+                std::uint64_t missed = 0;
+                while (!stop.load(std::memory_order_relaxed))
+                {
+                    auto value = client->getValue(namespaceName(pick_namespace(random)),
+                                                  "service.module.setting." + std::to_string(pick_key(random)));
+                    missed += value ? 0 : 1;
+                    ++count;
+                }
+                reads.fetch_add(count);
+                misses.fetch_add(missed);
+                std::unique_lock<std::mutex> lock(cpu_mutex);
+                tool_cpu_seconds += threadCpuSeconds();
+            });
+    }
+
+    auto churn_start = Clock::now();
+    std::thread churn(
+        [&]()
+        {
+            std::mt19937 random(42);
+            std::uniform_int_distribution<int> pick_namespace(0, options.namespaces_ - 1);
+            std::uniform_int_distribution<int> pick_key(0, keys_per_namespace - 1);
+            auto period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / options.release_rate_));
+            auto next = Clock::now();
+            auto end = churn_start + std::chrono::seconds(options.duration_s_);
+            while (Clock::now() < end)
+            {
+                int n = pick_namespace(random);
+                auto& configures = releases[static_cast<std::size_t>(n)];
+                ++sequence;
+                for (int c = 0; c < options.changed_keys_; ++c)
+                {
+                    configures["service.module.setting." + std::to_string(pick_key(random))] =
+                        "changed-" + std::to_string(sequence);
+                }
+                configures[release_sequence_key] = std::to_string(sequence);
+
+                propagation.published(sequence);
+                server.setRelease(namespaceName(n), configures, "release-" + std::to_string(sequence));
+                ++published;
+
+                next += period;
+                std::this_thread::sleep_until(next);
+            }
+            std::unique_lock<std::mutex> lock(cpu_mutex);
+            tool_cpu_seconds += threadCpuSeconds();
+        });
+
+    churn.join();
+    double churn_seconds = std::chrono::duration<double>(Clock::now() - churn_start).count();
+    stop.store(true);
+    for (auto& reader : readers)
+    {
+        reader.join();
+    }
+    // Let the last releases propagate.
+    std::this_thread::sleep_for(std::chrono::milliseconds(options.hold_ms_ / 2 + 100));
+    client->stopLongPolling();
+    server.stop();
+
+    // The CPU of the process during the churn, but for the server, the churn and the readers.
+    double client_cpu_seconds =
+        std::max(0.0, processCpuSeconds() - process_cpu_before - tool_cpu_seconds - server.cpuSeconds());
+    auto metrics = client->getClientMetrics();
+    auto polls = metrics.long_poll_latency_.count_ - polls_before;
+    auto latencies = propagation.sortedLatencies();
+    std::size_t rss_after = residentBytes();
+
+    nlohmann::json report = {
+        {"options",
+         {{"namespaces", options.namespaces_},
+          {"keys", options.keys_},
+          {"value_size", options.value_size_},
+          {"release_rate", options.release_rate_},
+          {"changed_keys", options.changed_keys_},
+          {"readers", options.readers_},
+          {"duration_s", options.duration_s_},
+          {"hold_ms", options.hold_ms_},
+          {"max_url_length", options.max_url_length_}}},
+        {"long_poll_shards", metrics.long_polling_.shards_},
+        {"init_seconds", init_seconds},
+        {"releases_published", published},
+        {"releases_notified", latencies.size()},
+        {"polls", polls},
+        {"client_cpu_seconds", client_cpu_seconds},
+        {"client_cpu_ms_per_poll", polls ? client_cpu_seconds * 1e3 / static_cast<double>(polls) : 0.0},
+        {"propagation_ms",
+         {{"p50", percentile(latencies, 50)},
+          {"p90", percentile(latencies, 90)},
+          {"p99", percentile(latencies, 99)},
+          {"max", latencies.empty() ? 0.0 : latencies.back()}}},
+        {"reads_per_second", static_cast<double>(reads.load()) / churn_seconds},
+        {"read_misses", misses.load()},
+        {"rss_bytes",
+         {{"before_init", rss_before_init},
+          {"after_init", rss_after_init},
+          {"after_churn", rss_after},
+          {"peak", peakResidentBytes()}}},
+        {"fetch_failures",
+         metrics.fetch_failures_.timeouts_ + metrics.fetch_failures_.network_errors_ +
+             metrics.fetch_failures_.http_errors_ + metrics.fetch_failures_.parse_errors_}};
+
+    if (format == "json")
+    {
+        std::cout << report.dump(2) << std::endl;
+        return 0;
+    }
+
+    std::printf("namespaces %d, keys %d, value size %d, %.1f releases/s for %d s, %d readers\n",
+                options.namespaces_,
+                options.keys_,
+                options.value_size_,
+                options.release_rate_,
+                options.duration_s_,
+                options.readers_);
+    std::printf("%-28s %.3f s\n", "init", init_seconds);
+    std::printf("%-28s %llu published, %zu notified\n",
+                "releases",
+                static_cast<unsigned long long>(published),
+                latencies.size());
+    std::printf("%-28s %llu, %zu concurrent long polls\n",
+                "polls",
+                static_cast<unsigned long long>(polls),
+                metrics.long_polling_.shards_);
+    std::printf("%-28s %.3f s, %.3f ms/poll\n",
+                "client cpu",
+                client_cpu_seconds,
+                report["client_cpu_ms_per_poll"].get<double>());
+    std::printf("%-28s p50 %.1f ms, p90 %.1f ms, p99 %.1f ms, max %.1f ms\n",
+                "propagation",
+                percentile(latencies, 50),
+                percentile(latencies, 90),
+                percentile(latencies, 99),
+                latencies.empty() ? 0.0 : latencies.back());
+    std::printf("%-28s %.0f reads/s, %llu misses\n",
+                "reads during churn",
+                report["reads_per_second"].get<double>(),
+                static_cast<unsigned long long>(misses.load()));
+    std::printf("%-28s %.1f MB before init, %.1f MB after init, %.1f MB after churn, %.1f MB peak\n",
+                "rss",
+                static_cast<double>(rss_before_init) / 1e6,
+                static_cast<double>(rss_after_init) / 1e6,
+                static_cast<double>(rss_after) / 1e6,
+                static_cast<double>(peakResidentBytes()) / 1e6);
+    return 0;
+}
@@ -0,0 +1,184 @@
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <boost/asio/signal_set.hpp>
+#include <boost/program_options.hpp>
+#include "mock_apollo_server.h"
+#include "nlohmann/json.hpp"
+
+namespace po = boost::program_options;
+namespace am = apollo::mock;
+
+namespace
+{
+am::MockApolloServer::Endpoint parseEndpoint(const std::string& name)
+{
+    if (name == "configs")
+    {
+        return am::MockApolloServer::Endpoint::Configs;
+    }
+    if (name == "notifications")
+    {
+        return am::MockApolloServer::Endpoint::Notifications;
+    }
+    if (name == "services")
+    {
+        return am::MockApolloServer::Endpoint::Services;
+    }
+    if (name == "any")
+    {
+        return am::MockApolloServer::Endpoint::Any;
+    }
+    throw std::invalid_argument("unknown endpoint: " + name);
+}
+
+am::MockApolloServer::Failure parseFailure(const std::string& name)
+{
+    if (name == "server-error")
+    {
+        return am::MockApolloServer::Failure::ServerError;
+    }
+    if (name == "not-found")
+    {
+        return am::MockApolloServer::Failure::NotFound;
+    }
+    if (name == "close-connection")
+    {
+        return am::MockApolloServer::Failure::CloseConnection;
+    }
+    if (name == "malformed-body")
+    {
+        return am::MockApolloServer::Failure::MalformedBody;
+    }
+    if (name == "empty-body")
+    {
+        return am::MockApolloServer::Failure::EmptyBody;
+    }
+    if (name == "slow")
+    {
+        return am::MockApolloServer::Failure::Slow;
+    }
+    if (name == "no-response")
+    {
+        return am::MockApolloServer::Failure::NoResponse;
+    }
+    throw std::invalid_argument("unknown failure: " + name);
+}
+
+// Loads a script of releases and failures, e.g.
+// {"releases": [{"namespace": "application", "releaseKey": "r1", "configurations": {"k": "v"}},
+//               {"namespace": "application", "releaseKey": "r2", "configurations": {"k": "v2"}, "afterMs": 5000}],
+//  "failures": [{"endpoint": "configs", "failure": "server-error", "count": 2}],
+//  "configServices": ["http://127.0.0.1:8081", "http://127.0.0.1:8082"]}
+// A release without afterMs is published before the server starts, notify defaults to true.
+void loadScript(const std::string& path, am::MockApolloServer& server)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        throw std::invalid_argument("cannot read script: " + path);
+    }
+    std::stringstream content;
+    content << file.rdbuf();
+    auto script = nlohmann::json::parse(content.str());
+
+    for (const auto& release : script.value("releases", nlohmann::json::array()))
+    {
+        auto s_namespace = release.at("namespace").get<std::string>();
+        auto release_key = release.at("releaseKey").get<std::string>();
+        auto configures = release.value("configurations", apollo::client::Configures());
+        bool notify = release.value("notify", true);
+        if (release.contains("afterMs"))
+        {
+            server.scheduleRelease(std::chrono::milliseconds(release.at("afterMs").get<int>()),
+                                   s_namespace,
+                                   configures,
+                                   release_key,
+                                   notify);
+        }
+        else
+        {
+            server.setRelease(s_namespace, configures, release_key, notify);
+        }
+    }
+
+    for (const auto& failure : script.value("failures", nlohmann::json::array()))
+    {
+        server.failRequests(parseEndpoint(failure.value("endpoint", "any")),
+                            parseFailure(failure.at("failure").get<std::string>()),
+                            failure.value("count", 1));
+    }
+
+    if (script.contains("configServices"))
+    {
+        server.setConfigServices(script.at("configServices").get<std::vector<std::string>>());
+    }
+}
+}  // namespace
+
+int main(int argc, char* argv[])
+{
+    int port = 8080;
+    int hold_ms = 60000;
+    int latency_ms = 0;
+    std::string script;
+    bool compression = false;
+
+    po::options_description desc("Mock Apollo Server Options");
+
+    // clang-format off
+    desc.add_options()
+    ("help,h", "Print help message")
+    ("port,p", po::value<int>(&port), "Port to listen on 127.0.0.1, 0 for an ephemeral one (default: 8080)")
+    ("script,s", po::value<std::string>(&script), "JSON script of the releases and failures to serve")
+    ("hold-ms", po::value<int>(&hold_ms), "Longest time a long poll without change is held (default: 60000)")
+    ("latency-ms", po::value<int>(&latency_ms), "Delay added before every response (default: 0)")
+    ("compression", po::bool_switch(&compression), "Compress the responses when the request accepts it");
+    // clang-format on
+
+    try
+    {
+        po::variables_map vm;
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+        if (vm.count("help"))
+        {
+            std::cout << desc << std::endl;
+            return 0;
+        }
+        po::notify(vm);
+
+        if (port < 0 || port > 65535 || hold_ms < 0 || latency_ms < 0)
+        {
+            throw std::invalid_argument("port must be in [0, 65535], hold-ms and latency-ms cannot be negative");
+        }
+
+        am::MockApolloServer server(static_cast<unsigned short>(port));
+        server.setLongPollHold(std::chrono::milliseconds(hold_ms));
+        server.setLatency(std::chrono::milliseconds(latency_ms));
+        server.setCompression(compression);
+        if (!script.empty())
+        {
+            loadScript(script, server);
+        }
+        server.start();
+        std::cout << "Mock Apollo Server listening on " << server.url() << std::endl;
+
+        // Serve until interrupted.
+        boost::asio::io_context signals_context;
+        boost::asio::signal_set signals(signals_context, SIGINT, SIGTERM);
+        signals.async_wait([](const boost::system::error_code&, int) {});
+        signals_context.run();
+
+        server.stop();
+        std::cout << "requests: " << server.requestCount() << ", connections: " << server.connectionCount()
+                  << ", failures injected: " << server.failureCount() << std::endl;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Error: " << e.what() << std::endl;
+        std::cerr << desc << std::endl;
+        return 1;
+    }
+    return 0;
+}
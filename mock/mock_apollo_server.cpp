@@ -0,0 +1,787 @@
+#include "mock_apollo_server.h"
+#include <time.h>
+#include <cctype>
+#include <memory>
+#include <vector>
+#include <boost/beast.hpp>
+#include <boost/optional.hpp>
+#include <boost/beast/zlib/deflate_stream.hpp>
+#include <boost/crc.hpp>
+#include "nlohmann/json.hpp"
+
+namespace net = boost::asio;
+namespace beast = boost::beast;
+namespace http = beast::http;
+using tcp = net::ip::tcp;
+
+namespace apollo
+{
+namespace mock
+{
+namespace
+{
+constexpr std::uint32_t request_header_limit = 4 * 1024 * 1024;
+
+std::string percentDecode(const std::string& s)
+{
+    std::string out;
+    out.reserve(s.size());
+    for (std::size_t i = 0; i < s.size(); ++i)
+    {
+        if (s[i] == '%' && i + 2 < s.size() && std::isxdigit(static_cast<unsigned char>(s[i + 1])) &&
+            std::isxdigit(static_cast<unsigned char>(s[i + 2])))
+        {
+            out += static_cast<char>(std::stoi(s.substr(i + 1, 2), nullptr, 16));
+            i += 2;
+        }
+        else
+        {
+            out += s[i];
+        }
+    }
+    return out;
+}
+
+// Splits "path?a=1&b=2" into the path and its decoded query parameters.
+void parseTarget(const std::string& target, std::string& path, std::map<std::string, std::string>& params)
+{
+    auto query_pos = target.find('?');
+    path = target.substr(0, query_pos);
+    if (query_pos == std::string::npos)
+    {
+        return;
+    }
+
+    std::string query = target.substr(query_pos + 1);
+    std::size_t start = 0;
+    while (start <= query.size())
+    {
+        auto end = query.find('&', start);
+        if (end == std::string::npos)
+        {
+            end = query.size();
+        }
+
+        std::string param = query.substr(start, end - start);
+        auto eq = param.find('=');
+        if (!param.empty())
+        {
+            params[percentDecode(param.substr(0, eq))] =
+                eq == std::string::npos ? "" : percentDecode(param.substr(eq + 1));
+        }
+        start = end + 1;
+    }
+}
+
+// Raw deflate (RFC 1951) of the whole input.
+std::string deflate(const std::string& in)
+{
+    beast::zlib::deflate_stream stream;
+    stream.reset(6, 15, 8, beast::zlib::Strategy::normal);
+
+    std::string out(stream.upper_bound(in.size()), '\0');
+    beast::zlib::z_params zs;
+    zs.next_in = in.data();
+    zs.avail_in = in.size();
+    zs.next_out = &out[0];
+    zs.avail_out = out.size();
+
+    beast::error_code ec;
+    stream.write(zs, beast::zlib::Flush::finish, ec);
+    out.resize(zs.total_out);
+    return out;
+}
+
+void appendLittleEndian32(std::string& s, std::uint32_t v)
+{
+    for (int i = 0; i < 4; ++i)
+    {
+        s += static_cast<char>((v >> (8 * i)) & 0xFF);
+    }
+}
+
+void appendBigEndian32(std::string& s, std::uint32_t v)
+{
+    for (int i = 3; i >= 0; --i)
+    {
+        s += static_cast<char>((v >> (8 * i)) & 0xFF);
+    }
+}
+
+std::uint32_t adler32(const std::string& s)
+{
+    std::uint32_t a = 1;
+    std::uint32_t b = 0;
+    for (unsigned char c : s)
+    {
+        a = (a + c) % 65521;
+        b = (b + a) % 65521;
+    }
+    return (b << 16) | a;
+}
+
+std::vector<std::string> splitPath(const std::string& path)
+{
+    std::vector<std::string> segments;
+    std::size_t start = 1;
+    while (start <= path.size())
+    {
+        auto end = path.find('/', start);
+        if (end == std::string::npos)
+        {
+            end = path.size();
+        }
+        segments.push_back(percentDecode(path.substr(start, end - start)));
+        start = end + 1;
+    }
+    return segments;
+}
+
+class MockSession : public std::enable_shared_from_this<MockSession>
+{
+public:
+    MockSession(tcp::socket&& socket, MockApolloServer& server)
+        : stream_(std::move(socket))
+        , timer_(stream_.get_executor())
+        , hold_timer_(stream_.get_executor())
+        , server_(server)
+    {
+    }
+
+    void run()
+    {
+        doRead();
+    }
+
+private:
+    using Endpoint = MockApolloServer::Endpoint;
+    using Failure = MockApolloServer::Failure;
+
+    void doRead()
+    {
+        // The notifications of thousands of namespaces make request targets far above the default 8 KB limit.
+        parser_.emplace();
+        parser_->header_limit(request_header_limit);
+        http::async_read(stream_,
+                         buffer_,
+                         *parser_,
+                         [self = shared_from_this()](beast::error_code ec, std::size_t) { self->onRead(ec); });
+    }
+
+    void onRead(beast::error_code ec)
+    {
+        if (ec)
+        {
+            close();
+            return;
+        }
+        req_ = parser_->release();
+
+        server_.onRequest();
+        std::string path;
+        params_.clear();
+        parseTarget(std::string(req_.target()), path, params_);
+        segments_ = splitPath(path);
+
+        Failure failure;
+        if (server_.takeFailure(endpoint(), failure))
+        {
+            fail(failure);
+            return;
+        }
+
+        if (endpoint() == Endpoint::Notifications && req_.method() == http::verb::get &&
+            server_.longPollHold().count() > 0)
+        {
+            hold(server_.longPollHold());
+            return;
+        }
+        respond(handle());
+    }
+
+    void respond(http::response<http::string_body>&& res)
+    {
+        res_ = std::move(res);
+        res_.version(req_.version());
+        res_.keep_alive(req_.keep_alive());
+        res_.set(http::field::server, "MockApolloServer");
+        if (server_.compression() && !res_.body().empty())
+        {
+            compress();
+        }
+        res_.prepare_payload();
+
+        auto latency = server_.latency();
+        if (latency.count() <= 0)
+        {
+            doWrite();
+            return;
+        }
+
+        timer_.expires_after(latency);
+        timer_.async_wait([self = shared_from_this()](beast::error_code) { self->doWrite(); });
+    }
+
+    void doWrite()
+    {
+        http::async_write(stream_,
+                          res_,
+                          [self = shared_from_this()](beast::error_code ec, std::size_t) { self->onWrite(ec); });
+    }
+
+    void onWrite(beast::error_code ec)
+    {
+        if (ec || !res_.keep_alive() || server_.closeAfterResponse())
+        {
+            close();
+            return;
+        }
+        doRead();
+    }
+
+    void close()
+    {
+        beast::error_code ignored;
+        stream_.socket().shutdown(tcp::socket::shutdown_both, ignored);
+    }
+
+    // Holds a long poll until a release of one of its namespaces is notified or hold elapsed.
+    void hold(std::chrono::milliseconds hold)
+    {
+        std::set<client::NamespaceType> namespaces;
+        auto notifications = params_.find("notifications");
+        if (notifications != params_.end())
+        {
+            nlohmann::json requested = nlohmann::json::parse(notifications->second, nullptr, false);
+            for (const auto& item : requested)
+            {
+                if (item.is_object() && item.contains("namespaceName") && item["namespaceName"].is_string())
+                {
+                    namespaces.insert(item["namespaceName"].get<std::string>());
+                }
+            }
+        }
+
+        // Watch before looking for changes, a release notified in between then wakes the hold.
+        hold_deadline_ = std::chrono::steady_clock::now() + hold;
+        std::weak_ptr<MockSession> weak = shared_from_this();
+        auto executor = stream_.get_executor();
+        watch_id_ = server_.watch(namespaces,
+                                  [weak, executor]()
+                                  {
+                                      net::post(executor,
+                                                [weak]()
+                                                {
+                                                    if (auto self = weak.lock())
+                                                    {
+                                                        self->hold_timer_.cancel();
+                                                    }
+                                                });
+                                  });
+        onHoldWake();
+    }
+
+    // Called when the hold timer expired or was cancelled by a release, possibly of a previous hold.
+    void onHoldWake()
+    {
+        auto res = handleNotifications(params_);
+        if (res.result() == http::status::not_modified && std::chrono::steady_clock::now() < hold_deadline_)
+        {
+            hold_timer_.expires_at(hold_deadline_);
+            hold_timer_.async_wait([self = shared_from_this()](beast::error_code) { self->onHoldWake(); });
+            return;
+        }
+
+        server_.unwatch(watch_id_);
+        respond(std::move(res));
+    }
+
+    void fail(Failure failure)
+    {
+        switch (failure)
+        {
+            case Failure::ServerError:
+                respond(status(http::status::internal_server_error));
+                break;
+            case Failure::NotFound:
+                respond(status(http::status::not_found));
+                break;
+            case Failure::CloseConnection:
+                close();
+                break;
+            case Failure::MalformedBody:
+                respond(json("{\"releaseKey\":\""));
+                break;
+            case Failure::EmptyBody:
+                respond(json(""));
+                break;
+            case Failure::Slow:
+                hold_timer_.expires_after(std::chrono::seconds(1));
+                hold_timer_.async_wait([self = shared_from_this(), res = handle()](beast::error_code) mutable
+                                       { self->respond(std::move(res)); });
+                break;
+            case Failure::NoResponse:
+                // Keeps the session, and its connection, until the client closes it or the server stops.
+                hold_timer_.expires_after(std::chrono::hours(24));
+                hold_timer_.async_wait([self = shared_from_this()](beast::error_code) {});
+                break;
+        }
+    }
+
+    void compress()
+    {
+        std::string accepted(req_[http::field::accept_encoding]);
+        std::string coding = accepted.find("gzip") != std::string::npos      ? "gzip"
+                             : accepted.find("deflate") != std::string::npos ? "deflate"
+                                                                             : "";
+        if (coding.empty())
+        {
+            return;
+        }
+
+        res_.body() = encodeContent(res_.body(), coding);
+        res_.set(http::field::content_encoding, coding);
+    }
+
+    Endpoint endpoint() const
+    {
+        // /configs/{appId}/{cluster}/{namespace}
+        if (segments_.size() == 4 && segments_[0] == "configs")
+        {
+            return Endpoint::Configs;
+        }
+
+        // /notifications/v2?appId=&cluster=&notifications=
+        if (segments_.size() == 2 && segments_[0] == "notifications" && segments_[1] == "v2")
+        {
+            return Endpoint::Notifications;
+        }
+
+        // /services/config?appId=
+        if (segments_.size() == 2 && segments_[0] == "services" && segments_[1] == "config")
+        {
+            return Endpoint::Services;
+        }
+        return Endpoint::Any;
+    }
+
+    http::response<http::string_body> handle()
+    {
+        if (req_.method() != http::verb::get)
+        {
+            return status(http::status::method_not_allowed);
+        }
+
+        switch (endpoint())
+        {
+            case Endpoint::Configs:
+                return handleConfigs(segments_[1], segments_[2], segments_[3], params_);
+            case Endpoint::Notifications:
+                return handleNotifications(params_);
+            case Endpoint::Services:
+                return handleServices();
+            default:
+                return status(http::status::not_found);
+        }
+    }
+
+    http::response<http::string_body> handleConfigs(const std::string& app_id,
+                                                    const std::string& cluster,
+                                                    const std::string& s_namespace,
+                                                    const std::map<std::string, std::string>& params)
+    {
+        MockApolloServer::Release release;
+        if (!server_.findRelease(s_namespace, release))
+        {
+            return status(http::status::not_found);
+        }
+
+        auto release_key = params.find("releaseKey");
+        if (release_key != params.end() && release_key->second == release.release_key_)
+        {
+            return status(http::status::not_modified);
+        }
+
+        nlohmann::json j = {{"appId", app_id},
+                            {"cluster", cluster},
+                            {"namespaceName", s_namespace},
+                            {"configurations", release.configures_},
+                            {"releaseKey", release.release_key_}};
+        return json(j.dump());
+    }
+
+    http::response<http::string_body> handleServices()
+    {
+        nlohmann::json j = nlohmann::json::array();
+        int instance = 0;
+        for (const auto& url : server_.configServices())
+        {
+            j.push_back({{"appName", "APOLLO-CONFIGSERVICE"},
+                         {"instanceId", "mock-config-service-" + std::to_string(instance++)},
+                         {"homepageUrl", url + "/"}});
+        }
+        return json(j.dump());
+    }
+
+    http::response<http::string_body> handleNotifications(const std::map<std::string, std::string>& params)
+    {
+        auto notifications = params.find("notifications");
+        if (notifications == params.end())
+        {
+            return status(http::status::bad_request);
+        }
+
+        nlohmann::json requested = nlohmann::json::parse(notifications->second, nullptr, false);
+        if (!requested.is_array())
+        {
+            return status(http::status::bad_request);
+        }
+
+        auto server_ids = server_.notificationIds();
+        nlohmann::json changed = nlohmann::json::array();
+        for (const auto& item : requested)
+        {
+            if (!item.is_object() || !item.contains("namespaceName") || !item.contains("notificationId"))
+            {
+                return status(http::status::bad_request);
+            }
+
+            auto id = server_ids.find(item["namespaceName"].get<std::string>());
+            if (id != server_ids.end() && id->second != item["notificationId"].get<int>())
+            {
+                changed.push_back({{"namespaceName", id->first}, {"notificationId", id->second}});
+            }
+        }
+
+        if (changed.empty())
+        {
+            return status(http::status::not_modified);
+        }
+        return json(changed.dump());
+    }
+
+    http::response<http::string_body> status(http::status s)
+    {
+        http::response<http::string_body> res{s, req_.version()};
+        return res;
+    }
+
+    http::response<http::string_body> json(std::string&& body)
+    {
+        http::response<http::string_body> res{http::status::ok, req_.version()};
+        res.set(http::field::content_type, "application/json;charset=UTF-8");
+        res.body() = std::move(body);
+        return res;
+    }
+
+    beast::tcp_stream stream_;
+    net::steady_timer timer_;       // Delays the response by the latency of the server
+    net::steady_timer hold_timer_;  // Holds a long poll
+    beast::flat_buffer buffer_;
+    boost::optional<http::request_parser<http::string_body>> parser_;
+    http::request<http::string_body> req_;
+    std::vector<std::string> segments_;
+    std::map<std::string, std::string> params_;
+    http::response<http::string_body> res_;
+    std::chrono::steady_clock::time_point hold_deadline_;
+    MockApolloServer::WatchId watch_id_ = 0;
+    MockApolloServer& server_;
+};
+}  // namespace
+
+MockApolloServer::MockApolloServer(unsigned short port)
+    : io_context_()
+    , acceptor_(io_context_, tcp::endpoint(net::ip::make_address("127.0.0.1"), port))
+{
+}
+
+MockApolloServer::~MockApolloServer()
+{
+    stop();
+}
+
+void MockApolloServer::start()
+{
+    if (thread_.joinable())
+    {
+        return;
+    }
+
+    doAccept();
+    thread_ = std::thread(
+        [this]()
+        {
+            io_context_.run();
+            timespec cpu{};
+            clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu);
+            cpu_seconds_.store(static_cast<double>(cpu.tv_sec) + static_cast<double>(cpu.tv_nsec) / 1e9);
+        });
+}
+
+void MockApolloServer::stop()
+{
+    if (!thread_.joinable())
+    {
+        return;
+    }
+
+    io_context_.stop();
+    thread_.join();
+}
+
+std::string MockApolloServer::url() const
+{
+    return "http://127.0.0.1:" + std::to_string(port());
+}
+
+unsigned short MockApolloServer::port() const
+{
+    return acceptor_.local_endpoint().port();
+}
+
+int MockApolloServer::setRelease(const client::NamespaceType& s_namespace,
+                                 const client::Configures& configures,
+                                 const std::string& release_key,
+                                 bool notify)
+{
+    std::vector<std::function<void()>> wakes;
+    int notification_id = 0;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        Release& release = releases_[s_namespace];
+        release.release_key_ = release_key;
+        release.configures_ = configures;
+        if (!notify)
+        {
+            return release.notification_id_;
+        }
+
+        notification_id = ++release.notification_id_;
+        for (const auto& watch : watches_)
+        {
+            if (watch.second.namespaces_.count(s_namespace) != 0)
+            {
+                wakes.push_back(watch.second.wake_);
+            }
+        }
+    }
+
+    for (const auto& wake : wakes)
+    {
+        wake();
+    }
+    return notification_id;
+}
+
+void MockApolloServer::scheduleRelease(std::chrono::milliseconds delay,
+                                       const client::NamespaceType& s_namespace,
+                                       const client::Configures& configures,
+                                       const std::string& release_key,
+                                       bool notify)
+{
+    auto timer = std::make_shared<net::steady_timer>(io_context_, delay);
+    timer->async_wait(
+        [this, timer, s_namespace, configures, release_key, notify](beast::error_code ec)
+        {
+            if (!ec)
+            {
+                setRelease(s_namespace, configures, release_key, notify);
+            }
+        });
+}
+
+void MockApolloServer::setConfigServices(const std::vector<std::string>& urls)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    config_services_ = urls;
+}
+
+std::vector<std::string> MockApolloServer::configServices() const
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    return config_services_;
+}
+
+void MockApolloServer::setLatency(std::chrono::milliseconds latency)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    latency_ = latency;
+}
+
+void MockApolloServer::setLongPollHold(std::chrono::milliseconds hold)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    long_poll_hold_ = hold;
+}
+
+void MockApolloServer::failRequests(Endpoint endpoint, Failure failure, int count)
+{
+    if (count <= 0)
+    {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    failures_.push_back({endpoint, failure, count});
+}
+
+void MockApolloServer::setCloseAfterResponse(bool close)
+{
+    close_after_response_.store(close);
+}
+
+std::size_t MockApolloServer::requestCount() const
+{
+    return request_count_.load();
+}
+
+std::size_t MockApolloServer::connectionCount() const
+{
+    return connection_count_.load();
+}
+
+std::size_t MockApolloServer::failureCount() const
+{
+    return failure_count_.load();
+}
+
+double MockApolloServer::cpuSeconds() const
+{
+    return cpu_seconds_.load();
+}
+
+bool MockApolloServer::findRelease(const client::NamespaceType& s_namespace, Release& release) const
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto it = releases_.find(s_namespace);
+    if (it == releases_.end())
+    {
+        return false;
+    }
+    release = it->second;
+    return true;
+}
+
+std::map<client::NamespaceType, int> MockApolloServer::notificationIds() const
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    std::map<client::NamespaceType, int> ids;
+    for (const auto& p : releases_)
+    {
+        ids.emplace(p.first, p.second.notification_id_);
+    }
+    return ids;
+}
+
+std::chrono::milliseconds MockApolloServer::latency() const
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    return latency_;
+}
+
+std::chrono::milliseconds MockApolloServer::longPollHold() const
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    return long_poll_hold_;
+}
+
+bool MockApolloServer::takeFailure(Endpoint endpoint, Failure& failure)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (auto it = failures_.begin(); it != failures_.end(); ++it)
+    {
+        if (it->endpoint_ != Endpoint::Any && it->endpoint_ != endpoint)
+        {
+            continue;
+        }
+
+        failure = it->failure_;
+        if (--it->remaining_ == 0)
+        {
+            failures_.erase(it);
+        }
+        failure_count_.fetch_add(1);
+        return true;
+    }
+    return false;
+}
+
+MockApolloServer::WatchId MockApolloServer::watch(const std::set<client::NamespaceType>& namespaces,
+                                                  std::function<void()> wake)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    WatchId id = next_watch_id_++;
+    watches_.emplace(id, Watch{namespaces, std::move(wake)});
+    return id;
+}
+
+void MockApolloServer::unwatch(WatchId id)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    watches_.erase(id);
+}
+
+void MockApolloServer::setCompression(bool enabled)
+{
+    compression_.store(enabled);
+}
+
+bool MockApolloServer::compression() const
+{
+    return compression_.load();
+}
+
+bool MockApolloServer::closeAfterResponse() const
+{
+    return close_after_response_.load();
+}
+
+void MockApolloServer::onRequest()
+{
+    request_count_.fetch_add(1);
+}
+
+void MockApolloServer::doAccept()
+{
+    acceptor_.async_accept(
+        [this](beast::error_code ec, tcp::socket socket)
+        {
+            if (!ec)
+            {
+                connection_count_.fetch_add(1);
+                std::make_shared<MockSession>(std::move(socket), *this)->run();
+            }
+
+            if (acceptor_.is_open())
+            {
+                doAccept();
+            }
+        });
+}
+
+std::string encodeContent(const std::string& body, const std::string& coding)
+{
+    if (coding == "gzip")
+    {
+        // Fixed header without optional fields: magic, deflate, no flags, no mtime, unknown OS.
+        std::string out("\x1f\x8b\x08\x00\x00\x00\x00\x00\x00\xff", 10);
+        out += deflate(body);
+        boost::crc_32_type crc;
+        crc.process_bytes(body.data(), body.size());
+        appendLittleEndian32(out, crc.checksum());
+        appendLittleEndian32(out, static_cast<std::uint32_t>(body.size()));
+        return out;
+    }
+
+    if (coding == "deflate")
+    {
+        std::string out("\x78\x9c", 2);
+        out += deflate(body);
+        appendBigEndian32(out, adler32(body));
+        return out;
+    }
+    return body;
+}
+
+}  // namespace mock
+}  // namespace apollo
@@ -0,0 +1,175 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include <boost/asio.hpp>
+#include "apollo/apollo_types.h"
+
+namespace apollo
+{
+namespace mock
+{
+/**
+ * In-process stand-in for an Apollo config service, listening on 127.0.0.1, by default with an ephemeral port.
+ *
+ * Serves GET /configs/{appId}/{cluster}/{namespace} and GET /notifications/v2 for the releases published
+ * with setRelease(), over HTTP/1.1 with keep-alive. Intended for offline tests and benchmarks.
+ * It serves GET /services/config as a meta server would, for the instances set with setConfigServices().
+ *
+ * /configs answers 304 when the releaseKey requested is the current one. /notifications/v2 answers the
+ * namespaces whose notification id differs from the one requested; with setLongPollHold() a request
+ * without such namespace is held until a release of one of its namespaces is notified, then answered 200,
+ * or until the hold elapsed, then answered 304, as the Apollo config service does.
+ */
+class MockApolloServer
+{
+public:
+    // Requests failures are injected into, see failRequests().
+    enum class Endpoint
+    {
+        Any,
+        Configs,
+        Notifications,
+        Services
+    };
+
+    enum class Failure
+    {
+        ServerError,      // Answered 500
+        NotFound,         // Answered 404
+        CloseConnection,  // The connection is closed without response
+        MalformedBody,    // Answered 200 with a truncated JSON body
+        EmptyBody,        // Answered 200 with Content-Length: 0
+        Slow,             // Answered as of its arrival, one second later, e.g. to race it with other requests
+        NoResponse        // Never answered, the connection is left open until the client gives up
+    };
+
+    explicit MockApolloServer(unsigned short port = 0);
+    ~MockApolloServer();
+
+    // Starts serving on a background thread.
+    void start();
+    // Stops serving and joins the background thread, connections are dropped.
+    void stop();
+
+    // Base url of the server, e.g. "http://127.0.0.1:34567", suitable for makeApolloClient.
+    std::string url() const;
+    unsigned short port() const;
+
+    // Publishes a release of the namespace, bumps its notification id and returns the new id.
+    // Without notify the id is left unchanged, as if the notification of the release was lost.
+    int setRelease(const client::NamespaceType& s_namespace,
+                   const client::Configures& configures,
+                   const std::string& release_key,
+                   bool notify = true);
+
+    // Publishes the release after delay, on the server thread, e.g. to script a sequence of releases.
+    void scheduleRelease(std::chrono::milliseconds delay,
+                         const client::NamespaceType& s_namespace,
+                         const client::Configures& configures,
+                         const std::string& release_key,
+                         bool notify = true);
+
+    // Base urls of the config services listed by /services/config, e.g. the url() of other servers.
+    void setConfigServices(const std::vector<std::string>& urls);
+
+    // Delay added before every response is sent.
+    void setLatency(std::chrono::milliseconds latency);
+
+    // Longest time a /notifications/v2 request without change is held, 0 answers it 304 at once.
+    // Apollo holds them 60 seconds.
+    void setLongPollHold(std::chrono::milliseconds hold);
+
+    // The next count requests to endpoint fail with failure, after the failures already injected.
+    void failRequests(Endpoint endpoint, Failure failure, int count = 1);
+
+    // Closes every connection after its response while still advertising keep-alive,
+    // as a server dropping idle connections would.
+    void setCloseAfterResponse(bool close);
+
+    // Compresses the responses with gzip, or deflate, when the request accepts it.
+    void setCompression(bool enabled);
+
+    // Number of requests received, connections accepted and failures injected so far.
+    std::size_t requestCount() const;
+    std::size_t connectionCount() const;
+    std::size_t failureCount() const;
+
+    // CPU time used by the server thread, once stopped.
+    double cpuSeconds() const;
+
+    struct Release
+    {
+        std::string release_key_;
+        int notification_id_ = 0;
+        client::Configures configures_;
+    };
+
+    using WatchId = std::uint64_t;
+
+    // Used by the connection sessions, thread-safe.
+    bool findRelease(const client::NamespaceType& s_namespace, Release& release) const;
+    std::map<client::NamespaceType, int> notificationIds() const;
+    std::vector<std::string> configServices() const;
+    std::chrono::milliseconds latency() const;
+    std::chrono::milliseconds longPollHold() const;
+    bool closeAfterResponse() const;
+    bool compression() const;
+    void onRequest();
+    // Consumes the next failure injected into endpoint, false if there is none.
+    bool takeFailure(Endpoint endpoint, Failure& failure);
+    // Calls wake, on the thread notifying it, once a release of one of the namespaces is notified.
+    WatchId watch(const std::set<client::NamespaceType>& namespaces, std::function<void()> wake);
+    void unwatch(WatchId id);
+
+private:
+    MockApolloServer(const MockApolloServer&) = delete;             // Disable copy constructor
+    MockApolloServer& operator=(const MockApolloServer&) = delete;  // Disable assignment operator
+
+    void doAccept();
+
+    struct Watch
+    {
+        std::set<client::NamespaceType> namespaces_;
+        std::function<void()> wake_;
+    };
+
+    struct InjectedFailure
+    {
+        Endpoint endpoint_;
+        Failure failure_;
+        int remaining_;
+    };
+
+    boost::asio::io_context io_context_;
+    boost::asio::ip::tcp::acceptor acceptor_;
+    std::thread thread_;
+    mutable std::mutex mutex_;
+    std::map<client::NamespaceType, Release> releases_;
+    std::vector<std::string> config_services_;
+    std::chrono::milliseconds latency_{0};
+    std::chrono::milliseconds long_poll_hold_{0};
+    std::vector<InjectedFailure> failures_;
+    std::map<WatchId, Watch> watches_;
+    WatchId next_watch_id_ = 1;
+    std::atomic<bool> close_after_response_{false};
+    std::atomic<bool> compression_{false};
+    std::atomic<std::size_t> request_count_{0};
+    std::atomic<std::size_t> connection_count_{0};
+    std::atomic<std::size_t> failure_count_{0};
+    std::atomic<double> cpu_seconds_{0};
+};
+
+// Encodes body with a Content-Encoding of "gzip" or "deflate" (zlib wrapped), as a server would.
+std::string encodeContent(const std::string& body, const std::string& coding);
+
+}  // namespace mock
+}  // namespace apollo
@@ -1,5 +1,6 @@
 #include "apollo/apollo_client.h"
 #include "apollo_client_impl.h"
+#include "apollo_runtime_impl.h"
 #include "apollo_utility.h"
 
 namespace apollo
@@ -50,7 +51,95 @@ ClientPtr makeApolloClient(const std::string& apollo_url, const std::string& app
     {
         throw std::invalid_argument("apollo client request write timeout must be greater than 0 in opts");
     }
+
+    if (opts.initial_fetch_concurrency_ <= 0)
+    {
+        throw std::invalid_argument("apollo client initial fetch concurrency must be greater than 0 in opts");
+    }
+
+    if (opts.update_fetch_concurrency_ <= 0)
+    {
+        throw std::invalid_argument("apollo client update fetch concurrency must be greater than 0 in opts");
+    }
+
+    if (opts.long_polling_max_namespaces_ < 0)
+    {
+        throw std::invalid_argument("apollo client long polling max namespaces cannot be negative in opts");
+    }
+
+    if (opts.long_polling_max_url_length_ < 0)
+    {
+        throw std::invalid_argument("apollo client long polling max url length cannot be negative in opts");
+    }
+
+    if (opts.max_connections_per_host_ < 0)
+    {
+        throw std::invalid_argument("apollo client max connections per host cannot be negative in opts");
+    }
+
+    if (opts.connection_idle_timeout_ms_ <= 0)
+    {
+        throw std::invalid_argument("apollo client connection idle timeout must be greater than 0 in opts");
+    }
+
+    if (opts.dns_cache_ttl_ms_ < 0)
+    {
+        throw std::invalid_argument("apollo client dns cache ttl cannot be negative in opts");
+    }
+
+    if (opts.refresh_interval_ms_ < 0)
+    {
+        throw std::invalid_argument("apollo client refresh interval cannot be negative in opts");
+    }
+
+    if (!opts.meta_server_url_.empty() && !isValidUrl(opts.meta_server_url_))
+    {
+        throw std::invalid_argument("apollo client meta server url format not supported: " + opts.meta_server_url_);
+    }
+
+    if (opts.service_discovery_interval_ms_ <= 0)
+    {
+        throw std::invalid_argument("apollo client service discovery interval must be greater than 0 in opts");
+    }
+
+    if (opts.listener_threads_ < 0)
+    {
+        throw std::invalid_argument("apollo client listener threads cannot be negative in opts");
+    }
+    if (opts.runtime_ && !std::dynamic_pointer_cast<ApolloRuntimeImpl>(opts.runtime_))
+    {
+        throw std::invalid_argument("apollo client runtime must be created by makeApolloRuntime in opts");
+    }
     return std::make_shared<ApolloClientImpl>(apollo_url, app_id, std::move(opts), std::move(LoggerPtr));
 }
+
+RuntimePtr makeApolloRuntime(RuntimeOpts&& opts)
+{
+    if (opts.thread_count_ <= 0)
+    {
+        throw std::invalid_argument("apollo runtime thread count must be greater than 0 in opts");
+    }
+
+    if (opts.max_connections_per_host_ < 0)
+    {
+        throw std::invalid_argument("apollo runtime max connections per host cannot be negative in opts");
+    }
+
+    if (opts.connection_idle_timeout_ms_ <= 0)
+    {
+        throw std::invalid_argument("apollo runtime connection idle timeout must be greater than 0 in opts");
+    }
+
+    if (opts.dns_cache_ttl_ms_ < 0)
+    {
+        throw std::invalid_argument("apollo runtime dns cache ttl cannot be negative in opts");
+    }
+
+    if (opts.listener_threads_ < 0)
+    {
+        throw std::invalid_argument("apollo runtime listener threads cannot be negative in opts");
+    }
+    return std::make_shared<ApolloRuntimeImpl>(opts);
+}
 }  // namespace client
 }  // namespace apollo
\ No newline at end of file
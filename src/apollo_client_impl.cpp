@@ -1,12 +1,37 @@
+#include <algorithm>
 #include <boost/asio.hpp>
 #include "apollo_client_impl.h"
 #include "apollo_internal.h"
 #include "apollo_utility.h"
+#include "fetch_scheduler.h"
+#include "json_body.h"
 
 namespace apollo
 {
 namespace client
 {
+namespace
+{
+// Bodies are parsed while they are read, an invalid body fails the read with bad_message.
+bool isParseError(beast::error_code ec)
+{
+    return ec == boost::system::errc::bad_message;
+}
+
+// Owns the client on behalf of the long polling handlers, signals once the last of them released it.
+template <class Client>
+struct PipelineOwner
+{
+    std::shared_ptr<Client> client_;
+    std::promise<void> released_;
+
+    ~PipelineOwner()
+    {
+        released_.set_value();
+    }
+};
+}  // namespace
+
 ApolloClientImpl::ApolloClientImpl(const std::string& apollo_url, const std::string& app_id, Opts&& opts, LoggerPtr&& logger)
     : long_polling_interval_(0)
     , long_polling_running_(false)
@@ -15,27 +40,87 @@ ApolloClientImpl::ApolloClientImpl(const std::string& apollo_url, const std::str
     , opts_(std::move(opts))
     , namespace_attributes_()
     , logger_(std::move(logger))
+    , runtime_(std::static_pointer_cast<ApolloRuntimeImpl>(opts_.runtime_))
+    , own_io_context_(runtime_ ? nullptr : new boost::asio::io_context())
+    , io_context_(runtime_ ? runtime_->ioContext() : *own_io_context_)
+    , strand_(net::make_strand(io_context_))
+    , listener_dispatcher_(runtime_ ? runtime_->listenerDispatcher()
+                                    : std::make_shared<ListenerDispatcher>(opts_.listener_threads_))
     , long_polling_thread_()
-    , io_context_()
-    , long_polling_timer_(io_context_)
-    , http_client_(io_context_)
+    , http_client_(io_context_, strand_)
+    , refresh_timer_(strand_)
+    , refresh_random_(std::random_device()())
+    , discovery_timer_(strand_)
+    , client_metrics_(opts_.namespaces_)
 {
     http_client_.setConnectionTimeout(opts_.connection_timeout_ms_);
     http_client_.setRequestReadTimeout(opts_.request_read_timeout_ms_);
     http_client_.setRequestWriteTimeout(opts_.request_write_timeout_ms_);
+    if (runtime_)
+    {
+        http_client_.setConnectionPool(runtime_->connectionPool());
+        http_client_.setResolverCache(runtime_->resolverCache());
+    }
+    else
+    {
+        http_client_.setConnectionPool(
+            std::make_shared<ConnectionPool>(opts_.max_connections_per_host_, opts_.connection_idle_timeout_ms_));
+        http_client_.setResolverCache(std::make_shared<ResolverCache>(io_context_, opts_.dns_cache_ttl_ms_));
+    }
+    http_client_.setCompression(opts_.compressed_transfer_);
 
     initNamespaceAttributes();
+    initLongPollingShards();
+    configs_url_.reset(
+        new ConfigsURLBuilder(app_id_, apollo_url_, opts_.cluster_name_, opts_.label_, namespace_attributes_));
+
+    // The urls are built against apollo_url_, routeURL() moves them to the config service selected.
+    if (!opts_.meta_server_url_.empty())
+    {
+        config_services_.reset(new ConfigServiceSelector(apollo_url_));
+        config_services_url_ = createConfigServicesURL(opts_.meta_server_url_, app_id_);
+    }
+
+    // With a complete cache the client starts without the server, the first long poll reconciles
+    // the cached notification ids with the server and fetches the namespaces that changed meanwhile.
+    // Nor does it wait for the meta server, the config services are discovered once polling starts.
+    // Until then nothing contacts the server: without a shared runtime no thread runs io_context_.
+    if (!opts_.cache_dir_.empty())
+    {
+        snapshot_cache_.reset(new SnapshotCache(opts_.cache_dir_, app_id_, opts_.cluster_name_, opts_.label_));
+        auto logger = logger_;
+        const auto& cache = *snapshot_cache_;
+        snapshot_writer_.reset(new SnapshotWriter(
+            cache,
+            [logger, &cache](const NamespaceType& s_namespace)
+            { LOG_WARN(logger, "apollo client failed to write cache file: " + cache.path(s_namespace)); }));
+        if (loadSnapshotCache())
+        {
+            discover_at_start_ = config_services_ != nullptr;
+            return;
+        }
+    }
+
+    if (config_services_)
+    {
+        discoverConfigServices();
+    }
     initConfigurationsMap();
     initNotificationsIdMap();
+
+    for (const auto& p : namespace_attributes_)
+    {
+        storeSnapshotCache(p.first, *p.second);
+    }
 }
 
 ApolloClientImpl::~ApolloClientImpl()
 {
     stopLongPolling();
 
-    if (!io_context_.stopped())
+    if (own_io_context_ && !own_io_context_->stopped())
     {
-        io_context_.stop();
+        own_io_context_->stop();
     }
 }
 
@@ -50,10 +135,27 @@ void ApolloClientImpl::startLongPolling(int long_polling_interval_ms)
     if (long_polling_running_.compare_exchange_strong(expected, true))
     {
         long_polling_interval_ = long_polling_interval_ms;
-        setupLongPollingTimer();
 
-        long_polling_thread_ =
-            std::thread([shared_this = shared_from_this()]() { shared_this->io_context_.run(); });
+        auto owner = std::make_shared<PipelineOwner<ApolloClientImpl>>();
+        owner->client_ = shared_from_this();
+        pipeline_released_ = owner->released_.get_future();
+        std::shared_ptr<ApolloClientImpl> pipeline(owner, this);
+        net::post(strand_,
+                  [this, pipeline]()
+                  {
+                      pipeline_ = pipeline;
+                      for (auto& shard : long_polling_shards_)
+                      {
+                          setupLongPollingTimer(*shard);
+                      }
+                      scheduleRefreshes();
+                      setupDiscoveryTimer();
+                  });
+
+        if (own_io_context_)
+        {
+            long_polling_thread_ = std::thread([this]() { io_context_.run(); });
+        }
         LOG_INFO(logger_, "apollo client starting long polling with interval: " + std::to_string(long_polling_interval_ms) + " ms");
     }
 
@@ -65,10 +167,37 @@ void ApolloClientImpl::stopLongPolling()
     bool expected = true;
     if (long_polling_running_.compare_exchange_strong(expected, false))
     {
+        // Abort the timers and the requests in flight on the strand, the pipeline is released as soon as
+        // their handlers completed, without waiting for the long poll to be answered.
+        net::post(strand_,
+                  [this]()
+                  {
+                      refresh_timer_.cancel();
+                      discovery_timer_.cancel();
+                      std::vector<std::weak_ptr<FetchScheduler<ConfigsBody>>> schedulers = {refresh_scheduler_};
+                      for (auto& shard : long_polling_shards_)
+                      {
+                          shard->timer_.cancel();
+                          schedulers.push_back(shard->fetch_scheduler_);
+                      }
+                      for (auto& weak_scheduler : schedulers)
+                      {
+                          auto scheduler = weak_scheduler.lock();
+                          if (scheduler)
+                          {
+                              scheduler->cancel();
+                          }
+                      }
+                      http_client_.cancel();
+                      pipeline_.reset();
+                  });
+        pipeline_released_.wait();
+        listener_dispatcher_->flush(this);
+
         if (long_polling_thread_.joinable())
         {
-            io_context_.stop();
             long_polling_thread_.join();
+            io_context_.restart();
         }
         LOG_INFO(logger_, "apollo client stopped long polling");
     }
@@ -78,19 +207,138 @@ void ApolloClientImpl::stopLongPolling()
 Configures ApolloClientImpl::getConfigures(const NamespaceType& s_namespace)
 {
     assert(namespace_attributes_.size() > 0);
-    if (namespace_attributes_.find(s_namespace) == namespace_attributes_.end())
+    auto attribute_it = namespace_attributes_.find(s_namespace);
+    if (attribute_it == namespace_attributes_.end())
     {
         return {};  // Return empty map if namespace is not configured
     }
 
-    return namespace_attributes_[s_namespace]->GetConfigures();
+    return attribute_it->second->GetConfigures();
+}
+
+ConfiguresPtr ApolloClientImpl::getSnapshot(const NamespaceType& s_namespace)
+{
+    assert(namespace_attributes_.size() > 0);
+    auto attribute_it = namespace_attributes_.find(s_namespace);
+    if (attribute_it == namespace_attributes_.end())
+    {
+        return nullptr;  // Return nullptr if namespace is not configured
+    }
+
+    return attribute_it->second->GetSnapshot();
+}
+
+ValuePtr ApolloClientImpl::getValue(const NamespaceType& s_namespace, const std::string& key)
+{
+    assert(namespace_attributes_.size() > 0);
+    auto attribute_it = namespace_attributes_.find(s_namespace);
+    if (attribute_it == namespace_attributes_.end())
+    {
+        return nullptr;  // Return nullptr if namespace is not configured
+    }
+
+    return attribute_it->second->GetValue(key);
+}
+
+ValuePtr ApolloClientImpl::getValueOr(const NamespaceType& s_namespace,
+                                      const std::string& key,
+                                      const std::string& default_value)
+{
+    auto value = getValue(s_namespace, key);
+    if (!value)
+    {
+        return std::make_shared<const std::string>(default_value);
+    }
+    return value;
+}
+
+ValuePtr ApolloClientImpl::getValueOr(const NamespaceType& s_namespace,
+                                      const std::string& key,
+                                      const ValuePtr& default_value)
+{
+    auto value = getValue(s_namespace, key);
+    if (!value)
+    {
+        return default_value;
+    }
+    return value;
+}
+
+ParsedValuePtr ApolloClientImpl::getParsedValue(const NamespaceType& s_namespace,
+                                                const std::string& key,
+                                                const std::type_info& type,
+                                                ValueParseFunction parse)
+{
+    assert(namespace_attributes_.size() > 0);
+    auto attribute_it = namespace_attributes_.find(s_namespace);
+    if (attribute_it == namespace_attributes_.end())
+    {
+        return nullptr;  // Return nullptr if namespace is not configured
+    }
+
+    return attribute_it->second->GetParsedValue(key, std::type_index(type), parse);
 }
 
 void ApolloClientImpl::setNotificationsListener(NotificationCallbackPtr notificationCallback)
 {
+    std::unique_lock<std::mutex> lock(listener_mutex_);
     notification_callback_ = notificationCallback;
 }
 
+ListenerId ApolloClientImpl::addNotificationsListener(const NamespaceType& s_namespace,
+                                                      NotificationCallbackPtr notificationCallback,
+                                                      const std::string& key,
+                                                      KeyMatch match)
+{
+    return listener_registry_.add(s_namespace, key, match, std::move(notificationCallback));
+}
+
+void ApolloClientImpl::removeNotificationsListener(ListenerId id)
+{
+    listener_registry_.remove(id);
+}
+
+LongPollingMetrics ApolloClientImpl::getLongPollingMetrics()
+{
+    std::unique_lock<std::mutex> lock(metrics_mutex_);
+    return long_polling_metrics_;
+}
+
+TransferMetrics ApolloClientImpl::getTransferMetrics()
+{
+    auto stats = http_client_.transferStats();
+    TransferMetrics metrics;
+    metrics.responses_ = stats.responses_;
+    metrics.compressed_responses_ = stats.compressed_responses_;
+    metrics.wire_bytes_ = stats.wire_bytes_;
+    metrics.decoded_bytes_ = stats.decoded_bytes_;
+    return metrics;
+}
+
+ListenerMetrics ApolloClientImpl::getListenerMetrics()
+{
+    return listener_dispatcher_->stats();
+}
+
+ClientMetrics ApolloClientImpl::getClientMetrics()
+{
+    ClientMetrics metrics;
+    client_metrics_.load(metrics);
+
+    auto stats = http_client_.transferStats();
+    metrics.parse_time_ = std::move(stats.parse_time_);
+    metrics.payload_size_ = std::move(stats.body_size_);
+    metrics.long_polling_ = getLongPollingMetrics();
+    metrics.transfer_ = getTransferMetrics();
+    metrics.resolver_ = http_client_.resolverCache()->stats();
+    metrics.listener_ = getListenerMetrics();
+    if (config_services_)
+    {
+        metrics.config_services_ = config_services_->metrics();
+    }
+    return metrics;
+}
+
 void ApolloClientImpl::initNamespaceAttributes()
 {
     for (const auto& ns : opts_.namespaces_)
@@ -99,198 +347,742 @@ void ApolloClientImpl::initNamespaceAttributes()
     }
 }
 
+void ApolloClientImpl::initLongPollingShards()
+{
+    auto shards = partitionNotifications(app_id_,
+                                         apollo_url_,
+                                         opts_.cluster_name_,
+                                         opts_.label_,
+                                         namespace_attributes_,
+                                         static_cast<std::size_t>(opts_.long_polling_max_namespaces_),
+                                         static_cast<std::size_t>(opts_.long_polling_max_url_length_));
+    for (auto& namespace_attributes : shards)
+    {
+        NotificationsURLBuilder url(app_id_, apollo_url_, opts_.cluster_name_, opts_.label_, namespace_attributes);
+        long_polling_shards_.emplace_back(
+            new LongPollingShard(std::move(namespace_attributes), std::move(url), strand_));
+    }
+    long_polling_metrics_.shards_ = long_polling_shards_.size();
+
+    if (long_polling_shards_.size() > 1)
+    {
+        LOG_INFO(logger_,
+                 "apollo client splits " + std::to_string(namespace_attributes_.size()) + " namespaces into " +
+                     std::to_string(long_polling_shards_.size()) + " long polls");
+    }
+}
+
 void ApolloClientImpl::initConfigurationsMap()
 {
     assert(namespace_attributes_.size() > 0);
+
+    std::vector<NamespaceAttributesMap::value_type*> pending;
+    std::vector<std::string> urls;
+    pending.reserve(namespace_attributes_.size());
+    urls.reserve(namespace_attributes_.size());
     for (auto& p : namespace_attributes_)
     {
-        auto url = createNoCacheConfigsURL(app_id_,
-                                           apollo_url_,
-                                           opts_.cluster_name_,
-                                           p.first,
-                                           opts_.label_,
-                                           p.second->GetReleaseKey(),
-                                           p.second->GetNotificationId());
+        auto url = routeURL(configs_url_->build(p.first, p.second->GetReleaseKey(), p.second->GetNotificationId()));
 
         LOG_DEBUG(logger_, "apollo client get configurations from Apollo, namespace: " + p.first + ", url: " + url);
-        auto res = http_client_.get(url);
-        if (res.second)
+        pending.push_back(&p);
+        urls.push_back(std::move(url));
+    }
+
+    // Fetch all namespaces concurrently, the first failure cancels the fetches not started yet
+    // and is rethrown once the ones in flight completed, so no partially initialized client escapes.
+    std::string error;
+    std::shared_ptr<FetchScheduler<ConfigsBody>> scheduler;
+    auto on_result = [this, &pending, &error, &scheduler](std::size_t index,
+                                                         beast::error_code ec,
+                                                         http::response<ConfigsBody>&& res,
+                                                         std::chrono::microseconds elapsed)
+    {
+        client_metrics_.recordLatency(ClientMetricsRecorder::Request::Fetch, elapsed);
+        client_metrics_.recordFailure(ClientMetricsRecorder::Request::Fetch, ec);
+        recordConfigService(scheduler->url(index), ec, res.result(), elapsed);
+        if (!ec && res.result() != http::status::ok)
         {
-            throw std::runtime_error("apollo client failed to fetch configurations from Apollo: " +
-                                     res.second.message());
+            client_metrics_.recordHttpError(ClientMetricsRecorder::Request::Fetch);
         }
 
-        if (res.first.result() != http::status::ok)
+        if (!error.empty())
         {
-            throw std::runtime_error("apollo client failed to fetch configurations from Apollo, status: " +
-                                     std::to_string(res.first.result_int()));
+            return;
         }
 
-        std::string release_key;
-        Configures configures;
+        if (isParseError(ec))
+        {
+            error = "apollo client failed to parse configurations from Apollo response";
+        }
+        else if (ec)
+        {
+            error = "apollo client failed to fetch configurations from Apollo: " + ec.message();
+        }
+        else if (res.result() != http::status::ok)
+        {
+            error = "apollo client failed to fetch configurations from Apollo, status: " +
+                    std::to_string(res.result_int());
+        }
+        else
+        {
+            pending[index]->second->SetReleaseKey(std::move(res.body().release_key_));
+            pending[index]->second->SetConfigures(std::move(res.body().configures_));
+            LOG_INFO(logger_,
+                     "apollo client get configurations from Apollo successfully, namespace:" + pending[index]->first);
+        }
 
-        if (!fromJsonString(res.first.body(), release_key, configures))
+        if (!error.empty())
         {
-            throw std::runtime_error("apollo client failed to parse configurations from Apollo response");
+            scheduler->cancel();
         }
-        p.second->SetReleaseKey(std::move(release_key));
-        p.second->SetConfigures(std::move(configures));
-        LOG_INFO(logger_, "apollo client get configurations from Apollo successfully, namespace:" + p.first);
+    };
+
+    std::promise<void> done;
+    auto finished = done.get_future();
+    scheduler = std::make_shared<FetchScheduler<ConfigsBody>>(http_client_,
+                                                              std::move(urls),
+                                                              static_cast<std::size_t>(opts_.initial_fetch_concurrency_),
+                                                              std::move(on_result),
+                                                              [&done]() { done.set_value(); });
+    net::post(strand_, [scheduler]() { scheduler->start(); });
+    waitForRequests(finished);
+
+    if (!error.empty())
+    {
+        throw std::runtime_error(error);
+    }
+}
+
+void ApolloClientImpl::waitForRequests(std::future<void>& done)
+{
+    // The polling thread is not started yet, drive the requests on the constructing thread.
+    if (own_io_context_)
+    {
+        io_context_.run();
+        io_context_.restart();
     }
+    done.wait();
 }
 
 void ApolloClientImpl::initNotificationsIdMap()
 {
     assert(namespace_attributes_.size() > 0);
-    auto url = createNotificationsV2URL(app_id_, apollo_url_, opts_.cluster_name_, opts_.label_, namespace_attributes_);
-    LOG_DEBUG(logger_, "apollo client init notifications map from Apollo url: " + url);
-
-    auto res = http_client_.get(url);
-    if (res.second)
+    for (auto& shard : long_polling_shards_)
     {
-        throw std::runtime_error("apollo client failed to fetch notifications from Apollo: " +
-                                 res.second.message());
+        auto url = routeURL(shard->url_.build(shard->namespace_attributes_));
+        LOG_DEBUG(logger_, "apollo client init notifications map from Apollo url: " + url);
+
+        auto started = std::chrono::steady_clock::now();
+        auto res = http_client_.get<NotificationsBody>(url);
+        recordConfigService(url,
+                            res.second,
+                            res.first.result(),
+                            std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - started));
+        if (isParseError(res.second))
+        {
+            throw std::runtime_error("apollo client failed to parse notifications from Apollo response");
+        }
+
+        if (res.second)
+        {
+            throw std::runtime_error("apollo client failed to fetch notifications from Apollo: " +
+                                     res.second.message());
+        }
+
+        if (res.first.result() != http::status::ok)
+        {
+            throw std::runtime_error("apollo client failed to fetch notifications from Apollo, status: " +
+                                     std::to_string(res.first.result_int()));
+        }
+
+        for (const auto& notification : res.first.body())
+        {
+            auto attribute_it = shard->namespace_attributes_.find(notification.namespace_name_);
+            if (attribute_it != shard->namespace_attributes_.end())
+            {
+                attribute_it->second->SetNotificationId(notification.notification_id_);
+            }
+        }
     }
 
-    if (res.first.result() != http::status::ok)
+    LOG_INFO(logger_, "apollo client init notifications map from Apollo successfully");
+}
+
+bool ApolloClientImpl::loadSnapshotCache()
+{
+    std::vector<SnapshotCache::Snapshot> snapshots(namespace_attributes_.size());
+    std::size_t i = 0;
+    for (const auto& p : namespace_attributes_)
     {
-        throw std::runtime_error("apollo client failed to fetch notifications from Apollo, status: " +
-                                 std::to_string(res.first.result_int()));
+        if (!snapshot_cache_->load(p.first, snapshots[i++]))
+        {
+            LOG_INFO(logger_, "apollo client namespace not found in cache, fetching from Apollo, namespace: " + p.first);
+            return false;
+        }
     }
 
-    Notifications notifications;
-    if (!fromJsonString(res.first.body(), notifications))
+    i = 0;
+    for (auto& p : namespace_attributes_)
     {
-        throw std::runtime_error("apollo client failed to parse notifications from Apollo response");
+        auto& snapshot = snapshots[i++];
+        p.second->SetReleaseKey(std::move(snapshot.release_key_));
+        p.second->SetConfigures(std::move(snapshot.configures_));
+        p.second->SetNotificationId(snapshot.notification_id_);
     }
 
-    for (const auto& notification : notifications)
+    LOG_INFO(logger_, "apollo client loaded configurations from cache: " + opts_.cache_dir_);
+    return true;
+}
+
+void ApolloClientImpl::storeSnapshotCache(const NamespaceType& s_namespace, const NamespaceAttributes& attributes)
+{
+    if (!snapshot_writer_)
     {
-        if (namespace_attributes_.find(notification.namespace_name_) != namespace_attributes_.end())
-        {
-            namespace_attributes_[notification.namespace_name_]->SetNotificationId(notification.notification_id_);
-        }
+        return;
     }
 
-    LOG_INFO(logger_, "apollo client init notifications map from Apollo successfully");
+    // Written off the strand, the writer logs the files it failed to write.
+    snapshot_writer_->write(
+        s_namespace, attributes.GetReleaseKey(), attributes.GetNotificationId(), attributes.GetSnapshot());
 }
 
-void ApolloClientImpl::longPollingThreadFunc()
+void ApolloClientImpl::longPollingThreadFunc(LongPollingShard& shard)
 {
-    assert(namespace_attributes_.size() > 0);
-    auto url = createNotificationsV2URL(app_id_, apollo_url_, opts_.cluster_name_, opts_.label_, namespace_attributes_);
+    assert(shard.namespace_attributes_.size() > 0);
+    auto url = routeURL(shard.url_.build(shard.namespace_attributes_));
     LOG_DEBUG(logger_, "apollo client long polling notification url: " + url);
 
-    auto res = http_client_.get(url);
-    if (res.second)
+    http_client_.getAsync<NotificationsBody>(
+        url,
+        [shared_this = pipeline_, &shard, url, started = std::chrono::steady_clock::now()](
+            beast::error_code ec, http::response<NotificationsBody> res)
+        { shared_this->onLongPollingNotifications(shard, url, started, ec, std::move(res)); });
+}
+
+void ApolloClientImpl::onLongPollingNotifications(LongPollingShard& shard,
+                                                  const std::string& url,
+                                                  std::chrono::steady_clock::time_point started,
+                                                  beast::error_code ec,
+                                                  http::response<NotificationsBody>&& res)
+{
+    if (!long_polling_running_)
     {
-        LOG_WARN(logger_,
-                 "apollo client long polling notification failed, url: " + url +
-                     " message: " + res.second.message());
-        setupLongPollingTimer();
         return;
     }
 
-    if (res.first.result() == http::status::not_modified)
+    client_metrics_.recordLatency(
+        ClientMetricsRecorder::Request::LongPoll,
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - started));
+    client_metrics_.recordFailure(ClientMetricsRecorder::Request::LongPoll, ec);
+    // Held by the server, its latency says nothing of the instance.
+    recordConfigService(url, ec, res.result());
+
+    if (isParseError(ec))
     {
-        setupLongPollingTimer();
+        LOG_WARN(logger_, "apollo client long polling notification parse failed, url: " + url);
+        setupLongPollingTimer(shard);
         return;
     }
 
-    if (res.first.result() != http::status::ok)
+    if (ec)
     {
+        LOG_WARN(logger_, "apollo client long polling notification failed, url: " + url + " message: " + ec.message());
+        setupLongPollingTimer(shard);
+        return;
+    }
+
+    // The server held the long poll without a change: every namespace of the shard is current.
+    if (res.result() == http::status::not_modified)
+    {
+        for (const auto& p : shard.namespace_attributes_)
+        {
+            client_metrics_.confirm(p.first);
+        }
+        setupLongPollingTimer(shard);
+        return;
+    }
+
+    if (res.result() != http::status::ok)
+    {
+        client_metrics_.recordHttpError(ClientMetricsRecorder::Request::LongPoll);
         LOG_WARN(logger_,
                  "apollo client long polling notification failed, url: " + url +
-                     " status: " + std::to_string(res.first.result_int()));
-        setupLongPollingTimer();
+                     " status: " + std::to_string(res.result_int()));
+        setupLongPollingTimer(shard);
         return;
     }
 
-    Notifications notifications;
-    if (!fromJsonString(res.first.body(), notifications))
+    // The namespaces not notified are current, the notified ones once fetched.
+    for (const auto& p : shard.namespace_attributes_)
     {
-        LOG_WARN(logger_, "apollo client long polling notification parse failed, url: " + url);
-        setupLongPollingTimer();
-        return;
+        const auto& notifications = res.body();
+        if (std::none_of(notifications.begin(),
+                         notifications.end(),
+                         [&p](const Notification& n) { return n.namespace_name_ == p.first; }))
+        {
+            client_metrics_.confirm(p.first);
+        }
     }
+    fetchChangedConfigurations(shard, res.body());
+}
 
+void ApolloClientImpl::fetchChangedConfigurations(LongPollingShard& shard, const Notifications& notifications)
+{
+    auto cycle = std::make_shared<LongPollingCycle>();
+    cycle->notified_at_ = std::chrono::steady_clock::now();
+    std::vector<std::string> urls;
     for (const auto& notification : notifications)
     {
-        auto attribute_it = namespace_attributes_.find(notification.namespace_name_);
-        if (attribute_it == namespace_attributes_.end())
+        auto attribute_it = shard.namespace_attributes_.find(notification.namespace_name_);
+        if (attribute_it == shard.namespace_attributes_.end())
         {
             continue;
         }
 
-        auto no_cache_url = createNoCacheConfigsURL(app_id_,
-                                                    apollo_url_,
-                                                    opts_.cluster_name_,
-                                                    notification.namespace_name_,
-                                                    opts_.label_,
-                                                    attribute_it->second->GetReleaseKey(),
-                                                    notification.notification_id_);
+        auto no_cache_url = routeURL(configs_url_->build(notification.namespace_name_,
+                                                         attribute_it->second->GetReleaseKey(),
+                                                         notification.notification_id_));
         LOG_DEBUG(logger_, "apollo client long polling configurations url: " + no_cache_url);
 
-        auto no_cache_res = http_client_.get(no_cache_url);
-        if (no_cache_res.second)
-        {
-            LOG_WARN(logger_, "apollo client long polling configurations failed, url: " + no_cache_url);
-            continue;
-        }
+        ConfigurationsUpdate update;
+        update.notification_ = notification;
+        update.attributes_ = attribute_it->second;
+        update.url_ = no_cache_url;
+        cycle->updates_.push_back(std::move(update));
+        urls.push_back(std::move(no_cache_url));
+    }
 
-        if (no_cache_res.first.result() != http::status::ok)
+    if (cycle->updates_.empty())
+    {
+        setupLongPollingTimer(shard);
+        return;
+    }
+
+    auto scheduler = std::make_shared<FetchScheduler<ConfigsBody>>(
+        http_client_,
+        std::move(urls),
+        static_cast<std::size_t>(opts_.update_fetch_concurrency_),
+        [this, cycle](std::size_t index,
+                      beast::error_code ec,
+                      http::response<ConfigsBody>&& res,
+                      std::chrono::microseconds elapsed)
+        { onChangedConfigurations(*cycle, cycle->updates_[index], ec, std::move(res), elapsed); },
+        [shared_this = pipeline_, &shard, cycle]()
         {
-            continue;
-        }
+            if (!shared_this->long_polling_running_)
+            {
+                return;
+            }
+            shared_this->recordLongPollingCycle(*cycle);
+            shared_this->setupLongPollingTimer(shard);
+        });
+    shard.fetch_scheduler_ = scheduler;
+    scheduler->start();
+}
+
+void ApolloClientImpl::onChangedConfigurations(LongPollingCycle& cycle,
+                                               const ConfigurationsUpdate& update,
+                                               beast::error_code ec,
+                                               http::response<ConfigsBody>&& res,
+                                               std::chrono::microseconds elapsed)
+{
+    if (!long_polling_running_)
+    {
+        return;
+    }
+
+    client_metrics_.recordLatency(ClientMetricsRecorder::Request::Fetch, elapsed);
+    client_metrics_.recordFailure(ClientMetricsRecorder::Request::Fetch, ec);
+    recordConfigService(update.url_, ec, res.result(), elapsed);
+
+    if (isParseError(ec))
+    {
+        LOG_WARN(logger_, "apollo client long polling configurations parse failed, url: " + update.url_);
+        ++cycle.failures_;
+        return;
+    }
+
+    if (ec)
+    {
+        LOG_WARN(logger_,
+                 "apollo client long polling configurations failed, url: " + update.url_ +
+                     " message: " + ec.message());
+        ++cycle.failures_;
+        return;
+    }
+
+    if (res.result() != http::status::ok)
+    {
+        client_metrics_.recordHttpError(ClientMetricsRecorder::Request::Fetch);
+        ++cycle.failures_;
+        return;
+    }
+
+    publishConfigurations(update, std::move(res.body().release_key_), std::move(res.body().configures_));
+    client_metrics_.confirm(update.notification_.namespace_name_);
+
+    auto latency =
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - cycle.notified_at_);
+    client_metrics_.recordPropagation(latency);
+    if (cycle.published_++ == 0)
+    {
+        cycle.first_publish_ = latency;
+    }
+    cycle.last_publish_ = latency;
+}
+
+void ApolloClientImpl::publishConfigurations(const ConfigurationsUpdate& update,
+                                             std::string&& release_key,
+                                             Configures&& configures)
+{
+    // Same release as the one published, nothing changed: skip the diff and the callback.
+    if (release_key == update.attributes_->GetReleaseKey())
+    {
+        update.attributes_->SetNotificationId(update.notification_.notification_id_);
+        storeSnapshotCache(update.notification_.namespace_name_, *update.attributes_);
+        return;
+    }
+
+    auto old_configures = update.attributes_->GetSnapshot();
 
-        std::string new_release_key;
-        Configures new_configures;
+    update.attributes_->SetReleaseKey(std::move(release_key));
+    update.attributes_->SetConfigures(std::move(configures));
+    update.attributes_->SetNotificationId(update.notification_.notification_id_);
+    storeSnapshotCache(update.notification_.namespace_name_, *update.attributes_);
 
-        if (!fromJsonString(no_cache_res.first.body(), new_release_key, new_configures))
+    // The callback runs once the release is published, off the strand unless listener_threads_ is 0.
+    // stopLongPolling flushes the dispatcher, so the client outlives the callbacks it queued.
+    listener_dispatcher_->dispatch(this,
+                                   update.notification_.namespace_name_,
+                                   std::move(old_configures),
+                                   update.attributes_->GetSnapshot(),
+                                   [this](const NamespaceType& s_namespace, const Configures& olds, const Configures& news)
+                                   {
+                                       std::shared_ptr<NotificationCallback> callback;
+                                       {
+                                           std::unique_lock<std::mutex> lock(listener_mutex_);
+                                           callback = notification_callback_.lock();
+                                       }
+                                       bool listened = listener_registry_.listens(s_namespace);
+                                       if (!callback && !listened)
+                                       {
+                                           return;
+                                       }
+
+                                       auto changes = ConfiguresDiff(olds, news);
+                                       if (listened)
+                                       {
+                                           listener_registry_.notify(s_namespace, olds, news, changes);
+                                       }
+                                       if (callback)
+                                       {
+                                           safeCall(*callback, s_namespace, olds, news, std::move(changes));
+                                       }
+                                   });
+}
+
+void ApolloClientImpl::recordLongPollingCycle(const LongPollingCycle& cycle)
+{
+    LOG_DEBUG(logger_,
+              "apollo client long polling cycle published " + std::to_string(cycle.published_) + " of " +
+                  std::to_string(cycle.updates_.size()) + " namespaces, last after " +
+                  std::to_string(cycle.last_publish_.count()) + " us");
+
+    std::unique_lock<std::mutex> lock(metrics_mutex_);
+    ++long_polling_metrics_.cycles_;
+    long_polling_metrics_.namespaces_published_ += cycle.published_;
+    long_polling_metrics_.fetch_failures_ += cycle.failures_;
+    long_polling_metrics_.last_cycle_namespaces_ = cycle.published_;
+    long_polling_metrics_.last_cycle_first_publish_ = cycle.first_publish_;
+    long_polling_metrics_.last_cycle_last_publish_ = cycle.last_publish_;
+    long_polling_metrics_.max_cycle_last_publish_ =
+        std::max(long_polling_metrics_.max_cycle_last_publish_, cycle.last_publish_);
+}
+
+void ApolloClientImpl::setupLongPollingTimer(LongPollingShard& shard)
+{
+    shard.timer_.expires_after(std::chrono::milliseconds(long_polling_interval_));
+    shard.timer_.async_wait(
+        [shared_this = pipeline_, &shard](const boost::system::error_code& ec)
         {
-            LOG_WARN(logger_, "apollo client long polling configurations parse failed, url: " + no_cache_url);
-            continue;
-        }
+            if (ec == boost::asio::error::operation_aborted)
+            {
+                // Timer was cancelled by stopLongPolling
+                return;
+            }
 
-        auto old_configures = attribute_it->second->GetConfigures();
+            if (shared_this->long_polling_running_)
+            {
+                shared_this->longPollingThreadFunc(shard);
+            }
+        });
+}
 
-        auto callback = notification_callback_.lock();
-        if (callback)
+void ApolloClientImpl::discoverConfigServices()
+{
+    LOG_DEBUG(logger_, "apollo client discover config services from meta server url: " + config_services_url_);
+    auto res = http_client_.get(config_services_url_);
+    if (res.second || res.first.result() != http::status::ok || !updateConfigServices(res.first.body()))
+    {
+        LOG_WARN(logger_,
+                 "apollo client failed to discover config services from meta server, using apollo url: " + apollo_url_);
+    }
+}
+
+bool ApolloClientImpl::updateConfigServices(const std::string& body)
+{
+    std::vector<std::string> urls;
+    if (!parseConfigServices(body, urls) || urls.empty())
+    {
+        return false;
+    }
+
+    config_services_->update(urls);
+    config_services_->decay();
+    LOG_DEBUG(logger_, "apollo client discovered " + std::to_string(urls.size()) + " config services");
+    return true;
+}
+
+void ApolloClientImpl::setupDiscoveryTimer()
+{
+    if (!config_services_)
+    {
+        return;
+    }
+
+    auto interval_ms = discover_at_start_ ? 0 : opts_.service_discovery_interval_ms_;
+    discover_at_start_ = false;
+    discovery_timer_.expires_after(std::chrono::milliseconds(interval_ms));
+    discovery_timer_.async_wait(
+        [shared_this = pipeline_](const boost::system::error_code& ec)
         {
-            safeCall(*callback,
-                     notification.namespace_name_,
-                     old_configures,
-                     new_configures,
-                     ConfiguresDiff(old_configures, new_configures));
-        }
+            if (ec == boost::asio::error::operation_aborted)
+            {
+                // Timer was cancelled by stopLongPolling
+                return;
+            }
+
+            if (shared_this->long_polling_running_)
+            {
+                shared_this->http_client_.getAsync(
+                    shared_this->config_services_url_,
+                    [shared_this](beast::error_code ec, http::response<http::string_body> res)
+                    { shared_this->onConfigServices(ec, std::move(res)); });
+            }
+        });
+}
 
-        attribute_it->second->SetReleaseKey(std::move(new_release_key));
-        attribute_it->second->SetConfigures(std::move(new_configures));
-        attribute_it->second->SetNotificationId(notification.notification_id_);
+void ApolloClientImpl::onConfigServices(beast::error_code ec, http::response<http::string_body>&& res)
+{
+    if (!long_polling_running_)
+    {
+        return;
     }
 
-    setupLongPollingTimer();
-    return;
+    // The instances listed before are kept until the meta server lists some again.
+    if (ec || res.result() != http::status::ok || !updateConfigServices(res.body()))
+    {
+        LOG_WARN(logger_, "apollo client failed to discover config services from meta server: " + config_services_url_);
+    }
+    setupDiscoveryTimer();
+}
+
+std::string ApolloClientImpl::routeURL(const std::string& url) const
+{
+    return config_services_ ? config_services_->route(url) : url;
+}
+
+void ApolloClientImpl::recordConfigService(const std::string& url,
+                                           beast::error_code ec,
+                                           http::status status,
+                                           std::chrono::microseconds latency)
+{
+    if (!config_services_ || ec == net::error::operation_aborted)
+    {
+        return;
+    }
+
+    // Any answer but a server error shows the instance is healthy, e.g. 304 or 404 of an unknown namespace.
+    bool failed = ec || static_cast<unsigned>(status) >= 500;
+    config_services_->record(url, failed, latency);
+}
+
+void ApolloClientImpl::scheduleRefreshes()
+{
+    refresh_schedule_.clear();
+    if (opts_.refresh_interval_ms_ <= 0)
+    {
+        return;
+    }
+
+    // Spread the first refresh of every namespace over a whole interval, so neither the namespaces of a client
+    // nor a fleet of clients started together refresh in lockstep.
+    auto now = std::chrono::steady_clock::now();
+    std::uniform_int_distribution<int> phase(0, opts_.refresh_interval_ms_ - 1);
+    for (const auto& p : namespace_attributes_)
+    {
+        refresh_schedule_.emplace(now + std::chrono::milliseconds(phase(refresh_random_)), p.first);
+    }
+    setupRefreshTimer();
 }
 
-void ApolloClientImpl::setupLongPollingTimer()
+void ApolloClientImpl::setupRefreshTimer()
 {
-    long_polling_timer_.expires_after(std::chrono::milliseconds(long_polling_interval_));
-    long_polling_timer_.async_wait(
-        [shared_this = shared_from_this()](const boost::system::error_code& ec)
+    if (refresh_schedule_.empty())
+    {
+        return;
+    }
+
+    refresh_timer_.expires_at(refresh_schedule_.begin()->first);
+    refresh_timer_.async_wait(
+        [shared_this = pipeline_](const boost::system::error_code& ec)
         {
             if (ec == boost::asio::error::operation_aborted)
             {
-                // Timer was cancelled, likely due to io_context stopping
+                // Timer was cancelled by stopLongPolling
                 return;
             }
 
             if (shared_this->long_polling_running_)
             {
-                shared_this->longPollingThreadFunc();
+                shared_this->refreshDueConfigurations();
             }
         });
 }
 
+void ApolloClientImpl::refreshDueConfigurations()
+{
+    auto now = std::chrono::steady_clock::now();
+    auto updates = std::make_shared<std::vector<ConfigurationsUpdate>>();
+    std::vector<std::string> urls;
+
+    // Later refreshes keep a +/-10% jitter, so the phases drift apart rather than converge.
+    std::uniform_int_distribution<int> interval(opts_.refresh_interval_ms_ - opts_.refresh_interval_ms_ / 10,
+                                                opts_.refresh_interval_ms_ + opts_.refresh_interval_ms_ / 10);
+    while (!refresh_schedule_.empty() && refresh_schedule_.begin()->first <= now)
+    {
+        auto s_namespace = std::move(refresh_schedule_.begin()->second);
+        refresh_schedule_.erase(refresh_schedule_.begin());
+
+        auto attributes = namespace_attributes_.at(s_namespace);
+        auto url = routeURL(configs_url_->build(s_namespace, attributes->GetReleaseKey(), attributes->GetNotificationId()));
+        LOG_DEBUG(logger_, "apollo client refresh configurations url: " + url);
+
+        ConfigurationsUpdate update;
+        update.notification_.namespace_name_ = s_namespace;
+        update.attributes_ = attributes;
+        update.url_ = url;
+        update.release_key_ = attributes->GetReleaseKey();
+        updates->push_back(std::move(update));
+        urls.push_back(std::move(url));
+
+        refresh_schedule_.emplace(now + std::chrono::milliseconds(interval(refresh_random_)), std::move(s_namespace));
+    }
+
+    if (updates->empty())
+    {
+        setupRefreshTimer();
+        return;
+    }
+
+    auto scheduler = std::make_shared<FetchScheduler<ConfigsBody>>(
+        http_client_,
+        std::move(urls),
+        static_cast<std::size_t>(opts_.update_fetch_concurrency_),
+        [this, updates](std::size_t index,
+                        beast::error_code ec,
+                        http::response<ConfigsBody>&& res,
+                        std::chrono::microseconds elapsed)
+        { onRefreshedConfigurations((*updates)[index], ec, std::move(res), elapsed); },
+        [shared_this = pipeline_]()
+        {
+            if (shared_this->long_polling_running_)
+            {
+                shared_this->setupRefreshTimer();
+            }
+        });
+    refresh_scheduler_ = scheduler;
+    scheduler->start();
+}
+
+void ApolloClientImpl::onRefreshedConfigurations(const ConfigurationsUpdate& update,
+                                                 beast::error_code ec,
+                                                 http::response<ConfigsBody>&& res,
+                                                 std::chrono::microseconds elapsed)
+{
+    if (!long_polling_running_)
+    {
+        return;
+    }
+
+    client_metrics_.recordLatency(ClientMetricsRecorder::Request::Fetch, elapsed);
+    client_metrics_.recordFailure(ClientMetricsRecorder::Request::Fetch, ec);
+    recordConfigService(update.url_, ec, res.result(), elapsed);
+
+    if (isParseError(ec))
+    {
+        LOG_WARN(logger_, "apollo client refresh configurations parse failed, url: " + update.url_);
+        return;
+    }
+
+    if (ec)
+    {
+        LOG_WARN(logger_, "apollo client refresh configurations failed, url: " + update.url_ + " message: " + ec.message());
+        return;
+    }
+
+    // Release still current: there is no body to parse and nothing to diff.
+    if (res.result() == http::status::not_modified)
+    {
+        client_metrics_.confirm(update.notification_.namespace_name_);
+        std::unique_lock<std::mutex> lock(metrics_mutex_);
+        ++long_polling_metrics_.refreshes_;
+        ++long_polling_metrics_.refreshes_not_modified_;
+        return;
+    }
+
+    if (res.result() != http::status::ok)
+    {
+        client_metrics_.recordHttpError(ClientMetricsRecorder::Request::Fetch);
+        LOG_WARN(logger_,
+                 "apollo client refresh configurations failed, url: " + update.url_ +
+                     " status: " + std::to_string(res.result_int()));
+        return;
+    }
+
+    // Long polling published a newer release while the refresh was in flight, its response is stale.
+    if (update.attributes_->GetReleaseKey() != update.release_key_)
+    {
+        LOG_DEBUG(logger_,
+                  "apollo client refresh superseded by long polling, namespace: " +
+                      update.notification_.namespace_name_);
+        std::unique_lock<std::mutex> lock(metrics_mutex_);
+        ++long_polling_metrics_.refreshes_;
+        return;
+    }
+
+    bool missed = res.body().release_key_ != update.attributes_->GetReleaseKey();
+    if (missed)
+    {
+        LOG_INFO(logger_,
+                 "apollo client refresh found a release missed by long polling, namespace: " +
+                     update.notification_.namespace_name_);
+    }
+
+    // Keep the notification id long polling is at, it may have moved while the refresh was in flight.
+    ConfigurationsUpdate current = update;
+    current.notification_.notification_id_ = update.attributes_->GetNotificationId();
+    publishConfigurations(current, std::move(res.body().release_key_), std::move(res.body().configures_));
+    client_metrics_.confirm(update.notification_.namespace_name_);
+
+    std::unique_lock<std::mutex> lock(metrics_mutex_);
+    ++long_polling_metrics_.refreshes_;
+    if (missed)
+    {
+        ++long_polling_metrics_.refreshes_published_;
+    }
+}
+
 }  // namespace client
 }  // namespace apollo
\ No newline at end of file
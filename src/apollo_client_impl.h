@@ -1,13 +1,28 @@
 #pragma once
 
+#include <chrono>
+#include <future>
 #include <memory>
+#include <map>
+#include <mutex>
+#include <random>
 #include <string>
+#include <vector>
 #include <boost/asio.hpp>
 #include <thread>
 #include "apollo/apollo_client.h"
 #include "apollo/apollo_types.h"
 #include "apollo_internal.h"
+#include "apollo_runtime_impl.h"
+#include "client_metrics.h"
+#include "config_service_selector.h"
+#include "fetch_scheduler.h"
 #include "http_client.h"
+#include "json_body.h"
+#include "listener_dispatcher.h"
+#include "listener_registry.h"
+#include "snapshot_cache.h"
+#include "url_builder.h"
 
 namespace apollo
 {
@@ -21,7 +36,30 @@ public:
     void startLongPolling(int long_polling_interval_ms = long_poller_interval_default) override;
     void stopLongPolling() override;
     Configures getConfigures(const NamespaceType& s_namespace) override;
+    ConfiguresPtr getSnapshot(const NamespaceType& s_namespace) override;
+    ValuePtr getValue(const NamespaceType& s_namespace, const std::string& key) override;
+    ValuePtr getValueOr(const NamespaceType& s_namespace,
+                        const std::string& key,
+                        const std::string& default_value) override;
+    ValuePtr getValueOr(const NamespaceType& s_namespace,
+                        const std::string& key,
+                        const ValuePtr& default_value) override;
     void setNotificationsListener(NotificationCallbackPtr notificationCallback) override;
+    ListenerId addNotificationsListener(const NamespaceType& s_namespace,
+                                        NotificationCallbackPtr notificationCallback,
+                                        const std::string& key = "",
+                                        KeyMatch match = KeyMatch::Prefix) override;
+    void removeNotificationsListener(ListenerId id) override;
+    LongPollingMetrics getLongPollingMetrics() override;
+    TransferMetrics getTransferMetrics() override;
+    ListenerMetrics getListenerMetrics() override;
+    ClientMetrics getClientMetrics() override;
+
+protected:
+    ParsedValuePtr getParsedValue(const NamespaceType& s_namespace,
+                                  const std::string& key,
+                                  const std::type_info& type,
+                                  ValueParseFunction parse) override;
 
 private:
     ApolloClientImpl(const ApolloClientImpl&) = delete;             // Disable copy constructor
@@ -30,10 +68,93 @@ private:
     ApolloClientImpl& operator=(ApolloClientImpl&&) = delete;  // Disable move assignment operator
 
     void initNamespaceAttributes();  // throw std::runtime_error if namespace attributes initialized failed
+    void initLongPollingShards();
     void initConfigurationsMap();  // throw std::runtime_error if configurations map initialized failed
     void initNotificationsIdMap();  // throw std::runtime_error if notificationsId map initialized failed
-    void longPollingThreadFunc();
-    void setupLongPollingTimer();
+    bool loadSnapshotCache();       // true if every namespace was loaded from the cache
+    void storeSnapshotCache(const NamespaceType& s_namespace, const NamespaceAttributes& attributes);
+
+    // Blocks until the requests started on strand_ completed, done is set by their completion handler.
+    // Without a shared runtime the io_context is run by the calling thread meanwhile.
+    void waitForRequests(std::future<void>& done);
+
+    // Long polling runs as an asynchronous pipeline on strand_:
+    // notifications long poll -> bounded concurrent fetches of the changed namespaces, each published
+    // as soon as it is fetched -> timer.
+    // Its handlers hold pipeline_ rather than a plain reference to the client, so that stopLongPolling
+    // knows when the last of them completed.
+    // The namespaces are split into shards bounded by Opts::long_polling_max_url_length_ and
+    // long_polling_max_namespaces_, each shard runs a pipeline of its own, concurrently with the others.
+    struct LongPollingShard
+    {
+        LongPollingShard(NamespaceAttributesMap&& namespace_attributes, NotificationsURLBuilder&& url, Strand& strand)
+            : namespace_attributes_(std::move(namespace_attributes)), url_(std::move(url)), timer_(strand)
+        {
+        }
+
+        NamespaceAttributesMap namespace_attributes_;  // Polled by the shard, shared with the client's map
+        NotificationsURLBuilder url_;                   // strand_ only
+        net::steady_timer timer_;
+        std::weak_ptr<FetchScheduler<ConfigsBody>> fetch_scheduler_;  // Configurations fetch in flight, strand_ only
+    };
+
+    struct ConfigurationsUpdate
+    {
+        Notification notification_;
+        NamespaceAttributesPtr attributes_;
+        std::string url_;
+        std::string release_key_;  // Sent by a refresh, the release its response is relative to
+    };
+
+    struct LongPollingCycle
+    {
+        std::chrono::steady_clock::time_point notified_at_;
+        std::vector<ConfigurationsUpdate> updates_;
+        std::size_t published_ = 0;
+        std::size_t failures_ = 0;
+        std::chrono::microseconds first_publish_{0};
+        std::chrono::microseconds last_publish_{0};
+    };
+
+    void longPollingThreadFunc(LongPollingShard& shard);
+    void onLongPollingNotifications(LongPollingShard& shard,
+                                    const std::string& url,
+                                    std::chrono::steady_clock::time_point started,
+                                    beast::error_code ec,
+                                    http::response<NotificationsBody>&& res);
+    void fetchChangedConfigurations(LongPollingShard& shard, const Notifications& notifications);
+    void onChangedConfigurations(LongPollingCycle& cycle,
+                                 const ConfigurationsUpdate& update,
+                                 beast::error_code ec,
+                                 http::response<ConfigsBody>&& res,
+                                 std::chrono::microseconds elapsed);
+    void publishConfigurations(const ConfigurationsUpdate& update, std::string&& release_key, Configures&& configures);
+    void recordLongPollingCycle(const LongPollingCycle& cycle);
+    void setupLongPollingTimer(LongPollingShard& shard);
+
+    // Config service discovery, on strand_ as well: the instances are listed by the meta server at creation,
+    // then again every Opts::service_discovery_interval_ms_. Every request is routed to the instance
+    // selected by config_services_ and its outcome recorded, so a failing instance is left at once.
+    void discoverConfigServices();  // Logs and keeps apollo_url_ if the meta server cannot be reached
+    bool updateConfigServices(const std::string& body);
+    void setupDiscoveryTimer();
+    void onConfigServices(beast::error_code ec, http::response<http::string_body>&& res);
+    std::string routeURL(const std::string& url) const;
+    void recordConfigService(const std::string& url,
+                             beast::error_code ec,
+                             http::status status,
+                             std::chrono::microseconds latency = std::chrono::microseconds(-1));
+
+    // Consistency refresh, on strand_ as well: each namespace is fetched with its current
+    // release key once per refresh interval, at a jittered time, so a release whose notification was missed
+    // is eventually published. The server answers 304 while the release is current.
+    void scheduleRefreshes();
+    void setupRefreshTimer();
+    void refreshDueConfigurations();
+    void onRefreshedConfigurations(const ConfigurationsUpdate& update,
+                                   beast::error_code ec,
+                                   http::response<ConfigsBody>&& res,
+                                   std::chrono::microseconds elapsed);
 
 private:
     int long_polling_interval_;
@@ -43,11 +164,33 @@ private:
     Opts opts_;
     NamespaceAttributesMap namespace_attributes_;
     LoggerPtr logger_;
-    NotificationCallbackPtr notification_callback_;
+    std::mutex listener_mutex_;
+    NotificationCallbackPtr notification_callback_;  // listener_mutex_
+    ListenerRegistry listener_registry_;
+    std::unique_ptr<SnapshotCache> snapshot_cache_;
+    std::unique_ptr<SnapshotWriter> snapshot_writer_;  // Writes to snapshot_cache_, destroyed before it
+    std::unique_ptr<ConfigsURLBuilder> configs_url_;
+    std::unique_ptr<ConfigServiceSelector> config_services_;  // nullptr without meta server
+    std::string config_services_url_;                          // /services/config of the meta server
+    std::shared_ptr<ApolloRuntimeImpl> runtime_;              // Shared runtime, nullptr if the client runs its own
+    std::unique_ptr<boost::asio::io_context> own_io_context_;  // Without a shared runtime, run by long_polling_thread_
+    boost::asio::io_context& io_context_;
+    Strand strand_;  // Serializes the handlers of the client
+    std::shared_ptr<ListenerDispatcher> listener_dispatcher_;  // Runs the notification callbacks, maybe shared
     std::thread long_polling_thread_;
-    boost::asio::io_context io_context_;
-    net::steady_timer long_polling_timer_;
     HttpClient http_client_;
+    std::shared_ptr<ApolloClientImpl> pipeline_;  // Held by the long polling handlers, strand_ only
+    std::future<void> pipeline_released_;         // Ready once the handlers released the pipeline
+    std::vector<std::unique_ptr<LongPollingShard>> long_polling_shards_;  // Init, then strand_ only
+    net::steady_timer refresh_timer_;
+    std::multimap<std::chrono::steady_clock::time_point, NamespaceType> refresh_schedule_;  // strand_ only
+    std::weak_ptr<FetchScheduler<ConfigsBody>> refresh_scheduler_;  // Refreshes in flight, strand_ only
+    std::minstd_rand refresh_random_;
+    net::steady_timer discovery_timer_;
+    bool discover_at_start_ = false;  // Started from the cache without discovery, strand_ once polling
+    std::mutex metrics_mutex_;
+    LongPollingMetrics long_polling_metrics_;
+    ClientMetricsRecorder client_metrics_;
 };
 }  // namespace client
 }  // namespace apollo
\ No newline at end of file
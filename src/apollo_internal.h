@@ -4,10 +4,12 @@
 #include <mutex>
 #include <string>
 #include <vector>
-#include <atomic>
 #include <map>
 #include <memory>
 #include "apollo/apollo_types.h"
+#include "atomic_shared_ptr.h"
+#include "configures_index.h"
+#include "parsed_value_cache.h"
 
 namespace apollo
 {
@@ -21,12 +23,38 @@ struct Notification
 };
 using Notifications = std::vector<Notification>;
 
+// Body of a /configs response.
+struct ConfigsResponse
+{
+    std::string release_key_;
+    Configures configures_;
+};
+
+// One immutable release of a namespace, the configures and its lookup index are published together.
+// Stored as Configures, not FrozenConfigures: getSnapshot(), the diff of every publish and the cache writer
+// read the release as Configures, and ValuePtr and the parsed values alias its std::string values.
+struct NamespaceRelease
+{
+    explicit NamespaceRelease(Configures&& configures)
+        : configures_(std::move(configures))
+        , index_(configures_)
+        , parsed_(index_.slotCount())
+    {
+    }
+
+    const Configures configures_;
+    const ConfiguresIndex index_;     // Built once per release, indexes configures_
+    mutable ParsedValueCache parsed_;  // Typed values parsed on demand, by slot of index_
+};
+using NamespaceReleasePtr = std::shared_ptr<const NamespaceRelease>;
+
 class NamespaceAttributes
 {
 public:
     NamespaceAttributes(const std::string& release_key = "", int initial_notification_id = -1)
         : release_key_mutex_()
         , release_key_(release_key)
+        , release_(std::make_shared<const NamespaceRelease>(Configures()))
         , notification_id_(initial_notification_id)
     {
     }
@@ -40,14 +68,56 @@ public:
 
     inline void SetConfigures(Configures&& configures)
     {
-        std::unique_lock<std::mutex> lock(configures_mutex_);
-        configures_ = std::move(configures);
+        // Publish a new immutable release (RCU-style); readers holding the previous release keep it alive.
+        NamespaceReleasePtr release = std::make_shared<const NamespaceRelease>(std::move(configures));
+        release_.store(std::move(release));
     }
 
     inline Configures GetConfigures() const
     {
-        std::unique_lock<std::mutex> lock(configures_mutex_);
-        return configures_;
+        return *GetSnapshot();
+    }
+
+    inline ConfiguresPtr GetSnapshot() const
+    {
+        auto release = GetRelease();
+        return ConfiguresPtr(release, &release->configures_);
+    }
+
+    // Returns the value of the key pinned to the current release, or nullptr if the key does not exist.
+    inline ValuePtr GetValue(const std::string& key) const
+    {
+        auto release = GetRelease();
+        const std::string* value = release->index_.find(key);
+        if (value == nullptr)
+        {
+            return nullptr;
+        }
+        return ValuePtr(release, value);
+    }
+
+    // Returns the value of the key parsed by parse and pinned to the current release, parsed once per release
+    // and type. nullptr if the key does not exist or its value is invalid.
+    inline ParsedValuePtr GetParsedValue(const std::string& key, std::type_index type, ValueParseFunction parse) const
+    {
+        auto release = GetRelease();
+        std::size_t slot = release->index_.findSlot(key);
+        if (slot == ConfiguresIndex::npos)
+        {
+            return nullptr;
+        }
+
+        const auto& parsed = release->parsed_.get(slot, type, release->index_.slotValue(slot), parse);
+        if (!parsed)
+        {
+            return nullptr;
+        }
+        return ParsedValuePtr(release, parsed.get());
+    }
+
+    inline NamespaceReleasePtr GetRelease() const
+    {
+        return release_.load();
     }
 
     inline void SetReleaseKey(std::string&& release_key)
@@ -70,11 +140,10 @@ public:
     }
 
 private:
-    std::string release_key_;               // The release key for the namespace
-    mutable std::mutex release_key_mutex_;  // Mutex to protect access to the release key
-    Configures configures_;                 // Configuration key-value pairs for the namespace
-    mutable std::mutex configures_mutex_;   // Mutex to protect access to the configuration
-    std::atomic_int notification_id_;       // Atomic notification ID for thread-safe access
+    std::string release_key_;                          // The release key for the namespace
+    mutable std::mutex release_key_mutex_;             // Mutex to protect access to the release key
+    AtomicSharedPtr<const NamespaceRelease> release_;  // Immutable configuration release, loaded without lock
+    std::atomic_int notification_id_;                  // Atomic notification ID for thread-safe access
 };
 
 using NamespaceAttributesPtr = std::shared_ptr<NamespaceAttributes>;
@@ -0,0 +1,45 @@
+#include "apollo_runtime_impl.h"
+
+namespace apollo
+{
+namespace client
+{
+ApolloRuntimeImpl::ApolloRuntimeImpl(const RuntimeOpts& opts)
+    : io_context_(std::make_shared<boost::asio::io_context>(opts.thread_count_))
+    , work_(boost::asio::make_work_guard(*io_context_))
+    , connection_pool_(std::make_shared<ConnectionPool>(opts.max_connections_per_host_, opts.connection_idle_timeout_ms_))
+    , resolver_cache_(std::make_shared<ResolverCache>(*io_context_, opts.dns_cache_ttl_ms_))
+    , listener_dispatcher_(std::make_shared<ListenerDispatcher>(opts.listener_threads_))
+{
+    threads_.reserve(static_cast<std::size_t>(opts.thread_count_));
+    for (int i = 0; i < opts.thread_count_; ++i)
+    {
+        threads_.emplace_back([io_context = io_context_]() { io_context->run(); });
+    }
+}
+
+ApolloRuntimeImpl::~ApolloRuntimeImpl()
+{
+    work_.reset();
+    io_context_->stop();
+    for (auto& thread : threads_)
+    {
+        // The last reference may be released by a handler running on one of the threads. That thread is
+        // detached, it returns from run() once the handler returned and only then releases the io_context.
+        if (thread.get_id() == std::this_thread::get_id())
+        {
+            thread.detach();
+        }
+        else if (thread.joinable())
+        {
+            thread.join();
+        }
+    }
+}
+
+std::size_t ApolloRuntimeImpl::threadCount() const
+{
+    return threads_.size();
+}
+}  // namespace client
+}  // namespace apollo
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <memory>
+#include <thread>
+#include <vector>
+#include <boost/asio.hpp>
+#include "apollo/apollo_client.h"
+#include "apollo/apollo_types.h"
+#include "connection_pool.h"
+#include "listener_dispatcher.h"
+#include "resolver_cache.h"
+
+namespace apollo
+{
+namespace client
+{
+class ApolloRuntimeImpl : public ApolloRuntime
+{
+public:
+    explicit ApolloRuntimeImpl(const RuntimeOpts& opts);
+    ~ApolloRuntimeImpl() override;
+    std::size_t threadCount() const override;
+
+    inline boost::asio::io_context& ioContext()
+    {
+        return *io_context_;
+    }
+
+    inline const ConnectionPoolPtr& connectionPool() const
+    {
+        return connection_pool_;
+    }
+
+    inline const ResolverCachePtr& resolverCache() const
+    {
+        return resolver_cache_;
+    }
+
+    inline const std::shared_ptr<ListenerDispatcher>& listenerDispatcher() const
+    {
+        return listener_dispatcher_;
+    }
+
+private:
+    ApolloRuntimeImpl(const ApolloRuntimeImpl&) = delete;             // Disable copy constructor
+    ApolloRuntimeImpl& operator=(const ApolloRuntimeImpl&) = delete;  // Disable assignment operator
+
+    std::shared_ptr<boost::asio::io_context> io_context_;  // Shared with the threads, see ~ApolloRuntimeImpl()
+    boost::asio::executor_work_guard<boost::asio::io_context::executor_type> work_;  // Keeps the threads running while idle
+    ConnectionPoolPtr connection_pool_;
+    ResolverCachePtr resolver_cache_;
+    std::shared_ptr<ListenerDispatcher> listener_dispatcher_;
+    std::vector<std::thread> threads_;
+};
+}  // namespace client
+}  // namespace apollo
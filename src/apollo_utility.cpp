@@ -1,8 +1,11 @@
 #include "apollo_utility.h"
 #include "apollo_internal.h"
+#include "json_sax_handlers.h"
 #include "boost/url/encode.hpp"
 #include "nlohmann/json.hpp"
 #include <boost/url.hpp>
+#include <algorithm>
+#include <iterator>
 #include <sstream>
 #include <string>
 
@@ -127,17 +130,8 @@ bool fromJsonString(const std::string& jsonString, Notifications& notifications)
 {
     try
     {
-        auto j = nlohmann::json::parse(jsonString);
-        notifications.clear();
-
-        for (const auto& item : j)
-        {
-            Notification notification;
-            item.at("namespaceName").get_to(notification.namespace_name_);
-            item.at("notificationId").get_to(notification.notification_id_);
-            notifications.push_back(notification);
-        }
-        return true;
+        NotificationsSaxHandler handler(notifications);
+        return nlohmann::json::sax_parse(jsonString, &handler) && handler.complete();
     }
     catch (const std::exception& e)
     {
@@ -163,10 +157,8 @@ bool fromJsonString(const std::string& jsonString, std::string& release_key, Con
 {
     try
     {
-        auto j = nlohmann::json::parse(jsonString);
-        j.at("releaseKey").get_to(release_key);
-        j.at("configurations").get_to(configures);
-        return true;
+        ConfigsSaxHandler handler(release_key, configures);
+        return nlohmann::json::sax_parse(jsonString, &handler) && handler.complete();
     }
     catch (const std::exception& e)
     {
@@ -198,33 +190,47 @@ bool isValidUrl(const std::string& url)
 Changes ConfiguresDiff(const Configures& old_config, const Configures& new_config)
 {
     Changes changes;
+    if (&old_config == &new_config)
+    {
+        return changes;
+    }
 
-    // Check for added or updated items
-    for (const auto& pair : new_config)
+    // Both maps are sorted by key, walk them side by side once.
+    // Added and updated items are reported first, then deleted items, each group in key order.
+    Changes deleted;
+    auto old_it = old_config.begin();
+    auto new_it = new_config.begin();
+    while (old_it != old_config.end() || new_it != new_config.end())
     {
-        auto it = old_config.find(pair.first);
-        if (it == old_config.end())
+        int order = old_it == old_config.end()   ? 1
+                    : new_it == new_config.end() ? -1
+                                                 : old_it->first.compare(new_it->first);
+        if (order < 0)
         {
-            // New item added
-            changes.emplace_back(ChangeType::Added, pair.first, pair.second);
+            // Item deleted
+            deleted.emplace_back(ChangeType::Deleted, old_it->first, old_it->second);
+            ++old_it;
         }
-        else if (it->second != pair.second)
+        else if (order > 0)
         {
-            // Existing item updated
-            changes.emplace_back(ChangeType::Updated, pair.first, pair.second);
+            // New item added
+            changes.emplace_back(ChangeType::Added, new_it->first, new_it->second);
+            ++new_it;
         }
-    }
-
-    // Check for deleted items
-    for (const auto& pair : old_config)
-    {
-        if (new_config.find(pair.first) == new_config.end())
+        else
         {
-            // Item deleted
-            changes.emplace_back(ChangeType::Deleted, pair.first, pair.second);
+            if (old_it->second != new_it->second)
+            {
+                // Existing item updated
+                changes.emplace_back(ChangeType::Updated, new_it->first, new_it->second);
+            }
+            ++old_it;
+            ++new_it;
         }
     }
 
+    changes.reserve(changes.size() + deleted.size());
+    std::move(deleted.begin(), deleted.end(), std::back_inserter(changes));
     return changes;
 }
 
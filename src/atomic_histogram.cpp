@@ -0,0 +1,57 @@
+#include "atomic_histogram.h"
+#include <algorithm>
+
+namespace apollo
+{
+namespace client
+{
+AtomicHistogram::AtomicHistogram(std::vector<std::uint64_t> bounds)
+    : bounds_(std::move(bounds))
+    , counts_(new std::atomic<std::uint64_t>[bounds_.size() + 1])
+{
+    for (std::size_t i = 0; i <= bounds_.size(); ++i)
+    {
+        counts_[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+void AtomicHistogram::record(std::uint64_t value)
+{
+    auto bucket = std::lower_bound(bounds_.begin(), bounds_.end(), value) - bounds_.begin();
+    counts_[bucket].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(value, std::memory_order_relaxed);
+}
+
+HistogramMetrics AtomicHistogram::snapshot() const
+{
+    HistogramMetrics metrics;
+    metrics.bounds_ = bounds_;
+    metrics.counts_.reserve(bounds_.size() + 1);
+    for (std::size_t i = 0; i <= bounds_.size(); ++i)
+    {
+        metrics.counts_.push_back(counts_[i].load(std::memory_order_relaxed));
+    }
+    metrics.count_ = count_.load(std::memory_order_relaxed);
+    metrics.sum_ = sum_.load(std::memory_order_relaxed);
+    return metrics;
+}
+
+std::vector<std::uint64_t> AtomicHistogram::latencyBounds()
+{
+    return {500,     1000,    2500,    5000,     10000,    25000,    50000,    100000,
+            250000,  500000,  1000000, 2500000,  5000000,  10000000, 30000000, 65000000};
+}
+
+std::vector<std::uint64_t> AtomicHistogram::processingBounds()
+{
+    return {10, 25, 50, 100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000};
+}
+
+std::vector<std::uint64_t> AtomicHistogram::sizeBounds()
+{
+    return {256, 1024, 4096, 16384, 65536, 262144, 1048576, 4194304, 16777216};
+}
+
+}  // namespace client
+}  // namespace apollo
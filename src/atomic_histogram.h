@@ -0,0 +1,43 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "apollo/apollo_types.h"
+
+namespace apollo
+{
+namespace client
+{
+/**
+ * Histogram over fixed buckets, recorded without locks: an observation is two relaxed increments and
+ * a relaxed add. A snapshot taken while observations are recorded may be off by those in progress.
+ */
+class AtomicHistogram
+{
+public:
+    explicit AtomicHistogram(std::vector<std::uint64_t> bounds);
+
+    void record(std::uint64_t value);
+    HistogramMetrics snapshot() const;
+
+    // Bounds in microseconds, from half a millisecond to past the 60 seconds a long poll is held.
+    static std::vector<std::uint64_t> latencyBounds();
+    // Bounds in microseconds, from 10 microseconds to 100 milliseconds, for work done without I/O.
+    static std::vector<std::uint64_t> processingBounds();
+    // Bounds in bytes, from 256 bytes to 16 MiB.
+    static std::vector<std::uint64_t> sizeBounds();
+
+private:
+    AtomicHistogram(const AtomicHistogram&) = delete;             // Disable copy constructor
+    AtomicHistogram& operator=(const AtomicHistogram&) = delete;  // Disable assignment operator
+
+    const std::vector<std::uint64_t> bounds_;
+    std::unique_ptr<std::atomic<std::uint64_t>[]> counts_;  // bounds_.size() + 1 buckets
+    std::atomic<std::uint64_t> count_{0};
+    std::atomic<std::uint64_t> sum_{0};
+};
+
+}  // namespace client
+}  // namespace apollo
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace apollo
+{
+namespace client
+{
+/**
+ * A shared_ptr published to concurrent readers without lock, e.g. the current release of a namespace.
+ *
+ * std::atomic_load and std::atomic_store on a shared_ptr take a mutex of a global pool in libstdc++.
+ * Here the shared_ptr lives in a heap slot whose address is swapped atomically. A reader announces itself
+ * in one of two counters, selected by the parity of epoch_, while it copies the shared_ptr out of the slot.
+ * A store swaps the slot, then flips the epoch twice, each time waiting for the counter the new readers
+ * left, before it frees the slot it replaced: a reader may have read the epoch before either flip.
+ *
+ * load() never waits: it costs two atomic increments and a decrement, of the counter and of the
+ * reference count. store() waits for the loads in flight, which only copy a shared_ptr, and is
+ * serialized with the other stores.
+ */
+template <class T>
+class AtomicSharedPtr
+{
+public:
+    explicit AtomicSharedPtr(std::shared_ptr<T> ptr = nullptr)
+        : slot_(new std::shared_ptr<T>(std::move(ptr)))
+    {
+    }
+
+    ~AtomicSharedPtr()
+    {
+        delete slot_.load();
+    }
+
+    std::shared_ptr<T> load() const
+    {
+        auto& readers = readers_[epoch_.load() & 1];
+        readers.count_.fetch_add(1);
+        std::shared_ptr<T> ptr = *slot_.load();
+        readers.count_.fetch_sub(1);
+        return ptr;
+    }
+
+    void store(std::shared_ptr<T> ptr)
+    {
+        std::unique_ptr<std::shared_ptr<T>> replaced;
+        {
+            std::unique_lock<std::mutex> lock(store_mutex_);
+            replaced.reset(slot_.exchange(new std::shared_ptr<T>(std::move(ptr))));
+            for (int flip = 0; flip < 2; ++flip)
+            {
+                auto& readers = readers_[epoch_.fetch_add(1) & 1];
+                while (readers.count_.load() != 0)
+                {
+                    std::this_thread::yield();
+                }
+            }
+        }
+        // The value replaced is released out of the lock, its destructor may be long.
+    }
+
+private:
+    AtomicSharedPtr(const AtomicSharedPtr&) = delete;             // Disable copy constructor
+    AtomicSharedPtr& operator=(const AtomicSharedPtr&) = delete;  // Disable assignment operator
+
+    // A cache line each, the readers of one epoch do not contend with the readers of the other.
+    struct alignas(64) Readers
+    {
+        mutable std::atomic<std::uint64_t> count_{0};
+    };
+
+    std::atomic<std::shared_ptr<T>*> slot_;
+    mutable Readers readers_[2];
+    std::atomic<std::uint64_t> epoch_{0};
+    std::mutex store_mutex_;  // Stores only, loads never take it
+};
+
+}  // namespace client
+}  // namespace apollo
@@ -0,0 +1,113 @@
+#include "client_metrics.h"
+#include <tuple>
+#include <utility>
+#include <boost/asio/error.hpp>
+#include <boost/beast/core/error.hpp>
+
+namespace apollo
+{
+namespace client
+{
+namespace
+{
+std::int64_t ticksNow()
+{
+    return std::chrono::steady_clock::now().time_since_epoch().count();
+}
+
+std::uint64_t microseconds(std::chrono::microseconds duration)
+{
+    return duration.count() > 0 ? static_cast<std::uint64_t>(duration.count()) : 0;
+}
+}  // namespace
+
+ClientMetricsRecorder::ClientMetricsRecorder(const std::vector<NamespaceType>& namespaces)
+{
+    auto now = ticksNow();
+    for (const auto& s_namespace : namespaces)
+    {
+        confirmed_at_.emplace(std::piecewise_construct, std::forward_as_tuple(s_namespace), std::forward_as_tuple(now));
+    }
+}
+
+void ClientMetricsRecorder::recordLatency(Request request, std::chrono::microseconds latency)
+{
+    (request == Request::LongPoll ? long_poll_latency_ : fetch_latency_).record(microseconds(latency));
+}
+
+void ClientMetricsRecorder::recordPropagation(std::chrono::microseconds delay)
+{
+    propagation_delay_.record(microseconds(delay));
+}
+
+void ClientMetricsRecorder::recordFailure(Request request, const boost::system::error_code& ec)
+{
+    if (!ec || ec == boost::asio::error::operation_aborted)
+    {
+        return;
+    }
+
+    auto& counters = failures(request);
+    // Bodies that cannot be parsed or decoded fail the read with bad_message or not_supported.
+    if (ec == boost::system::errc::bad_message || ec == boost::system::errc::not_supported)
+    {
+        counters.parse_errors_.fetch_add(1, std::memory_order_relaxed);
+    }
+    else if (ec == boost::asio::error::timed_out || ec == boost::beast::error::timeout)
+    {
+        counters.timeouts_.fetch_add(1, std::memory_order_relaxed);
+    }
+    else
+    {
+        counters.network_errors_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void ClientMetricsRecorder::recordHttpError(Request request)
+{
+    failures(request).http_errors_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void ClientMetricsRecorder::confirm(const NamespaceType& s_namespace)
+{
+    auto it = confirmed_at_.find(s_namespace);
+    if (it != confirmed_at_.end())
+    {
+        it->second.store(ticksNow(), std::memory_order_relaxed);
+    }
+}
+
+void ClientMetricsRecorder::load(ClientMetrics& metrics) const
+{
+    metrics.long_poll_latency_ = long_poll_latency_.snapshot();
+    metrics.fetch_latency_ = fetch_latency_.snapshot();
+    metrics.propagation_delay_ = propagation_delay_.snapshot();
+    metrics.long_poll_failures_ = long_poll_failures_.load();
+    metrics.fetch_failures_ = fetch_failures_.load();
+
+    auto now = std::chrono::steady_clock::now();
+    for (const auto& p : confirmed_at_)
+    {
+        std::chrono::steady_clock::time_point confirmed_at(
+            std::chrono::steady_clock::duration(p.second.load(std::memory_order_relaxed)));
+        metrics.staleness_[p.first] = std::chrono::duration_cast<std::chrono::milliseconds>(now - confirmed_at);
+    }
+}
+
+FailureMetrics ClientMetricsRecorder::Failures::load() const
+{
+    FailureMetrics metrics;
+    metrics.timeouts_ = timeouts_.load(std::memory_order_relaxed);
+    metrics.network_errors_ = network_errors_.load(std::memory_order_relaxed);
+    metrics.http_errors_ = http_errors_.load(std::memory_order_relaxed);
+    metrics.parse_errors_ = parse_errors_.load(std::memory_order_relaxed);
+    return metrics;
+}
+
+ClientMetricsRecorder::Failures& ClientMetricsRecorder::failures(Request request)
+{
+    return request == Request::LongPoll ? long_poll_failures_ : fetch_failures_;
+}
+
+}  // namespace client
+}  // namespace apollo
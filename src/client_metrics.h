@@ -0,0 +1,70 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <vector>
+#include <boost/system/error_code.hpp>
+#include "apollo/apollo_types.h"
+#include "atomic_histogram.h"
+
+namespace apollo
+{
+namespace client
+{
+/**
+ * Lock-free counters of the requests of a client, see ClientMetrics. Safe to record from any thread.
+ */
+class ClientMetricsRecorder
+{
+public:
+    enum class Request
+    {
+        LongPoll,
+        Fetch,
+    };
+
+    // Every namespace starts confirmed as of now, the namespaces cannot change afterwards.
+    explicit ClientMetricsRecorder(const std::vector<NamespaceType>& namespaces);
+
+    void recordLatency(Request request, std::chrono::microseconds latency);
+    void recordPropagation(std::chrono::microseconds delay);
+
+    // Counts a request that failed with ec, requests aborted by cancellation are not counted.
+    void recordFailure(Request request, const boost::system::error_code& ec);
+    // Counts a request answered with an unexpected HTTP status.
+    void recordHttpError(Request request);
+
+    // The server confirmed the release of s_namespace is current.
+    void confirm(const NamespaceType& s_namespace);
+
+    // Fills the histograms, failures and staleness of metrics.
+    void load(ClientMetrics& metrics) const;
+
+private:
+    ClientMetricsRecorder(const ClientMetricsRecorder&) = delete;             // Disable copy constructor
+    ClientMetricsRecorder& operator=(const ClientMetricsRecorder&) = delete;  // Disable assignment operator
+
+    struct Failures
+    {
+        std::atomic<std::uint64_t> timeouts_{0};
+        std::atomic<std::uint64_t> network_errors_{0};
+        std::atomic<std::uint64_t> http_errors_{0};
+        std::atomic<std::uint64_t> parse_errors_{0};
+
+        FailureMetrics load() const;
+    };
+
+    Failures& failures(Request request);
+
+    AtomicHistogram long_poll_latency_{AtomicHistogram::latencyBounds()};
+    AtomicHistogram fetch_latency_{AtomicHistogram::latencyBounds()};
+    AtomicHistogram propagation_delay_{AtomicHistogram::latencyBounds()};
+    Failures long_poll_failures_;
+    Failures fetch_failures_;
+    std::map<NamespaceType, std::atomic<std::int64_t>> confirmed_at_;  // steady_clock ticks, keys never change
+};
+
+}  // namespace client
+}  // namespace apollo
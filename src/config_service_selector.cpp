@@ -0,0 +1,194 @@
+#include "config_service_selector.h"
+#include <algorithm>
+#include <boost/url.hpp>
+#include "apollo_utility.h"
+#include "nlohmann/json.hpp"
+
+namespace apollo
+{
+namespace client
+{
+namespace
+{
+constexpr double latency_weight = 0.3;  // Of the last sample in the averages
+constexpr double failure_weight = 0.3;
+// Latency added per unit of failure rate: an instance failing 10% of its requests ranks as 1 second slower.
+constexpr double failure_penalty_us = 10e6;
+
+double average(double current, double sample, double weight)
+{
+    return current + weight * (sample - current);
+}
+
+bool hasBase(const std::string& url, const std::string& base)
+{
+    return url.size() >= base.size() && url.compare(0, base.size(), base) == 0 &&
+           (url.size() == base.size() || url[base.size()] == '/' || url[base.size()] == '?');
+}
+}  // namespace
+
+ConfigServiceSelector::ConfigServiceSelector(const std::string& fallback_url)
+    : fallback_url_(fallback_url)
+{
+}
+
+void ConfigServiceSelector::update(const std::vector<std::string>& urls)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    std::vector<Instance> instances;
+    for (const auto& url : urls)
+    {
+        auto it = std::find_if(
+            instances_.begin(), instances_.end(), [&url](const Instance& instance) { return instance.url_ == url; });
+        if (it != instances_.end())
+        {
+            instances.push_back(*it);
+        }
+        else
+        {
+            Instance instance;
+            instance.url_ = url;
+            instances.push_back(std::move(instance));
+        }
+    }
+    instances_ = std::move(instances);
+}
+
+std::string ConfigServiceSelector::route(const std::string& url) const
+{
+    auto u = boost::urls::parse_uri(url);
+    if (u.has_error())
+    {
+        return url;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    const Instance* instance = selected();
+    const std::string& base = instance ? instance->url_ : fallback_url_;
+    auto target = u->encoded_target();
+    std::string routed;
+    routed.reserve(base.size() + target.size());
+    routed += base;
+    routed.append(target.data(), target.size());
+    return routed;
+}
+
+void ConfigServiceSelector::record(const std::string& url, bool failed, std::chrono::microseconds latency)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (auto& instance : instances_)
+    {
+        if (!hasBase(url, instance.url_))
+        {
+            continue;
+        }
+
+        ++instance.requests_;
+        instance.failure_rate_ = average(instance.failure_rate_, failed ? 1.0 : 0.0, failure_weight);
+        if (failed)
+        {
+            ++instance.failures_;
+        }
+        else if (latency.count() >= 0)
+        {
+            auto sample = static_cast<double>(latency.count());
+            instance.latency_us_ = instance.measured_ ? average(instance.latency_us_, sample, latency_weight) : sample;
+            instance.measured_ = true;
+        }
+        return;
+    }
+}
+
+void ConfigServiceSelector::decay()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (auto& instance : instances_)
+    {
+        instance.failure_rate_ /= 2;
+    }
+}
+
+std::vector<ConfigServiceMetrics> ConfigServiceSelector::metrics() const
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    const Instance* current = selected();
+    std::vector<ConfigServiceMetrics> metrics;
+    for (const auto& instance : instances_)
+    {
+        ConfigServiceMetrics m;
+        m.url_ = instance.url_;
+        m.latency_ = std::chrono::microseconds(static_cast<std::int64_t>(instance.latency_us_));
+        m.failure_rate_ = instance.failure_rate_;
+        m.requests_ = instance.requests_;
+        m.failures_ = instance.failures_;
+        m.selected_ = &instance == current;
+        metrics.push_back(std::move(m));
+    }
+    return metrics;
+}
+
+const ConfigServiceSelector::Instance* ConfigServiceSelector::selected() const
+{
+    const Instance* best = nullptr;
+    for (const auto& instance : instances_)
+    {
+        if (!best || score(instance) < score(*best))
+        {
+            best = &instance;
+        }
+    }
+    return best;
+}
+
+double ConfigServiceSelector::score(const Instance& instance)
+{
+    return instance.latency_us_ + instance.failure_rate_ * failure_penalty_us;
+}
+
+bool parseConfigServices(const std::string& body, std::vector<std::string>& urls)
+{
+    // [{"appName":"APOLLO-CONFIGSERVICE","instanceId":"...","homepageUrl":"http://10.0.0.1:8080/"}, ...]
+    auto j = nlohmann::json::parse(body, nullptr, false);
+    if (!j.is_array())
+    {
+        return false;
+    }
+
+    urls.clear();
+    for (const auto& service : j)
+    {
+        if (!service.is_object())
+        {
+            return false;
+        }
+
+        auto homepage = service.find("homepageUrl");
+        if (homepage == service.end() || !homepage->is_string())
+        {
+            continue;
+        }
+
+        // Requests append their path to the url, with its trailing '/' removed.
+        auto url = homepage->get<std::string>();
+        while (!url.empty() && url.back() == '/')
+        {
+            url.pop_back();
+        }
+        if (isValidUrl(url))
+        {
+            urls.push_back(std::move(url));
+        }
+    }
+    return true;
+}
+
+std::string createConfigServicesURL(const std::string& meta_server_url, const std::string& app_id)
+{
+    boost::urls::url u(meta_server_url);
+    u.set_path("/services/config");
+    u.params().append({"appId", boost::urls::encode(app_id, boost::urls::unreserved_chars)});
+    return u.buffer();
+}
+
+}  // namespace client
+}  // namespace apollo
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "apollo/apollo_types.h"
+
+namespace apollo
+{
+namespace client
+{
+/**
+ * The config service instances of a client, as listed by the /services/config of the meta server, and the
+ * one its requests are routed to.
+ *
+ * Every instance keeps an exponentially weighted moving average of its response latency and of its failure
+ * rate. Requests go to the instance of the lowest latency once penalized by its failure rate, so a failing
+ * instance is left for the next one at once, and retried once its failure rate decayed. An instance never
+ * measured yet is preferred, so every instance gets measured. Without instance the requests go to the
+ * fallback url. Thread-safe.
+ */
+class ConfigServiceSelector
+{
+public:
+    explicit ConfigServiceSelector(const std::string& fallback_url);
+
+    // Replaces the instances with urls, the instances listed again keep their measurements.
+    void update(const std::vector<std::string>& urls);
+
+    // url, built against any base url, with the base url of the selected instance.
+    std::string route(const std::string& url) const;
+
+    // Outcome of a request routed to url by route(), the latency of a successful request is sampled
+    // unless it is negative, e.g. of a long poll held by the server.
+    void record(const std::string& url, bool failed, std::chrono::microseconds latency = std::chrono::microseconds(-1));
+
+    // Halves the failure rates, called at every discovery so that failed instances are eventually retried.
+    void decay();
+
+    std::vector<ConfigServiceMetrics> metrics() const;
+
+private:
+    struct Instance
+    {
+        std::string url_;
+        double latency_us_ = 0;  // EWMA of the successful requests
+        double failure_rate_ = 0;
+        bool measured_ = false;  // Whether latency_us_ holds a sample
+        std::uint64_t requests_ = 0;
+        std::uint64_t failures_ = 0;
+    };
+
+    const Instance* selected() const;  // mutex_, nullptr without instance
+    static double score(const Instance& instance);
+
+    std::string fallback_url_;
+    mutable std::mutex mutex_;
+    std::vector<Instance> instances_;  // mutex_
+};
+
+// Base urls of the config services listed by a /services/config response, false if body is invalid.
+bool parseConfigServices(const std::string& body, std::vector<std::string>& urls);
+
+// The /services/config url of the meta server, listing the config services of app_id.
+std::string createConfigServicesURL(const std::string& meta_server_url, const std::string& app_id);
+
+}  // namespace client
+}  // namespace apollo
@@ -0,0 +1,71 @@
+#include "configures_index.h"
+#include <functional>
+
+namespace apollo
+{
+namespace client
+{
+constexpr std::size_t ConfiguresIndex::npos;
+
+ConfiguresIndex::ConfiguresIndex(const Configures& configures)
+    : size_(configures.size())
+{
+    if (configures.empty())
+    {
+        return;
+    }
+
+    // Keep the load factor at or below 0.5 so probe sequences stay short.
+    std::size_t capacity = 2;
+    while (capacity < configures.size() * 2)
+    {
+        capacity <<= 1;
+    }
+    slots_.resize(capacity);
+    mask_ = capacity - 1;
+
+    std::hash<std::string> hasher;
+    for (const auto& entry : configures)
+    {
+        std::size_t hash = hasher(entry.first);
+        std::size_t i = hash & mask_;
+        while (slots_[i].entry_ != nullptr)
+        {
+            i = (i + 1) & mask_;
+        }
+        slots_[i].hash_ = hash;
+        slots_[i].entry_ = &entry;
+    }
+}
+
+const std::string* ConfiguresIndex::find(const std::string& key) const
+{
+    std::size_t slot = findSlot(key);
+    return slot == npos ? nullptr : &slotValue(slot);
+}
+
+std::size_t ConfiguresIndex::findSlot(const std::string& key) const
+{
+    if (slots_.empty())
+    {
+        return npos;
+    }
+
+    std::size_t hash = std::hash<std::string>()(key);
+    for (std::size_t i = hash & mask_;; i = (i + 1) & mask_)
+    {
+        const Slot& slot = slots_[i];
+        if (slot.entry_ == nullptr)
+        {
+            return npos;
+        }
+
+        if (slot.hash_ == hash && slot.entry_->first == key)
+        {
+            return i;
+        }
+    }
+}
+
+}  // namespace client
+}  // namespace apollo
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "apollo/apollo_types.h"
+
+namespace apollo
+{
+namespace client
+{
+/**
+ * Open addressing hash index over the entries of an immutable Configures.
+ * The index stores pointers into the indexed map, it must not outlive it and the map must not be modified.
+ */
+class ConfiguresIndex
+{
+public:
+    ConfiguresIndex() = default;
+    explicit ConfiguresIndex(const Configures& configures);
+    ~ConfiguresIndex() = default;
+
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    // Returns the value of the key, or nullptr if the key is not in the indexed configures.
+    const std::string* find(const std::string& key) const;
+
+    // Returns the slot of the key, below slotCount(), or npos if the key is not in the indexed configures.
+    std::size_t findSlot(const std::string& key) const;
+
+    inline const std::string& slotValue(std::size_t slot) const
+    {
+        return slots_[slot].entry_->second;
+    }
+
+    inline std::size_t slotCount() const
+    {
+        return slots_.size();
+    }
+
+    inline std::size_t size() const
+    {
+        return size_;
+    }
+
+private:
+    struct Slot
+    {
+        std::size_t hash_ = 0;
+        const Configures::value_type* entry_ = nullptr;  // nullptr marks an empty slot
+    };
+
+    std::vector<Slot> slots_;
+    std::size_t mask_ = 0;
+    std::size_t size_ = 0;
+};
+
+}  // namespace client
+}  // namespace apollo
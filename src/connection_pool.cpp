@@ -0,0 +1,197 @@
+#include "connection_pool.h"
+#include <vector>
+#include <boost/asio/error.hpp>
+
+namespace apollo
+{
+namespace client
+{
+
+ConnectionPool::ConnectionPool(int max_connections_per_host, int idle_timeout_ms)
+    : max_connections_per_host_(max_connections_per_host > 0 ? max_connections_per_host : 0)
+    , idle_timeout_(idle_timeout_ms)
+{
+}
+
+ConnectionPool::Lease::Lease(Lease&& other) noexcept
+    : stream_(std::move(other.stream_))
+    , key_(std::move(other.key_))
+    , reused_(other.reused_)
+    , poolable_(other.poolable_)
+    , pool_(std::move(other.pool_))
+{
+    other.poolable_ = false;
+}
+
+ConnectionPool::Lease& ConnectionPool::Lease::operator=(Lease&& other) noexcept
+{
+    if (this != &other)
+    {
+        giveBack();
+        stream_ = std::move(other.stream_);
+        key_ = std::move(other.key_);
+        reused_ = other.reused_;
+        poolable_ = other.poolable_;
+        pool_ = std::move(other.pool_);
+        other.poolable_ = false;
+    }
+    return *this;
+}
+
+ConnectionPool::Lease::~Lease()
+{
+    giveBack();
+}
+
+void ConnectionPool::Lease::giveBack()
+{
+    if (!poolable_)
+    {
+        return;
+    }
+
+    auto pool = pool_.lock();
+    if (pool)
+    {
+        pool->discard(std::move(*this));
+    }
+    poolable_ = false;
+}
+
+ConnectionPool::Lease ConnectionPool::acquire(const std::string& key, bool reuse_idle)
+{
+    Lease lease;
+    lease.key_ = key;
+    lease.pool_ = shared_from_this();
+
+    std::vector<StreamPtr> stale;  // Closed outside of the lock
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        auto now = std::chrono::steady_clock::now();
+        pruneExpired(now);
+
+        Host& host = hosts_[key];
+        while (reuse_idle && !host.idle_.empty())
+        {
+            IdleConnection idle = std::move(host.idle_.back());
+            host.idle_.pop_back();
+
+            if (isHealthy(*idle.stream_))
+            {
+                lease.stream_ = std::move(idle.stream_);
+                lease.reused_ = true;
+                lease.poolable_ = true;
+                return lease;
+            }
+
+            --host.open_;
+            stale.push_back(std::move(idle.stream_));
+        }
+
+        if (host.open_ < max_connections_per_host_)
+        {
+            ++host.open_;
+            lease.poolable_ = true;
+        }
+    }
+
+    for (auto& stream : stale)
+    {
+        boost::beast::error_code ec;
+        stream->socket().close(ec);
+    }
+    return lease;
+}
+
+void ConnectionPool::release(Lease&& lease)
+{
+    if (!lease.stream_)
+    {
+        discard(std::move(lease));
+        return;
+    }
+
+    if (!lease.poolable_ || !lease.stream_->socket().is_open())
+    {
+        discard(std::move(lease));
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto now = std::chrono::steady_clock::now();
+    hosts_[lease.key_].idle_.push_back({std::move(lease.stream_), now});
+    pruneExpired(now);
+}
+
+void ConnectionPool::discard(Lease&& lease)
+{
+    if (lease.stream_)
+    {
+        boost::beast::error_code ec;
+        lease.stream_->socket().shutdown(boost::asio::ip::tcp::socket::shutdown_both, ec);
+        lease.stream_->socket().close(ec);
+        lease.stream_.reset();
+    }
+
+    if (lease.poolable_)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        --hosts_[lease.key_].open_;
+        lease.poolable_ = false;
+    }
+}
+
+void ConnectionPool::clear()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (auto& p : hosts_)
+    {
+        p.second.open_ -= static_cast<int>(p.second.idle_.size());
+        p.second.idle_.clear();
+    }
+}
+
+std::size_t ConnectionPool::idleCount(const std::string& key) const
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto it = hosts_.find(key);
+    return it == hosts_.end() ? 0 : it->second.idle_.size();
+}
+
+bool ConnectionPool::isHealthy(Stream& stream)
+{
+    auto& socket = stream.socket();
+    if (!socket.is_open())
+    {
+        return false;
+    }
+
+    // An idle keep-alive connection must have nothing to read: a readable socket means the server
+    // closed it (eof) or sent something unexpected, either way it cannot carry another request.
+    boost::beast::error_code ec;
+    char byte;
+    socket.non_blocking(true, ec);
+    socket.receive(boost::asio::buffer(&byte, 1), boost::asio::ip::tcp::socket::message_peek, ec);
+    boost::beast::error_code restore_ec;
+    socket.non_blocking(false, restore_ec);
+    return ec == boost::asio::error::would_block;
+}
+
+void ConnectionPool::pruneExpired(std::chrono::steady_clock::time_point now)
+{
+    for (auto& p : hosts_)
+    {
+        auto& idle = p.second.idle_;
+        // The least recently used connections are at the front.
+        while (!idle.empty() && now - idle.front().idle_since_ >= idle_timeout_)
+        {
+            boost::beast::error_code ec;
+            idle.front().stream_->socket().close(ec);
+            idle.pop_front();
+            --p.second.open_;
+        }
+    }
+}
+
+}  // namespace client
+}  // namespace apollo
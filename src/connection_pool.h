@@ -0,0 +1,101 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <boost/beast/core/tcp_stream.hpp>
+
+namespace apollo
+{
+namespace client
+{
+/**
+ * HTTP/1.1 keep-alive connection pool, keyed by "host:port".
+ *
+ * At most max_connections_per_host connections per host are owned by the pool (idle or leased),
+ * requests beyond that use one-shot connections. Idle connections are dropped after idle_timeout_ms,
+ * and are checked for a close or unexpected data from the server before being handed out again.
+ * Thread-safe, shared by the synchronous and asynchronous request paths.
+ */
+class ConnectionPool : public std::enable_shared_from_this<ConnectionPool>
+{
+public:
+    using Stream = boost::beast::tcp_stream;
+    using StreamPtr = std::unique_ptr<Stream>;
+
+    // A connection taken from the pool, or a new one the pool may adopt once the request is done.
+    // A lease destroyed without release() or discard() gives its slot back to the pool.
+    struct Lease
+    {
+        Lease() = default;
+        Lease(Lease&& other) noexcept;
+        Lease& operator=(Lease&& other) noexcept;
+        ~Lease();
+
+        StreamPtr stream_;
+        std::string key_;
+        bool reused_ = false;    // The connection already served requests, it may have been closed by the server
+        bool poolable_ = false;  // The connection counts against the per host limit and may go back to the pool
+        std::weak_ptr<ConnectionPool> pool_;
+
+    private:
+        void giveBack();
+    };
+
+    // Must be owned by a std::shared_ptr, see ConnectionPoolPtr.
+    ConnectionPool(int max_connections_per_host = 4, int idle_timeout_ms = 15000);
+    ~ConnectionPool() = default;
+
+    // Returns a lease holding a healthy idle connection, or a lease without stream if none is available
+    // or reuse_idle is false.
+    Lease acquire(const std::string& key, bool reuse_idle = true);
+
+    // Hands a connection back after a complete keep-alive exchange.
+    void release(Lease&& lease);
+
+    // Forgets a leased connection that failed or was closed.
+    void discard(Lease&& lease);
+
+    // Closes all idle connections.
+    void clear();
+
+    std::size_t idleCount(const std::string& key) const;
+
+    inline int maxConnectionsPerHost() const
+    {
+        return max_connections_per_host_;
+    }
+
+private:
+    ConnectionPool(const ConnectionPool&) = delete;             // Disable copy constructor
+    ConnectionPool& operator=(const ConnectionPool&) = delete;  // Disable assignment operator
+
+    struct IdleConnection
+    {
+        StreamPtr stream_;
+        std::chrono::steady_clock::time_point idle_since_;
+    };
+
+    struct Host
+    {
+        std::deque<IdleConnection> idle_;  // Most recently used at the back
+        int open_ = 0;                     // Idle and leased connections owned by the pool
+    };
+
+    static bool isHealthy(Stream& stream);
+    void pruneExpired(std::chrono::steady_clock::time_point now);
+
+    const int max_connections_per_host_;
+    const std::chrono::milliseconds idle_timeout_;
+    mutable std::mutex mutex_;
+    std::map<std::string, Host> hosts_;
+};
+
+using ConnectionPoolPtr = std::shared_ptr<ConnectionPool>;
+
+}  // namespace client
+}  // namespace apollo
@@ -0,0 +1,279 @@
+#include "content_decoder.h"
+#include <algorithm>
+#include <boost/algorithm/string/trim.hpp>
+#include <boost/beast/core/string.hpp>
+#include <boost/beast/zlib/error.hpp>
+
+namespace apollo
+{
+namespace client
+{
+namespace
+{
+namespace zlib = boost::beast::zlib;
+
+constexpr std::size_t gzip_trailer_size = 8;  // CRC32 and ISIZE, little endian
+constexpr std::size_t zlib_trailer_size = 4;  // Adler-32, big endian
+constexpr std::size_t inflate_chunk_size = 16384;
+
+constexpr unsigned char gzip_fhcrc = 0x02;
+constexpr unsigned char gzip_fextra = 0x04;
+constexpr unsigned char gzip_fname = 0x08;
+constexpr unsigned char gzip_fcomment = 0x10;
+constexpr unsigned char gzip_reserved = 0xE0;
+
+inline unsigned char byteAt(const std::string& s, std::size_t i)
+{
+    return static_cast<unsigned char>(s[i]);
+}
+
+std::uint32_t littleEndian32(const std::string& s, std::size_t i)
+{
+    return static_cast<std::uint32_t>(byteAt(s, i)) | (static_cast<std::uint32_t>(byteAt(s, i + 1)) << 8) |
+           (static_cast<std::uint32_t>(byteAt(s, i + 2)) << 16) | (static_cast<std::uint32_t>(byteAt(s, i + 3)) << 24);
+}
+
+std::uint32_t bigEndian32(const std::string& s, std::size_t i)
+{
+    return (static_cast<std::uint32_t>(byteAt(s, i)) << 24) | (static_cast<std::uint32_t>(byteAt(s, i + 1)) << 16) |
+           (static_cast<std::uint32_t>(byteAt(s, i + 2)) << 8) | static_cast<std::uint32_t>(byteAt(s, i + 3));
+}
+}  // namespace
+
+bool ContentDecoder::reset(boost::string_view content_encoding)
+{
+    std::string coding(content_encoding.data(), content_encoding.size());
+    boost::algorithm::trim(coding);
+    if (coding.empty() || boost::beast::iequals(coding, "identity"))
+    {
+        coding_ = Coding::Identity;
+    }
+    else if (boost::beast::iequals(coding, "gzip") || boost::beast::iequals(coding, "x-gzip"))
+    {
+        coding_ = Coding::Gzip;
+    }
+    else if (boost::beast::iequals(coding, "deflate"))
+    {
+        coding_ = Coding::Deflate;
+    }
+    else
+    {
+        return false;
+    }
+
+    state_ = State::Header;
+    zlib_wrapped_ = false;
+    pending_.clear();
+    inflate_.reset();
+    crc_.reset();
+    adler_a_ = 1;
+    adler_b_ = 0;
+    decoded_size_ = 0;
+    return true;
+}
+
+bool ContentDecoder::identity() const
+{
+    return coding_ == Coding::Identity;
+}
+
+bool ContentDecoder::write(const char* data, std::size_t size, std::string& out)
+{
+    switch (state_)
+    {
+        case State::Header:
+        {
+            if (coding_ == Coding::Identity)
+            {
+                out.append(data, size);
+                return true;
+            }
+
+            pending_.append(data, size);
+            std::size_t header_size = 0;
+            if (!parseHeader(header_size))
+            {
+                return state_ != State::Failed;
+            }
+
+            std::string data_part = pending_.substr(header_size);
+            pending_.clear();
+            state_ = State::Data;
+            return inflate(data_part.data(), data_part.size(), out);
+        }
+
+        case State::Data:
+            return inflate(data, size, out);
+
+        case State::Trailer:
+        case State::Done:
+            pending_.append(data, size);
+            return checkTrailer();
+
+        case State::Failed:
+            return false;
+    }
+    return false;
+}
+
+bool ContentDecoder::finish()
+{
+    return coding_ == Coding::Identity || state_ == State::Done;
+}
+
+bool ContentDecoder::parseHeader(std::size_t& header_size)
+{
+    if (coding_ == Coding::Deflate)
+    {
+        if (pending_.size() < 2)
+        {
+            return false;
+        }
+
+        // A zlib header is a multiple of 31, with the deflate method, a valid window size and no preset dictionary.
+        unsigned cmf = byteAt(pending_, 0);
+        unsigned flg = byteAt(pending_, 1);
+        zlib_wrapped_ = (cmf & 0x0F) == 8 && (cmf >> 4) <= 7 && ((cmf << 8) | flg) % 31 == 0 && (flg & 0x20) == 0;
+        header_size = zlib_wrapped_ ? 2 : 0;
+        return true;
+    }
+
+    if (pending_.size() < 10)
+    {
+        return false;
+    }
+
+    unsigned char flags = byteAt(pending_, 3);
+    if (byteAt(pending_, 0) != 0x1F || byteAt(pending_, 1) != 0x8B || byteAt(pending_, 2) != 8 ||
+        (flags & gzip_reserved) != 0)
+    {
+        state_ = State::Failed;
+        return false;
+    }
+
+    std::size_t pos = 10;
+    if (flags & gzip_fextra)
+    {
+        if (pending_.size() < pos + 2)
+        {
+            return false;
+        }
+        pos += 2 + (byteAt(pending_, pos) | (byteAt(pending_, pos + 1) << 8));
+    }
+
+    for (auto flag : {gzip_fname, gzip_fcomment})
+    {
+        if ((flags & flag) && pos <= pending_.size())
+        {
+            auto end = pending_.find('\0', pos);
+            if (end == std::string::npos)
+            {
+                return false;
+            }
+            pos = end + 1;
+        }
+    }
+
+    if (flags & gzip_fhcrc)
+    {
+        pos += 2;
+    }
+
+    if (pos > pending_.size())
+    {
+        return false;
+    }
+    header_size = pos;
+    return true;
+}
+
+bool ContentDecoder::inflate(const char* data, std::size_t size, std::string& out)
+{
+    zlib::z_params zs;
+    zs.next_in = data;
+    zs.avail_in = size;
+
+    while (true)
+    {
+        std::size_t out_size = out.size();
+        std::size_t chunk_size = std::max(inflate_chunk_size, zs.avail_in * 4);
+        out.resize(out_size + chunk_size);
+        zs.next_out = &out[out_size];
+        zs.avail_out = chunk_size;
+        std::size_t avail_in = zs.avail_in;
+
+        boost::system::error_code ec;
+        inflate_.write(zs, zlib::Flush::none, ec);
+
+        std::size_t produced = chunk_size - zs.avail_out;
+        out.resize(out_size + produced);
+        if (zlib_wrapped_)
+        {
+            // Adler-32 (RFC 1950), reduced before the sums can overflow.
+            const unsigned char* p = reinterpret_cast<const unsigned char*>(out.data() + out_size);
+            for (std::size_t i = 0; i < produced; ++i)
+            {
+                adler_a_ += p[i];
+                adler_b_ += adler_a_;
+                if ((i & 0xFFF) == 0xFFF)
+                {
+                    adler_a_ %= 65521;
+                    adler_b_ %= 65521;
+                }
+            }
+            adler_a_ %= 65521;
+            adler_b_ %= 65521;
+        }
+        else if (coding_ == Coding::Gzip)
+        {
+            crc_.process_bytes(out.data() + out_size, produced);
+        }
+        decoded_size_ += produced;
+
+        if (ec == zlib::error::end_of_stream)
+        {
+            state_ = State::Trailer;
+            pending_.assign(static_cast<const char*>(zs.next_in), zs.avail_in);
+            return checkTrailer();
+        }
+
+        if (ec && ec != zlib::error::need_buffers)
+        {
+            state_ = State::Failed;
+            return false;
+        }
+
+        // Stop once the input is consumed and the output was not cut short, or nothing moves anymore.
+        if ((zs.avail_in == 0 && zs.avail_out != 0) || (produced == 0 && zs.avail_in == avail_in))
+        {
+            return true;
+        }
+    }
+}
+
+bool ContentDecoder::checkTrailer()
+{
+    std::size_t trailer_size =
+        coding_ == Coding::Gzip ? gzip_trailer_size : (zlib_wrapped_ ? zlib_trailer_size : 0);
+    if (pending_.size() < trailer_size)
+    {
+        return true;
+    }
+
+    bool valid = pending_.size() == trailer_size;  // Nothing may follow the trailer
+    if (valid && coding_ == Coding::Gzip)
+    {
+        valid = littleEndian32(pending_, 0) == crc_.checksum() &&
+                littleEndian32(pending_, 4) == static_cast<std::uint32_t>(decoded_size_);
+    }
+    else if (valid && zlib_wrapped_)
+    {
+        valid = bigEndian32(pending_, 0) == ((adler_b_ << 16) | adler_a_);
+    }
+
+    state_ = valid ? State::Done : State::Failed;
+    return valid;
+}
+
+}  // namespace client
+}  // namespace apollo
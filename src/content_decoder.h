@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <boost/beast/zlib/inflate_stream.hpp>
+#include <boost/crc.hpp>
+#include <boost/utility/string_view.hpp>
+
+namespace apollo
+{
+namespace client
+{
+/**
+ * Incremental decoder of a Content-Encoding: gzip (RFC 1952) or deflate, either zlib wrapped (RFC 1950)
+ * as the standard requires or raw as some servers send it. The body may be split anywhere between writes.
+ */
+class ContentDecoder
+{
+public:
+    // Prepares to decode a body with the given Content-Encoding, false if the coding is not supported.
+    // Empty and "identity" codings are passed through unchanged.
+    bool reset(boost::string_view content_encoding);
+
+    // Whether the body is passed through unchanged.
+    bool identity() const;
+
+    // Decodes the next part of the body and appends the output to out, false if the body is corrupt.
+    bool write(const char* data, std::size_t size, std::string& out);
+
+    // Whether the whole body was decoded and its checksum matched.
+    bool finish();
+
+private:
+    enum class Coding
+    {
+        Identity,
+        Gzip,
+        Deflate,
+    };
+
+    enum class State
+    {
+        Header,
+        Data,
+        Trailer,
+        Done,
+        Failed,
+    };
+
+    // Measures the gzip or zlib header buffered in pending_, false while it is incomplete or if it is invalid.
+    bool parseHeader(std::size_t& header_size);
+    bool inflate(const char* data, std::size_t size, std::string& out);
+    bool checkTrailer();
+
+    Coding coding_ = Coding::Identity;
+    State state_ = State::Header;
+    bool zlib_wrapped_ = false;
+    std::string pending_;  // Header or trailer bytes received so far
+    boost::beast::zlib::inflate_stream inflate_;
+    boost::crc_32_type crc_;
+    std::uint32_t adler_a_ = 1;
+    std::uint32_t adler_b_ = 0;
+    std::uint64_t decoded_size_ = 0;
+};
+
+}  // namespace client
+}  // namespace apollo
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <boost/asio/buffer.hpp>
+#include <boost/beast/http.hpp>
+#include <boost/optional.hpp>
+#include <boost/system/error_code.hpp>
+#include "content_decoder.h"
+
+namespace apollo
+{
+namespace client
+{
+/**
+ * Beast body that undoes the Content-Encoding of a response while it is read and streams the decoded bytes
+ * to the reader of Body, so e.g. a compressed JsonBody is still parsed as it arrives.
+ *
+ * The value records the size of the body as received and once decoded, and the time the reader of Body
+ * took to process it. An unsupported coding fails the read with errc::not_supported, a corrupt one with
+ * errc::bad_message.
+ */
+template <class Body>
+struct DecodedBody
+{
+    struct value_type
+    {
+        typename Body::value_type body_;
+        bool decoded_ = false;  // Whether a Content-Encoding was removed
+        std::uint64_t wire_size_ = 0;
+        std::uint64_t decoded_size_ = 0;
+        std::chrono::nanoseconds parse_time_{0};  // Spent in the reader of Body, e.g. parsing JSON
+    };
+
+    class reader
+    {
+    public:
+        template <bool isRequest, class Fields>
+        reader(boost::beast::http::header<isRequest, Fields>& h, value_type& value)
+            : value_(value)
+            , inner_(h, value.body_)
+            , content_encoding_([&h]() { return h[boost::beast::http::field::content_encoding]; })
+        {
+        }
+
+        void init(const boost::optional<std::uint64_t>& content_length, boost::system::error_code& ec)
+        {
+            // The reader is built along with the parser, the header is only known once the body starts.
+            if (!decoder_.reset(content_encoding_()))
+            {
+                ec = boost::system::errc::make_error_code(boost::system::errc::not_supported);
+                return;
+            }
+
+            value_.decoded_ = !decoder_.identity();
+            inner_.init(value_.decoded_ ? boost::none : content_length, ec);
+        }
+
+        template <class ConstBufferSequence>
+        std::size_t put(const ConstBufferSequence& buffers, boost::system::error_code& ec)
+        {
+            if (decoder_.identity())
+            {
+                auto bytes = timed([&]() { return inner_.put(buffers, ec); });
+                value_.wire_size_ += bytes;
+                value_.decoded_size_ += bytes;
+                return bytes;
+            }
+
+            std::size_t bytes = 0;
+            decoded_.clear();
+            for (auto it = boost::asio::buffer_sequence_begin(buffers); it != boost::asio::buffer_sequence_end(buffers);
+                 ++it)
+            {
+                boost::asio::const_buffer buffer = *it;
+                if (!decoder_.write(static_cast<const char*>(buffer.data()), buffer.size(), decoded_))
+                {
+                    ec = boost::system::errc::make_error_code(boost::system::errc::bad_message);
+                    return bytes;
+                }
+                bytes += buffer.size();
+            }
+            value_.wire_size_ += bytes;
+            value_.decoded_size_ += decoded_.size();
+
+            ec = {};
+            if (!decoded_.empty())
+            {
+                timed([&]() { return inner_.put(boost::asio::buffer(decoded_), ec); });
+            }
+            return bytes;
+        }
+
+        void finish(boost::system::error_code& ec)
+        {
+            if (!decoder_.finish())
+            {
+                ec = boost::system::errc::make_error_code(boost::system::errc::bad_message);
+                return;
+            }
+            timed(
+                [&]()
+                {
+                    inner_.finish(ec);
+                    return 0;
+                });
+        }
+
+    private:
+        template <class F>
+        auto timed(F&& f) -> decltype(f())
+        {
+            auto start = std::chrono::steady_clock::now();
+            auto result = f();
+            value_.parse_time_ += std::chrono::steady_clock::now() - start;
+            return result;
+        }
+
+        value_type& value_;
+        typename Body::reader inner_;
+        std::function<boost::beast::string_view()> content_encoding_;
+        ContentDecoder decoder_;
+        std::string decoded_;  // Output of the current put, reused
+    };
+};
+
+}  // namespace client
+}  // namespace apollo
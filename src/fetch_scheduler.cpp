@@ -0,0 +1,80 @@
+#include "fetch_scheduler.h"
+#include <algorithm>
+#include "json_body.h"
+
+namespace apollo
+{
+namespace client
+{
+
+template <class ResponseBody>
+FetchScheduler<ResponseBody>::FetchScheduler(HttpClient& http_client,
+                                             std::vector<std::string>&& urls,
+                                             std::size_t max_concurrency,
+                                             ResultHandler on_result,
+                                             DoneHandler on_done)
+    : http_client_(http_client)
+    , urls_(std::move(urls))
+    , max_concurrency_(std::max<std::size_t>(max_concurrency, 1))
+    , on_result_(std::move(on_result))
+    , on_done_(std::move(on_done))
+{
+}
+
+template <class ResponseBody>
+void FetchScheduler<ResponseBody>::start()
+{
+    launchNext();
+}
+
+template <class ResponseBody>
+void FetchScheduler<ResponseBody>::cancel()
+{
+    cancelled_ = true;
+}
+
+template <class ResponseBody>
+void FetchScheduler<ResponseBody>::launchNext()
+{
+    while (!cancelled_ && next_ < urls_.size() && in_flight_ < max_concurrency_)
+    {
+        std::size_t index = next_++;
+        ++in_flight_;
+        http_client_.getAsync<ResponseBody>(
+            urls_[index],
+            [shared_this = this->shared_from_this(), index, started = std::chrono::steady_clock::now()](
+                beast::error_code ec, http::response<ResponseBody> res)
+            { shared_this->onResult(index, ec, std::move(res), started); });
+    }
+
+    if (in_flight_ == 0 && !done_ && (cancelled_ || next_ == urls_.size()))
+    {
+        done_ = true;
+        if (on_done_)
+        {
+            on_done_();
+        }
+    }
+}
+
+template <class ResponseBody>
+void FetchScheduler<ResponseBody>::onResult(std::size_t index,
+                                            beast::error_code ec,
+                                            http::response<ResponseBody>&& res,
+                                            std::chrono::steady_clock::time_point started)
+{
+    --in_flight_;
+    if (on_result_)
+    {
+        auto elapsed =
+            std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - started);
+        on_result_(index, ec, std::move(res), elapsed);
+    }
+    launchNext();
+}
+
+template class FetchScheduler<http::string_body>;
+template class FetchScheduler<ConfigsBody>;
+
+}  // namespace client
+}  // namespace apollo
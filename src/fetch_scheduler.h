@@ -0,0 +1,70 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "http_client.h"
+
+namespace apollo
+{
+namespace client
+{
+/**
+ * Issues a list of asynchronous GET requests on an HttpClient, at most max_concurrency at a time.
+ * Handlers run on the HttpClient's io_context; the scheduler keeps itself alive until every request completed.
+ * Responses are read into ResponseBody, instantiated for http::string_body and ConfigsBody.
+ */
+template <class ResponseBody>
+class FetchScheduler : public std::enable_shared_from_this<FetchScheduler<ResponseBody>>
+{
+public:
+    // Called once per url with its position in the url list and the time its request took.
+    using ResultHandler = std::function<void(std::size_t index,
+                                             beast::error_code ec,
+                                             http::response<ResponseBody>&& res,
+                                             std::chrono::microseconds elapsed)>;
+    using DoneHandler = std::function<void()>;
+
+    FetchScheduler(HttpClient& http_client,
+                   std::vector<std::string>&& urls,
+                   std::size_t max_concurrency,
+                   ResultHandler on_result,
+                   DoneHandler on_done);
+    ~FetchScheduler() = default;
+
+    void start();
+
+    // Requests not started yet are skipped, requests in flight still report their result.
+    void cancel();
+
+    const std::string& url(std::size_t index) const
+    {
+        return urls_[index];
+    }
+
+private:
+    FetchScheduler(const FetchScheduler&) = delete;             // Disable copy constructor
+    FetchScheduler& operator=(const FetchScheduler&) = delete;  // Disable assignment operator
+
+    void launchNext();
+    void onResult(std::size_t index,
+                  beast::error_code ec,
+                  http::response<ResponseBody>&& res,
+                  std::chrono::steady_clock::time_point started);
+
+    HttpClient& http_client_;
+    std::vector<std::string> urls_;
+    std::size_t max_concurrency_;
+    std::size_t next_ = 0;
+    std::size_t in_flight_ = 0;
+    bool cancelled_ = false;
+    bool done_ = false;
+    ResultHandler on_result_;
+    DoneHandler on_done_;
+};
+
+}  // namespace client
+}  // namespace apollo
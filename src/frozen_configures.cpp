@@ -0,0 +1,128 @@
+#include "frozen_configures.h"
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+namespace apollo
+{
+namespace client
+{
+
+FrozenConfigures::FrozenConfigures(const Configures& configures)
+{
+    std::size_t arena_bytes = 0;
+    for (const auto& p : configures)
+    {
+        arena_bytes += p.first.size() + p.second.size();
+    }
+
+    // Configures is already sorted by key, entries can be appended in order.
+    FrozenConfiguresBuilder builder;
+    builder.reserve(configures.size(), arena_bytes);
+    for (const auto& p : configures)
+    {
+        builder.add(p.first, p.second);
+    }
+    *this = builder.build();
+}
+
+std::size_t FrozenConfigures::find(StringView k) const
+{
+    auto it = std::lower_bound(entries_.begin(),
+                               entries_.end(),
+                               k,
+                               [this](const Entry& e, StringView target)
+                               { return StringView(arena_.data() + e.key_offset_, e.key_size_) < target; });
+
+    if (it == entries_.end() || key(it - entries_.begin()) != k)
+    {
+        return entries_.size();
+    }
+    return it - entries_.begin();
+}
+
+Configures FrozenConfigures::thaw() const
+{
+    Configures configures;
+    for (std::size_t i = 0; i < entries_.size(); ++i)
+    {
+        // Entries are sorted, hinting at end() makes every insertion O(1).
+        configures.emplace_hint(configures.end(), key(i).to_string(), value(i).to_string());
+    }
+    return configures;
+}
+
+std::size_t FrozenConfigures::memoryUsage() const
+{
+    return arena_.capacity() + entries_.capacity() * sizeof(Entry);
+}
+
+void FrozenConfiguresBuilder::reserve(std::size_t entries, std::size_t arena_bytes)
+{
+    frozen_.entries_.reserve(entries);
+    frozen_.arena_.reserve(arena_bytes);
+}
+
+void FrozenConfiguresBuilder::add(StringView key, StringView value)
+{
+    FrozenConfigures::Entry entry;
+    entry.key_size_ = static_cast<std::uint32_t>(key.size());
+    entry.key_offset_ = append(key);
+    entry.value_size_ = static_cast<std::uint32_t>(value.size());
+    entry.value_offset_ = append(value);
+    frozen_.entries_.push_back(entry);
+}
+
+std::uint32_t FrozenConfiguresBuilder::append(StringView s)
+{
+    std::string& arena = frozen_.arena_;
+    if (arena.size() + s.size() > std::numeric_limits<std::uint32_t>::max())
+    {
+        throw std::length_error("apollo client frozen configures arena exceeds 4GB");
+    }
+
+    auto offset = static_cast<std::uint32_t>(arena.size());
+    arena.append(s.data(), s.size());
+    return offset;
+}
+
+FrozenConfigures FrozenConfiguresBuilder::build()
+{
+    auto& entries = frozen_.entries_;
+    const std::string& arena = frozen_.arena_;
+    auto key_of = [&arena](const FrozenConfigures::Entry& e)
+    { return StringView(arena.data() + e.key_offset_, e.key_size_); };
+
+    bool sorted = true;
+    for (std::size_t i = 1; i < entries.size() && sorted; ++i)
+    {
+        sorted = key_of(entries[i - 1]) < key_of(entries[i]);
+    }
+
+    if (!sorted)
+    {
+        // Stable sort keeps repeated keys in insertion order, the last one of each run is kept.
+        std::stable_sort(entries.begin(),
+                         entries.end(),
+                         [&key_of](const FrozenConfigures::Entry& a, const FrozenConfigures::Entry& b)
+                         { return key_of(a) < key_of(b); });
+
+        std::size_t out = 0;
+        for (std::size_t i = 0; i < entries.size(); ++i)
+        {
+            if (i + 1 < entries.size() && key_of(entries[i]) == key_of(entries[i + 1]))
+            {
+                continue;
+            }
+            entries[out++] = entries[i];
+        }
+        entries.resize(out);
+    }
+
+    FrozenConfigures frozen = std::move(frozen_);
+    frozen_ = FrozenConfigures();
+    return frozen;
+}
+
+}  // namespace client
+}  // namespace apollo
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <boost/utility/string_view.hpp>
+#include "apollo/apollo_types.h"
+
+namespace apollo
+{
+namespace client
+{
+using StringView = boost::string_view;
+
+/**
+ * Frozen, contiguous layout of one namespace release.
+ * All keys and values live in a single arena buffer, an offset table sorted by key points into it.
+ * Compared to Configures it needs two allocations instead of two per entry (plus the tree nodes),
+ * and iteration walks memory linearly.
+ * It is the layout of the snapshot cache files, the live releases of a client are still held as Configures.
+ */
+class FrozenConfigures
+{
+public:
+    struct Entry
+    {
+        std::uint32_t key_offset_;
+        std::uint32_t key_size_;
+        std::uint32_t value_offset_;
+        std::uint32_t value_size_;
+    };
+
+    FrozenConfigures() = default;
+    explicit FrozenConfigures(const Configures& configures);
+    ~FrozenConfigures() = default;
+
+    inline std::size_t size() const
+    {
+        return entries_.size();
+    }
+
+    inline bool empty() const
+    {
+        return entries_.empty();
+    }
+
+    inline StringView key(std::size_t i) const
+    {
+        const Entry& e = entries_[i];
+        return StringView(arena_.data() + e.key_offset_, e.key_size_);
+    }
+
+    inline StringView value(std::size_t i) const
+    {
+        const Entry& e = entries_[i];
+        return StringView(arena_.data() + e.value_offset_, e.value_size_);
+    }
+
+    // Returns the position of the key (binary search), or size() if the key does not exist.
+    std::size_t find(StringView key) const;
+
+    // Calls func(key, value) for every entry in key order.
+    template <class F>
+    void forEach(F&& func) const
+    {
+        for (std::size_t i = 0; i < entries_.size(); ++i)
+        {
+            func(key(i), value(i));
+        }
+    }
+
+    // Converts back to the node-based Configures used by the public API.
+    Configures thaw() const;
+
+    // Bytes held by the arena and the offset table.
+    std::size_t memoryUsage() const;
+
+    inline const std::string& arena() const
+    {
+        return arena_;
+    }
+
+    inline const std::vector<Entry>& entries() const
+    {
+        return entries_;
+    }
+
+private:
+    friend class FrozenConfiguresBuilder;
+
+    std::string arena_;           // Keys and values of all entries, back to back
+    std::vector<Entry> entries_;  // Sorted by key
+};
+
+/**
+ * Builds a FrozenConfigures from entries added in any order.
+ * If a key is added more than once the last value wins, as with repeated keys in a JSON object.
+ */
+class FrozenConfiguresBuilder
+{
+public:
+    FrozenConfiguresBuilder() = default;
+    ~FrozenConfiguresBuilder() = default;
+
+    void reserve(std::size_t entries, std::size_t arena_bytes);
+
+    // throw std::length_error if the arena grows beyond the 32-bit offset range
+    void add(StringView key, StringView value);
+
+    FrozenConfigures build();
+
+private:
+    std::uint32_t append(StringView s);
+
+    FrozenConfigures frozen_;
+};
+
+}  // namespace client
+}  // namespace apollo
@@ -1,4 +1,6 @@
 #include "http_client.h"
+#include "json_body.h"
+#include <algorithm>
 #include <boost/asio/strand.hpp>
 #include <limits>
 #include "boost/asio/error.hpp"
@@ -10,41 +12,62 @@ namespace client
 {
 
 HttpClient::HttpClient(net::io_context& io_context)
+    : HttpClient(io_context, net::make_strand(io_context))
+{
+}
+
+HttpClient::HttpClient(net::io_context& io_context, Strand callback_strand)
     : io_context_(io_context)
+    , strand_(std::move(callback_strand))
+    , connection_pool_(std::make_shared<ConnectionPool>())
+    , resolver_cache_(std::make_shared<ResolverCache>(io_context))
+    , transfer_counters_(std::make_shared<TransferCounters>())
+{
+}
+
+HttpResult HttpClient::get(const std::string& url, const HttpHeaders& headers)
+{
+    return get<http::string_body>(url, headers);
+}
+
+void HttpClient::getAsync(const std::string& url, HttpResponseCallback callback, const HttpHeaders& headers)
 {
+    getAsync<http::string_body>(url, std::move(callback), headers);
 }
 
-HttpResult HttpClient::get(const std::string& url_str, const HttpHeaders& headers)
+template <class ResponseBody>
+HttpBodyResult<ResponseBody> HttpClient::get(const std::string& url_str, const HttpHeaders& headers)
 {
     auto r = urls::parse_uri(url_str);
     if (!r)
     {
-        return {http::response<http::string_body>{}, beast::error_code{net::error::invalid_argument}};
+        return {http::response<ResponseBody>{}, beast::error_code{net::error::invalid_argument}};
     }
 
     urls::url url = r.value();
     if (url.empty())
     {
-        return {http::response<http::string_body>{}, beast::error_code{net::error::invalid_argument}};
+        return {http::response<ResponseBody>{}, beast::error_code{net::error::invalid_argument}};
     }
 
     http::request<http::string_body> req{http::verb::get, url.path(), 11};
     setupRequest(req, url, headers);
-    return performRequest(req, url);
+    return performRequest<ResponseBody>(req, url);
 }
 
-void HttpClient::getAsync(const std::string& url_str, HttpResponseCallback callback, const HttpHeaders& headers)
+template <class ResponseBody>
+void HttpClient::getAsync(const std::string& url_str, HttpBodyCallback<ResponseBody> callback, const HttpHeaders& headers)
 {
     auto r = urls::parse_uri(url_str);
     if (!r)
     {
-        callback(beast::error_code{net::error::invalid_argument}, http::response<http::string_body>{});
+        callback(beast::error_code{net::error::invalid_argument}, http::response<ResponseBody>{});
         return;
     }
     urls::url url = r.value();
     http::request<http::string_body> req{http::verb::get, url.path(), 11};
     setupRequest(req, url, headers);
-    performRequestAsync(std::move(req), std::move(url), std::move(callback));
+    performRequestAsync<ResponseBody>(std::move(req), std::move(url), std::move(callback));
 }
 
 HttpResult HttpClient::post(const std::string& url_str,
@@ -65,7 +88,7 @@ HttpResult HttpClient::post(const std::string& url_str,
     req.set(http::field::content_type, content_type);
     setupRequest(req, url, headers);
 
-    return performRequest(req, url);
+    return performRequest<http::string_body>(req, url);
 }
 
 void HttpClient::postAsync(const std::string& url_str,
@@ -88,7 +111,7 @@ void HttpClient::postAsync(const std::string& url_str,
     req.set(http::field::content_type, content_type);
     setupRequest(req, url, headers);
 
-    performRequestAsync(std::move(req), std::move(url), std::move(callback));
+    performRequestAsync<http::string_body>(std::move(req), std::move(url), std::move(callback));
 }
 
 void HttpClient::setConnectionTimeout(int timeout_ms)
@@ -106,6 +129,85 @@ void HttpClient::setRequestWriteTimeout(int timeout_ms)
     request_write_timeout_ms_ = timeout_ms;
 }
 
+void HttpClient::setConnectionPool(ConnectionPoolPtr connection_pool)
+{
+    connection_pool_ = std::move(connection_pool);
+}
+
+void HttpClient::setResolverCache(ResolverCachePtr resolver_cache)
+{
+    resolver_cache_ = std::move(resolver_cache);
+}
+
+void HttpClient::setCompression(bool enabled)
+{
+    compression_ = enabled;
+}
+
+HttpTransferStats HttpClient::transferStats() const
+{
+    return transfer_counters_->load();
+}
+
+void HttpClient::TransferCounters::record(bool compressed,
+                                         std::uint64_t wire_bytes,
+                                         std::uint64_t decoded_bytes,
+                                         std::chrono::nanoseconds parse_time)
+{
+    responses_.fetch_add(1, std::memory_order_relaxed);
+    if (compressed)
+    {
+        compressed_responses_.fetch_add(1, std::memory_order_relaxed);
+    }
+    wire_bytes_.fetch_add(wire_bytes, std::memory_order_relaxed);
+    decoded_bytes_.fetch_add(decoded_bytes, std::memory_order_relaxed);
+    body_size_.record(decoded_bytes);
+    parse_time_.record(static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(parse_time).count()));
+}
+
+HttpTransferStats HttpClient::TransferCounters::load() const
+{
+    HttpTransferStats stats;
+    stats.responses_ = responses_.load(std::memory_order_relaxed);
+    stats.compressed_responses_ = compressed_responses_.load(std::memory_order_relaxed);
+    stats.wire_bytes_ = wire_bytes_.load(std::memory_order_relaxed);
+    stats.decoded_bytes_ = decoded_bytes_.load(std::memory_order_relaxed);
+    stats.body_size_ = body_size_.snapshot();
+    stats.parse_time_ = parse_time_.snapshot();
+    return stats;
+}
+
+template <class ResponseBody>
+http::response<ResponseBody> HttpClient::unwrapResponse(http::response<DecodedBody<ResponseBody>>&& res,
+                                                        TransferCounters* counters)
+{
+    auto& value = res.body();
+    if (counters)
+    {
+        counters->record(value.decoded_, value.wire_size_, value.decoded_size_, value.parse_time_);
+    }
+
+    // The caller gets the decoded representation, the coding and the size on the wire no longer apply.
+    if (value.decoded_)
+    {
+        res.erase(http::field::content_encoding);
+        res.erase(http::field::content_length);
+    }
+    return http::response<ResponseBody>(std::move(res.base()), std::move(value.body_));
+}
+
+bool HttpClient::isRetryableOnNewConnection(const ConnectionPool::Lease& lease, http::verb method, beast::error_code ec)
+{
+    // Only idempotent requests are replayed, and only when the server most likely closed the idle connection.
+    if (!lease.reused_ || method != http::verb::get)
+    {
+        return false;
+    }
+
+    return ec == http::error::end_of_stream || ec == net::error::eof || ec == net::error::connection_reset ||
+           ec == net::error::broken_pipe || ec == net::error::connection_aborted;
+}
+
 template <class RequestBody>
 void HttpClient::setupRequest(http::request<RequestBody>& req,
                               const urls::url& url,
@@ -126,6 +228,10 @@ void HttpClient::setupRequest(http::request<RequestBody>& req,
     req.set(http::field::host, host);
 
     req.set(http::field::user_agent, "ApolloClient/1.0");
+    if (compression_)
+    {
+        req.set(http::field::accept_encoding, "gzip, deflate");
+    }
 
     for (const auto& p : headers)
     {
@@ -133,161 +239,370 @@ void HttpClient::setupRequest(http::request<RequestBody>& req,
     }
 }
 
-template <class RequestBody>
-std::pair<http::response<http::string_body>, beast::error_code> HttpClient::performRequest(http::request<RequestBody>& req,
-                                                                                           const urls::url& url)
+template <class ResponseBody, class RequestBody>
+HttpBodyResult<ResponseBody> HttpClient::performRequest(http::request<RequestBody>& req, const urls::url& url)
 {
     beast::error_code ec;
-    http::response<http::string_body> res;
+    http::response<DecodedBody<ResponseBody>> res;
 
     if (url.scheme() == "https")
     {
-        return {res, beast::error_code(net::error::no_protocol_option)};
+        return {http::response<ResponseBody>{}, beast::error_code(net::error::no_protocol_option)};
     }
 
     std::string host = url.host();
     std::string port = url.has_port() ? std::string(url.port()) : "80";
+    std::string key = host + ":" + port;
 
-    tcp::resolver resolver(io_context_);
-    auto results = resolver.resolve(host, port, ec);
-    if (ec)
-    {
-        return {res, beast::error_code(net::error::host_unreachable)};
-    }
-
-    beast::tcp_stream stream(io_context_);
-    stream.expires_after(std::chrono::milliseconds(connection_timeout_ms_));
-    stream.connect(results, ec);
-    if (ec)
+    auto lease = connection_pool_->acquire(key);
+    while (true)
     {
-        return {res, beast::error_code(net::error::host_unreachable)};
+        if (!lease.stream_)
+        {
+            auto results = resolver_cache_->resolve(host, port, ec);
+            if (ec)
+            {
+                return {http::response<ResponseBody>{}, beast::error_code(net::error::host_unreachable)};
+            }
+
+            lease.stream_.reset(new beast::tcp_stream(io_context_));
+            lease.stream_->expires_after(std::chrono::milliseconds(connection_timeout_ms_));
+            lease.stream_->connect(results, ec);
+            if (ec)
+            {
+                resolver_cache_->expire(host, port);
+                connection_pool_->discard(std::move(lease));
+                return {http::response<ResponseBody>{}, beast::error_code(net::error::host_unreachable)};
+            }
+        }
+
+        // Ask the server to keep the connection open only if the pool can adopt it afterwards.
+        req.keep_alive(lease.poolable_);
+
+        auto& stream = *lease.stream_;
+        stream.expires_after(std::chrono::milliseconds(request_write_timeout_ms_));
+        http::write(stream, req, ec);
+        if (!ec)
+        {
+            beast::flat_buffer buffer;
+            stream.expires_after(std::chrono::milliseconds(request_read_timeout_ms_));
+            http::read(stream, buffer, res, ec);
+        }
+
+        if (ec)
+        {
+            bool retry = isRetryableOnNewConnection(lease, req.method(), ec);
+            connection_pool_->discard(std::move(lease));
+            if (retry)
+            {
+                res = {};
+                lease = connection_pool_->acquire(key, false);
+                continue;
+            }
+            return {unwrapResponse(std::move(res), nullptr), ec};
+        }
+
+        if (res.keep_alive())
+        {
+            connection_pool_->release(std::move(lease));
+        }
+        else
+        {
+            connection_pool_->discard(std::move(lease));
+        }
+
+        return {unwrapResponse(std::move(res), transfer_counters_.get()), beast::error_code{}};
     }
+}
 
-    stream.expires_after(std::chrono::milliseconds(request_write_timeout_ms_));
-    http::write(stream, req, ec);
-    if (ec)
+template <class ResponseBody, class RequestBody>
+void HttpClient::performRequestAsync(http::request<RequestBody> req, urls::url url, HttpBodyCallback<ResponseBody> callback)
+{
+    auto session = std::make_shared<AsyncSession<ResponseBody>>(io_context_,
+                                                  strand_,
+                                                  connection_pool_,
+                                                  resolver_cache_,
+                                                  transfer_counters_,
+                                                  std::move(callback),
+                                                  connection_timeout_ms_,
+                                                  request_read_timeout_ms_,
+                                                  request_write_timeout_ms_);
     {
-        return {res, ec};
+        std::unique_lock<std::mutex> lock(sessions_mutex_);
+        sessions_.erase(std::remove_if(sessions_.begin(),
+                                       sessions_.end(),
+                                       [](const std::weak_ptr<Session>& s) { return s.expired(); }),
+                        sessions_.end());
+        sessions_.push_back(session);
     }
+    session->run(std::move(req), url);
+}
 
-    beast::flat_buffer buffer;
-    stream.expires_after(std::chrono::milliseconds(request_read_timeout_ms_));
-    http::read(stream, buffer, res, ec);
-    if (ec)
+void HttpClient::cancel()
+{
+    std::vector<std::weak_ptr<Session>> sessions;
     {
-        return {res, ec};
+        std::unique_lock<std::mutex> lock(sessions_mutex_);
+        sessions.swap(sessions_);
     }
 
-    stream.socket().shutdown(tcp::socket::shutdown_both, ec);
-    if (ec && ec != beast::errc::not_connected)
+    for (auto& weak_session : sessions)
     {
-        return {res, ec};
+        auto session = weak_session.lock();
+        if (session)
+        {
+            session->cancel();
+        }
     }
-
-    ec = {};
-    return {res, ec};
-}
-
-template <class RequestBody>
-void HttpClient::performRequestAsync(http::request<RequestBody> req, urls::url url, HttpResponseCallback callback)
-{
-    auto session = std::make_shared<AsyncSession>(io_context_,
-                                                  std::move(callback),
-                                                  connection_timeout_ms_,
-                                                  request_read_timeout_ms_,
-                                                  request_write_timeout_ms_);
-    session->run(std::move(req), url);
 }
 
-HttpClient::AsyncSession::AsyncSession(net::io_context& ioc,
-                                       HttpResponseCallback callback,
-                                       int connection_timeout_ms,
-                                       int request_read_timeout_ms,
-                                       int request_write_timeout_ms)
-    : resolver_(ioc)
-    , stream_(ioc)
+template <class ResponseBody>
+HttpClient::AsyncSession<ResponseBody>::AsyncSession(net::io_context& ioc,
+                                                     Strand callback_strand,
+                                                     ConnectionPoolPtr connection_pool,
+                                                     ResolverCachePtr resolver_cache,
+                                                     TransferCountersPtr transfer_counters,
+                                                     HttpBodyCallback<ResponseBody> callback,
+                                                     int connection_timeout_ms,
+                                                     int request_read_timeout_ms,
+                                                     int request_write_timeout_ms)
+    : ioc_(ioc)
+    , strand_(net::make_strand(ioc))
+    , callback_strand_(std::move(callback_strand))
+    , connection_pool_(std::move(connection_pool))
+    , resolver_cache_(std::move(resolver_cache))
+    , transfer_counters_(std::move(transfer_counters))
     , callback_(std::move(callback))
-    , timer_(ioc)
+    , timer_(strand_)
     , connection_timeout_ms_(connection_timeout_ms)
     , request_read_timeout_ms_(request_read_timeout_ms)
     , request_write_timeout_ms_(request_write_timeout_ms)
 {
 }
 
-void HttpClient::AsyncSession::run(http::request<http::string_body> req, const urls::url& url)
+template <class ResponseBody>
+void HttpClient::AsyncSession<ResponseBody>::run(http::request<http::string_body> req, const urls::url& url)
 {
     req_ = std::move(req);
 
-    std::string host = url.host();
-    std::string port = url.has_port() ? std::string(url.port()) : "80";
+    host_ = url.host();
+    port_ = url.has_port() ? std::string(url.port()) : "80";
+
+    net::dispatch(strand_,
+                  [shared_this = this->shared_from_this(), https = url.scheme() == "https"]()
+                  {
+                      if (https)
+                      {
+                          shared_this->complete(beast::error_code(net::error::no_protocol_option));
+                          return;
+                      }
+
+                      if (shared_this->cancelled_)
+                      {
+                          shared_this->complete(beast::error_code(net::error::operation_aborted));
+                          return;
+                      }
+
+                      shared_this->doTimeout();
+
+                      shared_this->lease_ =
+                          shared_this->connection_pool_->acquire(shared_this->host_ + ":" + shared_this->port_);
+                      if (shared_this->lease_.stream_)
+                      {
+                          shared_this->doWrite();
+                          return;
+                      }
+                      shared_this->doResolve();
+                  });
+}
 
-    if (url.scheme() == "https")
+template <class ResponseBody>
+void HttpClient::AsyncSession<ResponseBody>::doResolve()
+{
+    // The resolver calls back on any thread running the io_context, or inline on a cache hit.
+    resolver_cache_->asyncResolve(host_,
+                                  port_,
+                                  [shared_this = this->shared_from_this()](beast::error_code ec,
+                                                                           tcp::resolver::results_type results)
+                                  {
+                                      net::dispatch(shared_this->strand_,
+                                                    beast::bind_front_handler(
+                                                        &AsyncSession::onResolve, shared_this, ec, std::move(results)));
+                                  });
+}
+
+template <class ResponseBody>
+void HttpClient::AsyncSession<ResponseBody>::onResolve(beast::error_code ec, tcp::resolver::results_type results)
+{
+    if (cancelled_ || completed_)
     {
-        callback_(beast::error_code(net::error::no_protocol_option), res_);
+        complete(beast::error_code(net::error::operation_aborted));
         return;
     }
 
-    doTimeout();
+    if (timed_out_)
+    {
+        complete(beast::error_code(net::error::timed_out));
+        return;
+    }
 
-    resolver_.async_resolve(host, port, beast::bind_front_handler(&AsyncSession::onResolve, shared_from_this()));
+    if (ec)
+    {
+        complete(beast::error_code(net::error::host_unreachable));
+        return;
+    }
+
+    lease_.stream_.reset(new beast::tcp_stream(ioc_));
+    lease_.stream_->expires_after(std::chrono::milliseconds(connection_timeout_ms_));
+    lease_.stream_->async_connect(
+        results,
+        net::bind_executor(strand_, beast::bind_front_handler(&AsyncSession::onConnect, this->shared_from_this())));
 }
 
-void HttpClient::AsyncSession::onResolve(beast::error_code ec, tcp::resolver::results_type results)
+template <class ResponseBody>
+void HttpClient::AsyncSession<ResponseBody>::onConnect(beast::error_code ec, tcp::endpoint)
 {
     if (ec)
     {
-        callback_(beast::error_code(net::error::host_unreachable), res_);
+        resolver_cache_->expire(host_, port_);
+        complete(beast::error_code(net::error::host_unreachable));
         return;
     }
 
-    stream_.expires_after(std::chrono::milliseconds(connection_timeout_ms_));
-    stream_.async_connect(results, beast::bind_front_handler(&AsyncSession::onConnect, shared_from_this()));
+    doWrite();
+}
+
+template <class ResponseBody>
+void HttpClient::AsyncSession<ResponseBody>::doWrite()
+{
+    // Ask the server to keep the connection open only if the pool can adopt it afterwards.
+    req_.keep_alive(lease_.poolable_);
+
+    lease_.stream_->expires_after(std::chrono::milliseconds(request_write_timeout_ms_));
+    http::async_write(
+        *lease_.stream_,
+        req_,
+        net::bind_executor(strand_, beast::bind_front_handler(&AsyncSession::onWrite, this->shared_from_this())));
 }
 
-void HttpClient::AsyncSession::onConnect(beast::error_code ec, tcp::endpoint)
+template <class ResponseBody>
+void HttpClient::AsyncSession<ResponseBody>::onWrite(beast::error_code ec, std::size_t bytes_transferred)
 {
+    boost::ignore_unused(bytes_transferred);
+
     if (ec)
     {
-        callback_(beast::error_code(net::error::host_unreachable), res_);
+        if (!retryOnNewConnection(ec))
+        {
+            complete(ec);
+        }
         return;
     }
 
-    stream_.expires_after(std::chrono::milliseconds(connection_timeout_ms_));
-    http::async_write(stream_, req_, beast::bind_front_handler(&AsyncSession::onWrite, shared_from_this()));
+    lease_.stream_->expires_after(std::chrono::milliseconds(request_read_timeout_ms_));
+    http::async_read(
+        *lease_.stream_,
+        buffer_,
+        res_,
+        net::bind_executor(strand_, beast::bind_front_handler(&AsyncSession::onRead, this->shared_from_this())));
 }
 
-void HttpClient::AsyncSession::onWrite(beast::error_code ec, std::size_t bytes_transferred)
+template <class ResponseBody>
+void HttpClient::AsyncSession<ResponseBody>::onRead(beast::error_code ec, std::size_t bytes_transferred)
 {
     boost::ignore_unused(bytes_transferred);
 
     if (ec)
     {
-        callback_(ec, res_);
+        if (!retryOnNewConnection(ec))
+        {
+            complete(ec);
+        }
         return;
     }
 
-    stream_.expires_after(std::chrono::milliseconds(request_write_timeout_ms_));
-    http::async_read(stream_, buffer_, res_, beast::bind_front_handler(&AsyncSession::onRead, shared_from_this()));
+    complete(ec);
 }
 
-void HttpClient::AsyncSession::onRead(beast::error_code ec, std::size_t bytes_transferred)
+template <class ResponseBody>
+bool HttpClient::AsyncSession<ResponseBody>::retryOnNewConnection(beast::error_code ec)
 {
-    boost::ignore_unused(bytes_transferred);
+    bool retry = !cancelled_ && isRetryableOnNewConnection(lease_, req_.method(), ec);
+    connection_pool_->discard(std::move(lease_));
+    if (!retry)
+    {
+        return false;
+    }
+
+    res_ = {};
+    buffer_.clear();
+    lease_ = connection_pool_->acquire(host_ + ":" + port_, false);
+    doResolve();
+    return true;
+}
 
+template <class ResponseBody>
+void HttpClient::AsyncSession<ResponseBody>::complete(beast::error_code ec)
+{
+    if (completed_)
+    {
+        return;
+    }
+    completed_ = true;
     timer_.cancel();
 
-    beast::error_code close_ec;
-    stream_.socket().shutdown(tcp::socket::shutdown_both, close_ec);
+    if (cancelled_)
+    {
+        ec = net::error::operation_aborted;
+    }
+    else if (timed_out_ && ec == net::error::operation_aborted)
+    {
+        // handleTimeout closed the stream, the write or read it aborted timed out.
+        ec = beast::error::timeout;
+    }
 
-    if (close_ec && close_ec != beast::errc::not_connected)
+    if (!ec && res_.keep_alive())
     {
-        ec = close_ec;
+        connection_pool_->release(std::move(lease_));
     }
+    else
+    {
+        connection_pool_->discard(std::move(lease_));
+    }
+
+    // The callback runs on the strand of its client, not on the one of the session.
+    net::dispatch(callback_strand_,
+                  [callback = std::move(callback_),
+                   ec,
+                   res = unwrapResponse(std::move(res_), ec ? nullptr : transfer_counters_.get())]() mutable
+                  { callback(ec, std::move(res)); });
+}
 
-    callback_(ec, res_);
+template <class ResponseBody>
+void HttpClient::AsyncSession<ResponseBody>::cancel()
+{
+    net::dispatch(strand_, [shared_this = this->shared_from_this()]() { shared_this->doCancel(); });
 }
 
-void HttpClient::AsyncSession::doTimeout()
+template <class ResponseBody>
+void HttpClient::AsyncSession<ResponseBody>::doCancel()
+{
+    if (completed_)
+    {
+        return;
+    }
+
+    // Closing the stream aborts the pending write or read, a pending resolve completes as aborted.
+    cancelled_ = true;
+    timer_.cancel();
+    if (lease_.stream_)
+    {
+        lease_.stream_->close();
+    }
+}
+
+template <class ResponseBody>
+void HttpClient::AsyncSession<ResponseBody>::doTimeout()
 {
     auto total_timeout_ms = connection_timeout_ms_ + request_read_timeout_ms_ + request_write_timeout_ms_;
     if (total_timeout_ms <= 0 || total_timeout_ms > std::numeric_limits<int>::max())
@@ -296,16 +611,33 @@ void HttpClient::AsyncSession::doTimeout()
     }
 
     timer_.expires_after(std::chrono::milliseconds(total_timeout_ms));
-    timer_.async_wait(beast::bind_front_handler(&AsyncSession::handleTimeout, shared_from_this()));
+    timer_.async_wait(beast::bind_front_handler(&AsyncSession::handleTimeout, this->shared_from_this()));
 }
 
-void HttpClient::AsyncSession::handleTimeout(beast::error_code ec)
+template <class ResponseBody>
+void HttpClient::AsyncSession<ResponseBody>::handleTimeout(beast::error_code ec)
 {
     if (ec != boost::asio::error::operation_aborted && timer_.expiry() <= net::steady_timer::clock_type::now())
     {
-        stream_.close();
+        timed_out_ = true;
+        if (lease_.stream_)
+        {
+            lease_.stream_->close();
+        }
     }
 }
 
+// Response bodies used by the client.
+template HttpBodyResult<http::string_body> HttpClient::get<http::string_body>(const std::string&, const HttpHeaders&);
+template HttpBodyResult<ConfigsBody> HttpClient::get<ConfigsBody>(const std::string&, const HttpHeaders&);
+template HttpBodyResult<NotificationsBody> HttpClient::get<NotificationsBody>(const std::string&, const HttpHeaders&);
+template void HttpClient::getAsync<http::string_body>(const std::string&,
+                                                      HttpBodyCallback<http::string_body>,
+                                                      const HttpHeaders&);
+template void HttpClient::getAsync<ConfigsBody>(const std::string&, HttpBodyCallback<ConfigsBody>, const HttpHeaders&);
+template void HttpClient::getAsync<NotificationsBody>(const std::string&,
+                                                      HttpBodyCallback<NotificationsBody>,
+                                                      const HttpHeaders&);
+
 }  // namespace client
 }  // namespace apollo
\ No newline at end of file
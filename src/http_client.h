@@ -3,10 +3,18 @@
 #include <boost/asio.hpp>
 #include <boost/beast.hpp>
 #include <boost/url.hpp>
+#include <atomic>
+#include <cstdint>
 #include <functional>
 #include <string>
 #include <memory>
 #include <map>
+#include <mutex>
+#include <vector>
+#include "atomic_histogram.h"
+#include "connection_pool.h"
+#include "decoded_body.h"
+#include "resolver_cache.h"
 
 namespace net = boost::asio;
 namespace beast = boost::beast;
@@ -18,18 +26,45 @@ namespace apollo
 {
 namespace client
 {
-using HttpResponseCallback = std::function<void(beast::error_code ec, http::response<http::string_body>)>;
+using Strand = net::strand<net::io_context::executor_type>;
+
+template <class ResponseBody>
+using HttpBodyCallback = std::function<void(beast::error_code ec, http::response<ResponseBody>)>;
+template <class ResponseBody>
+using HttpBodyResult = std::pair<http::response<ResponseBody>, beast::error_code>;
+
+using HttpResponseCallback = HttpBodyCallback<http::string_body>;
 using HttpHeaders = std::map<std::string, std::string>;
-using HttpResult = std::pair<http::response<http::string_body>, beast::error_code>;
+using HttpResult = HttpBodyResult<http::string_body>;
+
+// Response bodies read by a client, as received and once their Content-Encoding was removed.
+struct HttpTransferStats
+{
+    std::uint64_t responses_ = 0;
+    std::uint64_t compressed_responses_ = 0;
+    std::uint64_t wire_bytes_ = 0;
+    std::uint64_t decoded_bytes_ = 0;
+    HistogramMetrics body_size_;   // Decoded bytes per response
+    HistogramMetrics parse_time_;  // Microseconds spent in the body reader per response
+};
 
 class HttpClient
 {
 public:
     HttpClient(net::io_context& io_context);
+    // Asynchronous callbacks are run on callback_strand, so the io_context may be run by several threads.
+    HttpClient(net::io_context& io_context, Strand callback_strand);
     ~HttpClient() = default;
     HttpResult get(const std::string& url, const HttpHeaders& headers = {});
     void getAsync(const std::string& url, HttpResponseCallback callback, const HttpHeaders& headers = {});
 
+    // Same as above, the response is read into ResponseBody, e.g. a ConfigsBody parsed as it arrives.
+    // Instantiated for http::string_body, ConfigsBody and NotificationsBody.
+    template <class ResponseBody>
+    HttpBodyResult<ResponseBody> get(const std::string& url, const HttpHeaders& headers = {});
+    template <class ResponseBody>
+    void getAsync(const std::string& url, HttpBodyCallback<ResponseBody> callback, const HttpHeaders& headers = {});
+
     HttpResult post(const std::string& url,
                     const std::string& body,
                     const std::string& content_type = "application/json",
@@ -43,6 +78,21 @@ public:
     void setConnectionTimeout(int timeout_ms);
     void setRequestReadTimeout(int timeout_ms);
     void setRequestWriteTimeout(int timeout_ms);
+    // Replaces the keep-alive connection pool, e.g. to share one between clients.
+    void setConnectionPool(ConnectionPoolPtr connection_pool);
+    // Replaces the host name resolution cache, e.g. to change its ttl or share one between clients.
+    void setResolverCache(ResolverCachePtr resolver_cache);
+    inline const ResolverCachePtr& resolverCache() const
+    {
+        return resolver_cache_;
+    }
+    // Advertises gzip and deflate in Accept-Encoding. Compressed responses are decoded while they are read
+    // whatever the setting, their callers only see the decoded body.
+    void setCompression(bool enabled);
+    HttpTransferStats transferStats() const;
+
+    // Aborts every asynchronous request in flight, their callbacks get net::error::operation_aborted.
+    void cancel();
 
 private:
     HttpClient(const HttpClient&) = delete;             // Disable copy constructor
@@ -54,39 +104,97 @@ private:
     template <class RequestBody>
     void setupRequest(http::request<RequestBody>& req, const urls::url& url, const HttpHeaders& headers);
 
-    template <class RequestBody>
-    HttpResult performRequest(http::request<RequestBody>& req, const urls::url& url);
+    template <class ResponseBody, class RequestBody>
+    HttpBodyResult<ResponseBody> performRequest(http::request<RequestBody>& req, const urls::url& url);
 
-    template <class RequestBody>
-    void performRequestAsync(http::request<RequestBody> req, urls::url url, HttpResponseCallback callback);
+    template <class ResponseBody, class RequestBody>
+    void performRequestAsync(http::request<RequestBody> req, urls::url url, HttpBodyCallback<ResponseBody> callback);
+
+    // Whether a request that failed with ec on a reused keep-alive connection can be retried on a new one.
+    static bool isRetryableOnNewConnection(const ConnectionPool::Lease& lease, http::verb method, beast::error_code ec);
+
+    class TransferCounters
+    {
+    public:
+        void record(bool compressed,
+                    std::uint64_t wire_bytes,
+                    std::uint64_t decoded_bytes,
+                    std::chrono::nanoseconds parse_time);
+        HttpTransferStats load() const;
+
+    private:
+        std::atomic<std::uint64_t> responses_{0};
+        std::atomic<std::uint64_t> compressed_responses_{0};
+        std::atomic<std::uint64_t> wire_bytes_{0};
+        std::atomic<std::uint64_t> decoded_bytes_{0};
+        AtomicHistogram body_size_{AtomicHistogram::sizeBounds()};
+        AtomicHistogram parse_time_{AtomicHistogram::processingBounds()};
+    };
+    using TransferCountersPtr = std::shared_ptr<TransferCounters>;
+
+    // Hands the decoded response over to the caller, recorded in counters unless it is null.
+    template <class ResponseBody>
+    static http::response<ResponseBody> unwrapResponse(http::response<DecodedBody<ResponseBody>>&& res,
+                                                       TransferCounters* counters);
+
+    // Asynchronous request in flight, as seen by cancel(). Each session runs on a strand of its own,
+    // its connection may be shared with other clients through the pool.
+    class Session
+    {
+    public:
+        virtual ~Session() = default;
+        virtual void cancel() = 0;
+    };
 
-    class AsyncSession : public std::enable_shared_from_this<AsyncSession>
+    template <class ResponseBody>
+    class AsyncSession : public Session, public std::enable_shared_from_this<AsyncSession<ResponseBody>>
     {
     public:
         AsyncSession(net::io_context& ioc,
-                     HttpResponseCallback callback,
+                     Strand callback_strand,
+                     ConnectionPoolPtr connection_pool,
+                     ResolverCachePtr resolver_cache,
+                     TransferCountersPtr transfer_counters,
+                     HttpBodyCallback<ResponseBody> callback,
                      int connection_timeout_ms,
                      int request_read_timeout_ms,
                      int request_write_timeout_ms);
-        ~AsyncSession() = default;
+        ~AsyncSession() override = default;
 
         void run(http::request<http::string_body> req, const urls::url& url);
 
     public:
+        void doResolve();
         void onResolve(beast::error_code ec, tcp::resolver::results_type results);
         void onConnect(beast::error_code ec, tcp::endpoint);
+        void doWrite();
         void onWrite(beast::error_code ec, std::size_t bytes_transferred);
         void onRead(beast::error_code ec, std::size_t bytes_transferred);
         void doTimeout();
         void handleTimeout(beast::error_code ec);
+        void cancel() override;
 
     private:
-        tcp::resolver resolver_;
-        beast::tcp_stream stream_;
+        bool retryOnNewConnection(beast::error_code ec);
+        void complete(beast::error_code ec);
+        void doCancel();
+
+        net::io_context& ioc_;
+        Strand strand_;
+        Strand callback_strand_;
+        ConnectionPoolPtr connection_pool_;
+        ConnectionPool::Lease lease_;
+        ResolverCachePtr resolver_cache_;
+        TransferCountersPtr transfer_counters_;
+        std::string host_;
+        std::string port_;
+        bool timed_out_ = false;
+        bool cancelled_ = false;
+        bool completed_ = false;
         beast::flat_buffer buffer_;
         http::request<http::string_body> req_;
-        http::response<http::string_body> res_;
-        HttpResponseCallback callback_;
+        http::response<DecodedBody<ResponseBody>> res_;
+        HttpBodyCallback<ResponseBody> callback_;
         net::steady_timer timer_;
         int connection_timeout_ms_;
         int request_read_timeout_ms_;
@@ -94,6 +202,13 @@ private:
     };
 
     net::io_context& io_context_;
+    Strand strand_;
+    std::mutex sessions_mutex_;
+    std::vector<std::weak_ptr<Session>> sessions_;  // Asynchronous requests that may be in flight
+    ConnectionPoolPtr connection_pool_;
+    ResolverCachePtr resolver_cache_;
+    TransferCountersPtr transfer_counters_;
+    bool compression_ = false;
     int connection_timeout_ms_ = 500;       // Default connection timeout in milliseconds
     int request_read_timeout_ms_ = 30000;   // Default read timeout in milliseconds
     int request_write_timeout_ms_ = 30000;  // Default write timeout in milliseconds
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <boost/asio/buffer.hpp>
+#include <boost/beast/http.hpp>
+#include <boost/optional.hpp>
+#include <boost/system/error_code.hpp>
+#include "apollo_internal.h"
+#include "json_push_parser.h"
+#include "json_sax_handlers.h"
+
+namespace apollo
+{
+namespace client
+{
+/**
+ * Beast body that parses a JSON response while it is received: every chunk read from the socket is pushed
+ * to a JsonPushParser driving Handler, which fills the body value in place. No body string is kept.
+ *
+ * Only 200 responses are parsed, other bodies (e.g. error pages) are discarded and leave the value empty.
+ * A body that is empty, not valid JSON, or rejected by Handler, fails the read with errc::bad_message.
+ */
+template <class Value, class Handler>
+struct JsonBody
+{
+    using value_type = Value;
+
+    class reader
+    {
+    public:
+        template <bool isRequest, class Fields>
+        reader(boost::beast::http::header<isRequest, Fields>& h, value_type& body)
+            : handler_(body)
+            , parser_(handler_)
+            , should_parse_([&h]() { return shouldParse(h); })
+        {
+        }
+
+        void init(const boost::optional<std::uint64_t>&, boost::system::error_code& ec)
+        {
+            // The reader is built along with the parser, the header is only known once the body starts.
+            parse_ = should_parse_();
+            ec = {};
+        }
+
+        template <class ConstBufferSequence>
+        std::size_t put(const ConstBufferSequence& buffers, boost::system::error_code& ec)
+        {
+            std::size_t bytes = 0;
+            for (auto it = boost::asio::buffer_sequence_begin(buffers); it != boost::asio::buffer_sequence_end(buffers);
+                 ++it)
+            {
+                boost::asio::const_buffer buffer = *it;
+                if (parse_ && !parser_.feed(static_cast<const char*>(buffer.data()), buffer.size()))
+                {
+                    ec = boost::system::errc::make_error_code(boost::system::errc::bad_message);
+                    return bytes;
+                }
+                bytes += buffer.size();
+            }
+            ec = {};
+            return bytes;
+        }
+
+        void finish(boost::system::error_code& ec)
+        {
+            // Beast skips init() for a body of Content-Length 0 but still calls finish(), so the header is
+            // checked again: a 200 whose parse never started is as invalid as one left incomplete.
+            ec = {};
+            if (should_parse_() && !(parse_ && parser_.finish() && handler_.complete()))
+            {
+                ec = boost::system::errc::make_error_code(boost::system::errc::bad_message);
+            }
+        }
+
+    private:
+        template <class Fields>
+        static bool shouldParse(const boost::beast::http::header<false, Fields>& h)
+        {
+            return h.result() == boost::beast::http::status::ok;
+        }
+
+        template <class Fields>
+        static bool shouldParse(const boost::beast::http::header<true, Fields>&)
+        {
+            return true;
+        }
+
+        Handler handler_;
+        JsonPushParser parser_;
+        std::function<bool()> should_parse_;
+        bool parse_ = false;
+    };
+};
+
+// Body of a /configs response.
+using ConfigsBody = JsonBody<ConfigsResponse, ConfigsSaxHandler>;
+
+// Body of a /notifications/v2 response.
+using NotificationsBody = JsonBody<Notifications, NotificationsSaxHandler>;
+
+}  // namespace client
+}  // namespace apollo
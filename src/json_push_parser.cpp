@@ -0,0 +1,497 @@
+#include "json_push_parser.h"
+#include <cerrno>
+#include <cstdlib>
+
+namespace apollo
+{
+namespace client
+{
+namespace
+{
+constexpr std::size_t unknown_size = static_cast<std::size_t>(-1);
+
+inline bool isPlainStringChar(char c)
+{
+    return c != '"' && c != '\\' && static_cast<unsigned char>(c) >= 0x20;
+}
+
+inline bool isNumberChar(char c)
+{
+    return (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+}
+
+inline bool isWhitespace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+inline bool isDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+int hexValue(char c)
+{
+    if (c >= '0' && c <= '9')
+    {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f')
+    {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F')
+    {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+void appendUtf8(std::string& s, unsigned cp)
+{
+    if (cp < 0x80)
+    {
+        s += static_cast<char>(cp);
+    }
+    else if (cp < 0x800)
+    {
+        s += static_cast<char>(0xC0 | (cp >> 6));
+        s += static_cast<char>(0x80 | (cp & 0x3F));
+    }
+    else if (cp < 0x10000)
+    {
+        s += static_cast<char>(0xE0 | (cp >> 12));
+        s += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        s += static_cast<char>(0x80 | (cp & 0x3F));
+    }
+    else
+    {
+        s += static_cast<char>(0xF0 | (cp >> 18));
+        s += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+        s += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        s += static_cast<char>(0x80 | (cp & 0x3F));
+    }
+}
+
+// -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)?
+bool isValidNumber(const std::string& s, bool& integer)
+{
+    std::size_t i = 0;
+    auto digits = [&s, &i]()
+    {
+        std::size_t start = i;
+        while (i < s.size() && isDigit(s[i]))
+        {
+            ++i;
+        }
+        return i - start;
+    };
+
+    if (i < s.size() && s[i] == '-')
+    {
+        ++i;
+    }
+    if (i < s.size() && s[i] == '0')
+    {
+        ++i;
+    }
+    else if (digits() == 0)
+    {
+        return false;
+    }
+
+    integer = true;
+    if (i < s.size() && s[i] == '.')
+    {
+        ++i;
+        integer = false;
+        if (digits() == 0)
+        {
+            return false;
+        }
+    }
+    if (i < s.size() && (s[i] == 'e' || s[i] == 'E'))
+    {
+        ++i;
+        integer = false;
+        if (i < s.size() && (s[i] == '+' || s[i] == '-'))
+        {
+            ++i;
+        }
+        if (digits() == 0)
+        {
+            return false;
+        }
+    }
+    return i == s.size();
+}
+}  // namespace
+
+JsonPushParser::JsonPushParser(JsonSax& sax)
+    : sax_(sax)
+{
+}
+
+bool JsonPushParser::feed(const char* data, std::size_t size)
+{
+    std::size_t i = 0;
+    while (i < size && !failed_)
+    {
+        if (lex_ == Lex::String && high_surrogate_ == 0)
+        {
+            // Copy the run of characters that need no processing at once.
+            std::size_t end = i;
+            while (end < size && isPlainStringChar(data[end]))
+            {
+                ++end;
+            }
+            token_.append(data + i, end - i);
+            i = end;
+            if (i == size)
+            {
+                break;
+            }
+        }
+
+        failed_ = !consume(data[i]);
+        ++i;
+    }
+    return !failed_;
+}
+
+bool JsonPushParser::finish()
+{
+    if (failed_)
+    {
+        return false;
+    }
+
+    bool ok = true;
+    if (lex_ == Lex::Number)
+    {
+        lex_ = Lex::None;
+        ok = endNumber();
+    }
+    else if (lex_ == Lex::Literal)
+    {
+        lex_ = Lex::None;
+        ok = endLiteral();
+    }
+    else if (lex_ != Lex::None)
+    {
+        ok = false;  // Unterminated string
+    }
+
+    failed_ = !(ok && expect_ == Expect::Done);
+    return !failed_;
+}
+
+bool JsonPushParser::consume(char c)
+{
+    switch (lex_)
+    {
+        case Lex::String:
+            if (high_surrogate_ != 0 && c != '\\')
+            {
+                return false;  // A high surrogate must be followed by an escaped low surrogate
+            }
+            if (c == '"')
+            {
+                lex_ = Lex::None;
+                return endString();
+            }
+            if (c == '\\')
+            {
+                lex_ = Lex::Escape;
+                return true;
+            }
+            if (static_cast<unsigned char>(c) < 0x20)
+            {
+                return false;  // Control characters must be escaped
+            }
+            token_ += c;
+            return true;
+
+        case Lex::Escape:
+            if (high_surrogate_ != 0 && c != 'u')
+            {
+                return false;
+            }
+            lex_ = Lex::String;
+            switch (c)
+            {
+                case '"':
+                case '\\':
+                case '/':
+                    token_ += c;
+                    return true;
+                case 'b':
+                    token_ += '\b';
+                    return true;
+                case 'f':
+                    token_ += '\f';
+                    return true;
+                case 'n':
+                    token_ += '\n';
+                    return true;
+                case 'r':
+                    token_ += '\r';
+                    return true;
+                case 't':
+                    token_ += '\t';
+                    return true;
+                case 'u':
+                    lex_ = Lex::Unicode;
+                    unicode_ = 0;
+                    unicode_digits_ = 0;
+                    return true;
+                default:
+                    return false;
+            }
+
+        case Lex::Unicode:
+        {
+            int v = hexValue(c);
+            if (v < 0)
+            {
+                return false;
+            }
+            unicode_ = unicode_ * 16 + static_cast<unsigned>(v);
+            if (++unicode_digits_ < 4)
+            {
+                return true;
+            }
+            lex_ = Lex::String;
+            return endUnicode();
+        }
+
+        case Lex::Number:
+            if (isNumberChar(c))
+            {
+                token_ += c;
+                return true;
+            }
+            lex_ = Lex::None;
+            if (!endNumber())
+            {
+                return false;
+            }
+            break;  // c is the character following the number
+
+        case Lex::Literal:
+            if (c >= 'a' && c <= 'z')
+            {
+                token_ += c;
+                return true;
+            }
+            lex_ = Lex::None;
+            if (!endLiteral())
+            {
+                return false;
+            }
+            break;  // c is the character following the literal
+
+        case Lex::None:
+            break;
+    }
+
+    if (isWhitespace(c))
+    {
+        return true;
+    }
+
+    switch (expect_)
+    {
+        case Expect::FirstValueOrEnd:
+            if (c == ']')
+            {
+                return endContainer('[');
+            }
+            return beginValue(c);
+
+        case Expect::Value:
+            return beginValue(c);
+
+        case Expect::FirstKeyOrEnd:
+            if (c == '}')
+            {
+                return endContainer('{');
+            }
+            // fall through
+        case Expect::Key:
+            if (c != '"')
+            {
+                return false;
+            }
+            lex_ = Lex::String;
+            key_ = true;
+            token_.clear();
+            return true;
+
+        case Expect::Colon:
+            if (c != ':')
+            {
+                return false;
+            }
+            expect_ = Expect::Value;
+            return true;
+
+        case Expect::CommaOrEnd:
+            if (c == ',')
+            {
+                expect_ = stack_.back() == '{' ? Expect::Key : Expect::Value;
+                return true;
+            }
+            if (c == '}' || c == ']')
+            {
+                return endContainer(c == '}' ? '{' : '[');
+            }
+            return false;
+
+        case Expect::Done:
+            return false;
+    }
+    return false;
+}
+
+bool JsonPushParser::beginValue(char c)
+{
+    switch (c)
+    {
+        case '{':
+            stack_.push_back('{');
+            expect_ = Expect::FirstKeyOrEnd;
+            return sax_.start_object(unknown_size);
+        case '[':
+            stack_.push_back('[');
+            expect_ = Expect::FirstValueOrEnd;
+            return sax_.start_array(unknown_size);
+        case '"':
+            lex_ = Lex::String;
+            key_ = false;
+            token_.clear();
+            return true;
+        case 't':
+        case 'f':
+        case 'n':
+            lex_ = Lex::Literal;
+            token_.assign(1, c);
+            return true;
+        default:
+            if (c == '-' || isDigit(c))
+            {
+                lex_ = Lex::Number;
+                token_.assign(1, c);
+                return true;
+            }
+            return false;
+    }
+}
+
+bool JsonPushParser::endValue()
+{
+    expect_ = stack_.empty() ? Expect::Done : Expect::CommaOrEnd;
+    return true;
+}
+
+bool JsonPushParser::endString()
+{
+    if (key_)
+    {
+        expect_ = Expect::Colon;
+        return sax_.key(token_);
+    }
+    return sax_.string(token_) && endValue();
+}
+
+bool JsonPushParser::endUnicode()
+{
+    if (high_surrogate_ != 0)
+    {
+        if (unicode_ < 0xDC00 || unicode_ > 0xDFFF)
+        {
+            return false;
+        }
+        appendUtf8(token_, 0x10000 + ((high_surrogate_ - 0xD800) << 10) + (unicode_ - 0xDC00));
+        high_surrogate_ = 0;
+        return true;
+    }
+
+    if (unicode_ >= 0xD800 && unicode_ <= 0xDBFF)
+    {
+        high_surrogate_ = unicode_;
+        return true;
+    }
+    if (unicode_ >= 0xDC00 && unicode_ <= 0xDFFF)
+    {
+        return false;  // Low surrogate without its high half
+    }
+
+    appendUtf8(token_, unicode_);
+    return true;
+}
+
+bool JsonPushParser::endNumber()
+{
+    bool integer = false;
+    if (!isValidNumber(token_, integer))
+    {
+        return false;
+    }
+
+    if (integer)
+    {
+        // Integers out of the 64-bit range are reported as floating point numbers, as nlohmann does.
+        errno = 0;
+        if (token_[0] == '-')
+        {
+            auto value = std::strtoll(token_.c_str(), nullptr, 10);
+            if (errno == 0)
+            {
+                return sax_.number_integer(value) && endValue();
+            }
+        }
+        else
+        {
+            auto value = std::strtoull(token_.c_str(), nullptr, 10);
+            if (errno == 0)
+            {
+                return sax_.number_unsigned(value) && endValue();
+            }
+        }
+    }
+
+    return sax_.number_float(std::strtod(token_.c_str(), nullptr), token_) && endValue();
+}
+
+bool JsonPushParser::endLiteral()
+{
+    bool ok = false;
+    if (token_ == "true")
+    {
+        ok = sax_.boolean(true);
+    }
+    else if (token_ == "false")
+    {
+        ok = sax_.boolean(false);
+    }
+    else if (token_ == "null")
+    {
+        ok = sax_.null();
+    }
+    return ok && endValue();
+}
+
+bool JsonPushParser::endContainer(char open)
+{
+    if (stack_.empty() || stack_.back() != open)
+    {
+        return false;
+    }
+    stack_.pop_back();
+    bool ok = open == '{' ? sax_.end_object() : sax_.end_array();
+    return ok && endValue();
+}
+
+}  // namespace client
+}  // namespace apollo
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "nlohmann/json.hpp"
+
+namespace apollo
+{
+namespace client
+{
+using JsonSax = nlohmann::json_sax<nlohmann::json>;
+
+/**
+ * Incremental JSON parser: the document is pushed in chunks of any size, as they arrive from the network,
+ * and reported to a nlohmann SAX handler as soon as each token is complete. Only the token being lexed
+ * is buffered, never the document.
+ *
+ * Follows RFC 8259 except that strings are not validated as UTF-8, their bytes are passed through.
+ */
+class JsonPushParser
+{
+public:
+    explicit JsonPushParser(JsonSax& sax);
+    ~JsonPushParser() = default;
+
+    // Parses the next chunk. Returns false once the document is invalid or the handler rejected an event,
+    // further chunks are ignored.
+    bool feed(const char* data, std::size_t size);
+
+    // Ends the document. Returns false if it is invalid or incomplete.
+    bool finish();
+
+    inline bool failed() const
+    {
+        return failed_;
+    }
+
+private:
+    JsonPushParser(const JsonPushParser&) = delete;             // Disable copy constructor
+    JsonPushParser& operator=(const JsonPushParser&) = delete;  // Disable assignment operator
+
+    // What the next structural character may be.
+    enum class Expect
+    {
+        Value,
+        FirstValueOrEnd,  // After '['
+        FirstKeyOrEnd,    // After '{'
+        Key,              // After ',' in an object
+        Colon,
+        CommaOrEnd,
+        Done,  // The root value is complete, only whitespace may follow
+    };
+
+    // Token being lexed, possibly across chunks.
+    enum class Lex
+    {
+        None,
+        String,
+        Escape,
+        Unicode,
+        Number,
+        Literal,
+    };
+
+    bool consume(char c);
+    bool beginValue(char c);
+    bool endValue();
+    bool endString();
+    bool endUnicode();
+    bool endNumber();
+    bool endLiteral();
+    bool endContainer(char open);
+
+    JsonSax& sax_;
+    std::vector<char> stack_;  // '{' or '[' of every open container
+    Expect expect_ = Expect::Value;
+    Lex lex_ = Lex::None;
+    std::string token_;
+    bool key_ = false;  // The string being lexed is an object key
+    unsigned unicode_ = 0;
+    int unicode_digits_ = 0;
+    unsigned high_surrogate_ = 0;  // Waiting for the low half of a \u surrogate pair
+    bool failed_ = false;
+};
+
+}  // namespace client
+}  // namespace apollo
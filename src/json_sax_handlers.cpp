@@ -0,0 +1,291 @@
+#include "json_sax_handlers.h"
+#include <limits>
+
+namespace apollo
+{
+namespace client
+{
+
+ConfigsSaxHandler::ConfigsSaxHandler(std::string& release_key, Configures& configures)
+    : release_key_(release_key)
+    , configures_(configures)
+{
+}
+
+ConfigsSaxHandler::ConfigsSaxHandler(ConfigsResponse& response)
+    : ConfigsSaxHandler(response.release_key_, response.configures_)
+{
+}
+
+bool ConfigsSaxHandler::complete() const
+{
+    return has_release_key_ && has_configurations_ && depth_ == 0;
+}
+
+bool ConfigsSaxHandler::null()
+{
+    return scalar();
+}
+
+bool ConfigsSaxHandler::boolean(bool)
+{
+    return scalar();
+}
+
+bool ConfigsSaxHandler::number_integer(number_integer_t)
+{
+    return scalar();
+}
+
+bool ConfigsSaxHandler::number_unsigned(number_unsigned_t)
+{
+    return scalar();
+}
+
+bool ConfigsSaxHandler::number_float(number_float_t, const string_t&)
+{
+    return scalar();
+}
+
+bool ConfigsSaxHandler::binary(binary_t&)
+{
+    return scalar();
+}
+
+bool ConfigsSaxHandler::string(string_t& val)
+{
+    if (in_configurations_)
+    {
+        // Copied rather than moved: the lexer reuses the capacity of its token buffer for the next token.
+        configures_[key_] = val;
+        return true;
+    }
+
+    if (depth_ == 1 && member_ == Member::ReleaseKey)
+    {
+        release_key_ = val;
+        has_release_key_ = true;
+        return true;
+    }
+    return scalar();
+}
+
+bool ConfigsSaxHandler::start_object(std::size_t)
+{
+    if (in_configurations_)
+    {
+        return false;  // Nested value in configurations
+    }
+
+    if (depth_ == 1 && member_ == Member::ReleaseKey)
+    {
+        return false;
+    }
+
+    if (depth_ == 1 && member_ == Member::Configurations)
+    {
+        // A repeated member replaces the previous one, as with a DOM.
+        configures_.clear();
+        in_configurations_ = true;
+        has_configurations_ = true;
+    }
+    ++depth_;
+    return true;
+}
+
+bool ConfigsSaxHandler::key(string_t& val)
+{
+    if (in_configurations_)
+    {
+        key_.assign(val);
+    }
+    else if (depth_ == 1)
+    {
+        member_ = val == "releaseKey"       ? Member::ReleaseKey
+                  : val == "configurations" ? Member::Configurations
+                                            : Member::Other;
+    }
+    return true;
+}
+
+bool ConfigsSaxHandler::end_object()
+{
+    in_configurations_ = false;
+    --depth_;
+    return true;
+}
+
+bool ConfigsSaxHandler::start_array(std::size_t)
+{
+    if (depth_ == 0 || in_configurations_ || (depth_ == 1 && member_ != Member::Other))
+    {
+        return false;
+    }
+    ++depth_;
+    return true;
+}
+
+bool ConfigsSaxHandler::end_array()
+{
+    --depth_;
+    return true;
+}
+
+bool ConfigsSaxHandler::parse_error(std::size_t, const std::string&, const nlohmann::detail::exception&)
+{
+    return false;
+}
+
+bool ConfigsSaxHandler::scalar() const
+{
+    return !in_configurations_ && (depth_ > 1 || (depth_ == 1 && member_ == Member::Other));
+}
+
+NotificationsSaxHandler::NotificationsSaxHandler(Notifications& notifications)
+    : notifications_(notifications)
+{
+}
+
+bool NotificationsSaxHandler::complete() const
+{
+    return complete_;
+}
+
+bool NotificationsSaxHandler::null()
+{
+    return scalar();
+}
+
+bool NotificationsSaxHandler::boolean(bool)
+{
+    return scalar();
+}
+
+bool NotificationsSaxHandler::number_integer(number_integer_t val)
+{
+    return notificationId(val);
+}
+
+bool NotificationsSaxHandler::number_unsigned(number_unsigned_t val)
+{
+    // Ids out of the int range are rejected by notificationId().
+    auto id = val > static_cast<number_unsigned_t>(std::numeric_limits<long long>::max())
+                  ? std::numeric_limits<long long>::max()
+                  : static_cast<long long>(val);
+    return notificationId(id);
+}
+
+bool NotificationsSaxHandler::number_float(number_float_t val, const string_t&)
+{
+    if (depth_ == 2 && member_ == Member::NotificationId)
+    {
+        return notificationId(static_cast<long long>(val));
+    }
+    return scalar();
+}
+
+bool NotificationsSaxHandler::string(string_t& val)
+{
+    if (depth_ == 2 && member_ == Member::NamespaceName)
+    {
+        notification_.namespace_name_ = val;
+        has_namespace_name_ = true;
+        return true;
+    }
+    return scalar();
+}
+
+bool NotificationsSaxHandler::binary(binary_t&)
+{
+    return scalar();
+}
+
+bool NotificationsSaxHandler::start_object(std::size_t)
+{
+    if (depth_ == 0 || (depth_ == 2 && member_ != Member::Other))
+    {
+        return false;
+    }
+
+    if (depth_ == 1)
+    {
+        notification_ = Notification();
+        has_namespace_name_ = false;
+        has_notification_id_ = false;
+        member_ = Member::Other;
+    }
+    ++depth_;
+    return true;
+}
+
+bool NotificationsSaxHandler::key(string_t& val)
+{
+    if (depth_ == 2)
+    {
+        member_ = val == "namespaceName"    ? Member::NamespaceName
+                  : val == "notificationId" ? Member::NotificationId
+                                            : Member::Other;
+    }
+    return true;
+}
+
+bool NotificationsSaxHandler::end_object()
+{
+    if (--depth_ == 1)
+    {
+        if (!has_namespace_name_ || !has_notification_id_)
+        {
+            return false;
+        }
+        notifications_.push_back(std::move(notification_));
+    }
+    return true;
+}
+
+bool NotificationsSaxHandler::start_array(std::size_t)
+{
+    if (depth_ == 0)
+    {
+        notifications_.clear();
+    }
+    else if (depth_ == 1 || (depth_ == 2 && member_ != Member::Other))
+    {
+        return false;
+    }
+    ++depth_;
+    return true;
+}
+
+bool NotificationsSaxHandler::end_array()
+{
+    complete_ = --depth_ == 0;
+    return true;
+}
+
+bool NotificationsSaxHandler::parse_error(std::size_t, const std::string&, const nlohmann::detail::exception&)
+{
+    return false;
+}
+
+bool NotificationsSaxHandler::notificationId(long long val)
+{
+    if (depth_ == 2 && member_ == Member::NotificationId)
+    {
+        if (val < std::numeric_limits<int>::min() || val > std::numeric_limits<int>::max())
+        {
+            return false;
+        }
+        notification_.notification_id_ = static_cast<int>(val);
+        has_notification_id_ = true;
+        return true;
+    }
+    return scalar();
+}
+
+bool NotificationsSaxHandler::scalar() const
+{
+    return depth_ > 2 || (depth_ == 2 && member_ == Member::Other);
+}
+
+}  // namespace client
+}  // namespace apollo
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <string>
+#include "apollo_internal.h"
+#include "json_push_parser.h"
+
+namespace apollo
+{
+namespace client
+{
+/**
+ * Streams a /configs response into its destination without building a DOM:
+ * {"releaseKey": "...", "configurations": {"key": "value", ...}, ...}
+ * Other members are skipped whatever their type, a non-string releaseKey or configuration value fails the parse.
+ */
+class ConfigsSaxHandler : public JsonSax
+{
+public:
+    ConfigsSaxHandler(std::string& release_key, Configures& configures);
+    explicit ConfigsSaxHandler(ConfigsResponse& response);
+
+    // Whether both releaseKey and configurations were found.
+    bool complete() const;
+
+    bool null() override;
+    bool boolean(bool val) override;
+    bool number_integer(number_integer_t val) override;
+    bool number_unsigned(number_unsigned_t val) override;
+    bool number_float(number_float_t val, const string_t& s) override;
+    bool string(string_t& val) override;
+    bool binary(binary_t& val) override;
+    bool start_object(std::size_t elements) override;
+    bool key(string_t& val) override;
+    bool end_object() override;
+    bool start_array(std::size_t elements) override;
+    bool end_array() override;
+    bool parse_error(std::size_t position, const std::string& last_token, const nlohmann::detail::exception& ex) override;
+
+private:
+    enum class Member
+    {
+        Other,
+        ReleaseKey,
+        Configurations,
+    };
+
+    // Scalars are only accepted as skipped members of the root object or inside skipped values.
+    bool scalar() const;
+
+    std::string& release_key_;
+    Configures& configures_;
+    std::string key_;
+    bool in_configurations_ = false;
+    Member member_ = Member::Other;
+    int depth_ = 0;
+    bool has_release_key_ = false;
+    bool has_configurations_ = false;
+};
+
+/**
+ * Streams a /notifications/v2 response into its destination without building a DOM:
+ * [{"namespaceName": "...", "notificationId": 1, ...}, ...]
+ * Other members of the notifications, such as messages, are skipped whatever their type.
+ */
+class NotificationsSaxHandler : public JsonSax
+{
+public:
+    explicit NotificationsSaxHandler(Notifications& notifications);
+
+    // Whether the whole array was read and every notification had a name and an id.
+    bool complete() const;
+
+    bool null() override;
+    bool boolean(bool val) override;
+    bool number_integer(number_integer_t val) override;
+    bool number_unsigned(number_unsigned_t val) override;
+    bool number_float(number_float_t val, const string_t& s) override;
+    bool string(string_t& val) override;
+    bool binary(binary_t& val) override;
+    bool start_object(std::size_t elements) override;
+    bool key(string_t& val) override;
+    bool end_object() override;
+    bool start_array(std::size_t elements) override;
+    bool end_array() override;
+    bool parse_error(std::size_t position, const std::string& last_token, const nlohmann::detail::exception& ex) override;
+
+private:
+    enum class Member
+    {
+        Other,
+        NamespaceName,
+        NotificationId,
+    };
+
+    bool notificationId(long long val);
+    bool scalar() const;
+
+    Notifications& notifications_;
+    Notification notification_;
+    Member member_ = Member::Other;
+    int depth_ = 0;  // 1 inside the array, 2 inside a notification
+    bool has_namespace_name_ = false;
+    bool has_notification_id_ = false;
+    bool complete_ = false;
+};
+
+}  // namespace client
+}  // namespace apollo
@@ -0,0 +1,312 @@
+#include "listener_dispatcher.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <set>
+#include <utility>
+
+namespace apollo
+{
+namespace client
+{
+namespace
+{
+std::chrono::microseconds elapsedSince(std::chrono::steady_clock::time_point start,
+                                       std::chrono::steady_clock::time_point end)
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+}
+}  // namespace
+
+class ListenerDispatcher::Core
+{
+public:
+    explicit Core(bool threaded)
+        : threaded_(threaded)
+    {
+    }
+
+    void dispatch(const void* source,
+                  const NamespaceType& s_namespace,
+                  ConfiguresPtr olds,
+                  ConfiguresPtr news,
+                  Delivery delivery);
+    void flush(const void* source);
+    ListenerMetrics stats() const;
+
+    void setThreads(std::vector<std::thread::id> thread_ids);
+    void stop();
+    void run();
+
+private:
+    using Key = std::pair<const void*, NamespaceType>;
+
+    struct Event
+    {
+        ConfiguresPtr olds_;
+        ConfiguresPtr news_;
+        Delivery delivery_;
+        std::chrono::steady_clock::time_point queued_at_;
+    };
+
+    void deliver(const Key& key, Event& event);
+    bool isDispatcherThread() const;            // mutex_ must be held
+    bool hasPending(const void* source) const;  // mutex_ must be held
+    void dropQueued(const void* source);        // mutex_ must be held
+    // Whether a callback of source runs on another thread, not waiting in flush() itself. mutex_ must be held.
+    bool runsElsewhere(const void* source, std::thread::id self) const;
+
+    const bool threaded_;  // Without thread, events are delivered inline
+    mutable std::mutex mutex_;
+    std::condition_variable ready_cv_;  // An event is ready or the dispatcher stops
+    std::condition_variable idle_cv_;   // A callback returned
+    std::map<Key, Event> queued_;
+    std::deque<Key> ready_;  // Queued events whose namespace is not being delivered, in order
+    std::map<Key, std::thread::id> running_;  // Namespaces being delivered, by the thread delivering them
+    std::set<std::thread::id> flushing_;       // Dispatcher threads waiting in flush()
+    bool stopping_ = false;
+    ListenerMetrics stats_;
+    std::vector<std::thread::id> thread_ids_;
+};
+
+ListenerDispatcher::ListenerDispatcher(int thread_count)
+    : core_(std::make_shared<Core>(thread_count > 0))
+{
+    threads_.reserve(static_cast<std::size_t>(std::max(thread_count, 0)));
+    std::vector<std::thread::id> thread_ids;
+    for (int i = 0; i < thread_count; ++i)
+    {
+        threads_.emplace_back([core = core_]() { core->run(); });
+        thread_ids.push_back(threads_.back().get_id());
+    }
+    core_->setThreads(std::move(thread_ids));
+}
+
+ListenerDispatcher::~ListenerDispatcher()
+{
+    core_->stop();
+
+    for (auto& thread : threads_)
+    {
+        // The last reference may be released by a callback running on one of the threads. That thread is
+        // detached, it returns into the core it shares and only then releases it.
+        if (thread.get_id() == std::this_thread::get_id())
+        {
+            thread.detach();
+        }
+        else if (thread.joinable())
+        {
+            thread.join();
+        }
+    }
+}
+
+void ListenerDispatcher::dispatch(const void* source,
+                                  const NamespaceType& s_namespace,
+                                  ConfiguresPtr olds,
+                                  ConfiguresPtr news,
+                                  Delivery delivery)
+{
+    core_->dispatch(source, s_namespace, std::move(olds), std::move(news), std::move(delivery));
+}
+
+void ListenerDispatcher::flush(const void* source)
+{
+    core_->flush(source);
+}
+
+ListenerMetrics ListenerDispatcher::stats() const
+{
+    return core_->stats();
+}
+
+void ListenerDispatcher::Core::dispatch(const void* source,
+                                        const NamespaceType& s_namespace,
+                                        ConfiguresPtr olds,
+                                        ConfiguresPtr news,
+                                        Delivery delivery)
+{
+    auto now = std::chrono::steady_clock::now();
+    Key key(source, s_namespace);
+    Event event{std::move(olds), std::move(news), std::move(delivery), now};
+
+    if (!threaded_)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            ++stats_.events_;
+        }
+        deliver(key, event);
+        return;
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        ++stats_.events_;
+
+        auto it = queued_.find(key);
+        if (it != queued_.end())
+        {
+            // Keep the configures the listener saw last and the time the oldest change waited since.
+            it->second.news_ = std::move(event.news_);
+            it->second.delivery_ = std::move(event.delivery_);
+            ++stats_.coalesced_;
+            return;
+        }
+
+        queued_.emplace(key, std::move(event));
+        stats_.queue_depth_ = queued_.size();
+        stats_.max_queue_depth_ = std::max(stats_.max_queue_depth_, stats_.queue_depth_);
+
+        // A namespace being delivered is made ready again once its callback returned.
+        if (running_.count(key) != 0)
+        {
+            return;
+        }
+        ready_.push_back(std::move(key));
+    }
+    ready_cv_.notify_one();
+}
+
+void ListenerDispatcher::Core::flush(const void* source)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (isDispatcherThread())
+    {
+        // The callback calling flush() cannot wait for itself: the events of source still queued are dropped,
+        // and only its callbacks running on the other threads are waited for. Callbacks flushing each other
+        // are not waited for either, they would deadlock.
+        dropQueued(source);
+        auto self = std::this_thread::get_id();
+        flushing_.insert(self);
+        idle_cv_.notify_all();
+        idle_cv_.wait(lock, [this, source, self]() { return !runsElsewhere(source, self); });
+        flushing_.erase(self);
+        return;
+    }
+    idle_cv_.wait(lock, [this, source]() { return !hasPending(source); });
+}
+
+ListenerMetrics ListenerDispatcher::Core::stats() const
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void ListenerDispatcher::Core::setThreads(std::vector<std::thread::id> thread_ids)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    thread_ids_ = std::move(thread_ids);
+}
+
+void ListenerDispatcher::Core::stop()
+{
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    ready_cv_.notify_all();
+}
+
+void ListenerDispatcher::Core::run()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true)
+    {
+        ready_cv_.wait(lock, [this]() { return stopping_ || !ready_.empty(); });
+        if (stopping_)
+        {
+            return;
+        }
+
+        Key key = std::move(ready_.front());
+        ready_.pop_front();
+        auto it = queued_.find(key);
+        if (it == queued_.end() || running_.count(key) != 0)
+        {
+            continue;
+        }
+
+        Event event = std::move(it->second);
+        queued_.erase(it);
+        stats_.queue_depth_ = queued_.size();
+        running_.emplace(key, std::this_thread::get_id());
+
+        lock.unlock();
+        deliver(key, event);
+        event = Event();  // Its delivery may hold the last reference to the dispatcher, released out of the lock
+        lock.lock();
+
+        running_.erase(key);
+        if (queued_.count(key) != 0)
+        {
+            ready_.push_back(key);
+            ready_cv_.notify_one();
+        }
+        idle_cv_.notify_all();
+    }
+}
+
+void ListenerDispatcher::Core::deliver(const Key& key, Event& event)
+{
+    auto started = std::chrono::steady_clock::now();
+    event.delivery_(key.second, *event.olds_, *event.news_);
+    auto finished = std::chrono::steady_clock::now();
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    ++stats_.callbacks_;
+    stats_.last_delivery_latency_ = elapsedSince(event.queued_at_, started);
+    stats_.max_delivery_latency_ = std::max(stats_.max_delivery_latency_, stats_.last_delivery_latency_);
+    stats_.last_callback_duration_ = elapsedSince(started, finished);
+    stats_.max_callback_duration_ = std::max(stats_.max_callback_duration_, stats_.last_callback_duration_);
+}
+
+bool ListenerDispatcher::Core::isDispatcherThread() const
+{
+    auto id = std::this_thread::get_id();
+    return std::find(thread_ids_.begin(), thread_ids_.end(), id) != thread_ids_.end();
+}
+
+bool ListenerDispatcher::Core::hasPending(const void* source) const
+{
+    auto queued = queued_.lower_bound(Key(source, NamespaceType()));
+    if (queued != queued_.end() && queued->first.first == source)
+    {
+        return true;
+    }
+    return std::any_of(running_.begin(),
+                       running_.end(),
+                       [source](const std::pair<const Key, std::thread::id>& running)
+                       { return running.first.first == source; });
+}
+
+bool ListenerDispatcher::Core::runsElsewhere(const void* source, std::thread::id self) const
+{
+    return std::any_of(running_.begin(),
+                       running_.end(),
+                       [this, source, self](const std::pair<const Key, std::thread::id>& running)
+                       {
+                           return running.first.first == source && running.second != self &&
+                                  flushing_.count(running.second) == 0;
+                       });
+}
+
+void ListenerDispatcher::Core::dropQueued(const void* source)
+{
+    auto first = queued_.lower_bound(Key(source, NamespaceType()));
+    auto last = first;
+    while (last != queued_.end() && last->first.first == source)
+    {
+        ++last;
+    }
+    queued_.erase(first, last);
+    ready_.erase(std::remove_if(ready_.begin(), ready_.end(), [source](const Key& key) { return key.first == source; }),
+                 ready_.end());
+    stats_.queue_depth_ = queued_.size();
+}
+
+}  // namespace client
+}  // namespace apollo
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "apollo/apollo_types.h"
+
+namespace apollo
+{
+namespace client
+{
+/**
+ * Runs the notification callbacks on threads of its own, off the polling thread.
+ *
+ * At most one event per source and namespace is queued: a change published while the previous one of the
+ * namespace is still queued is merged into it, and the callback sees the older configures against the newer
+ * ones. The queue is thus bounded by the number of namespaces, and a listener falling behind skips intermediate
+ * releases instead of accumulating them. The events of a namespace are delivered in order, never concurrently.
+ * With no thread, events are delivered inline by dispatch(). Thread-safe.
+ */
+class ListenerDispatcher
+{
+public:
+    using Delivery =
+        std::function<void(const NamespaceType& s_namespace, const Configures& olds, const Configures& news)>;
+
+    explicit ListenerDispatcher(int thread_count);
+    ~ListenerDispatcher();  // Events still queued are dropped
+
+    // Queues the change of s_namespace from olds to news, source tells the clients sharing the dispatcher apart.
+    void dispatch(const void* source,
+                  const NamespaceType& s_namespace,
+                  ConfiguresPtr olds,
+                  ConfiguresPtr news,
+                  Delivery delivery);
+
+    // Waits until the events of source queued so far were delivered. Called from a callback, the events
+    // of source still queued are dropped instead, and only the callbacks of source running on the other
+    // threads are waited for, except those waiting in flush() themselves.
+    void flush(const void* source);
+
+    ListenerMetrics stats() const;
+
+private:
+    ListenerDispatcher(const ListenerDispatcher&) = delete;             // Disable copy constructor
+    ListenerDispatcher& operator=(const ListenerDispatcher&) = delete;  // Disable assignment operator
+
+    // The queue and the stats, shared with the threads: the last reference to the dispatcher may be released
+    // by a callback, on a thread that then returns into the queue.
+    class Core;
+
+    std::shared_ptr<Core> core_;
+    std::vector<std::thread> threads_;
+};
+
+}  // namespace client
+}  // namespace apollo
@@ -0,0 +1,153 @@
+#include "listener_registry.h"
+#include <algorithm>
+#include "apollo_utility.h"
+
+namespace apollo
+{
+namespace client
+{
+ListenerRegistry::ListenerRegistry()
+    : index_(std::make_shared<const Index>())
+{
+}
+
+ListenerId ListenerRegistry::add(const NamespaceType& s_namespace,
+                                 const std::string& key,
+                                 KeyMatch match,
+                                 NotificationCallbackPtr callback)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    Listener listener{next_id_++, std::move(callback)};
+
+    auto index = std::make_shared<Index>(*index_.load());
+    auto& root = (*index)[s_namespace];
+    root = update(root, key, 0, match, listener, true);
+    registrations_.emplace(listener.id_, Registration{s_namespace, key, match});
+
+    index_.store(std::move(index));
+    return listener.id_;
+}
+
+bool ListenerRegistry::remove(ListenerId id)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto it = registrations_.find(id);
+    if (it == registrations_.end())
+    {
+        return false;
+    }
+
+    const auto& registration = it->second;
+    auto index = std::make_shared<Index>(*index_.load());
+    auto root = index->find(registration.namespace_);
+    root->second = update(root->second, registration.key_, 0, registration.match_, Listener{id, {}}, false);
+    if (!root->second)
+    {
+        index->erase(root);
+    }
+    registrations_.erase(it);
+
+    index_.store(std::move(index));
+    return true;
+}
+
+void ListenerRegistry::notify(const NamespaceType& s_namespace,
+                              const Configures& olds,
+                              const Configures& news,
+                              const Changes& changes) const
+{
+    auto index = index_.load();
+    auto root = index->find(s_namespace);
+    if (root == index->end())
+    {
+        return;
+    }
+
+    // Changes matched per listener, called in the order they were registered.
+    std::map<ListenerId, std::pair<const Listener*, Changes>> matched;
+    auto match = [&matched](const std::vector<Listener>& listeners, const Change& change)
+    {
+        for (const auto& listener : listeners)
+        {
+            auto& entry = matched[listener.id_];
+            entry.first = &listener;
+            entry.second.push_back(change);
+        }
+    };
+
+    for (const auto& change : changes)
+    {
+        const Node* node = root->second.get();
+        std::size_t depth = 0;
+        while (node != nullptr)
+        {
+            match(node->prefix_listeners_, change);
+            if (depth == change.key_.size())
+            {
+                match(node->exact_listeners_, change);
+                break;
+            }
+
+            auto child = node->children_.find(change.key_[depth++]);
+            node = child == node->children_.end() ? nullptr : child->second.get();
+        }
+    }
+
+    for (auto& entry : matched)
+    {
+        auto callback = entry.second.first->callback_.lock();
+        if (callback)
+        {
+            safeCall(*callback, s_namespace, olds, news, std::move(entry.second.second));
+        }
+    }
+}
+
+bool ListenerRegistry::listens(const NamespaceType& s_namespace) const
+{
+    auto index = index_.load();
+    return index->count(s_namespace) != 0;
+}
+
+ListenerRegistry::NodePtr ListenerRegistry::update(const NodePtr& node,
+                                                   const std::string& key,
+                                                   std::size_t depth,
+                                                   KeyMatch match,
+                                                   const Listener& listener,
+                                                   bool adding)
+{
+    auto copy = node ? std::make_shared<Node>(*node) : std::make_shared<Node>();
+    if (depth == key.size())
+    {
+        auto& listeners = match == KeyMatch::Prefix ? copy->prefix_listeners_ : copy->exact_listeners_;
+        if (adding)
+        {
+            listeners.push_back(listener);
+        }
+        else
+        {
+            listeners.erase(std::remove_if(listeners.begin(),
+                                           listeners.end(),
+                                           [&listener](const Listener& l) { return l.id_ == listener.id_; }),
+                            listeners.end());
+        }
+    }
+    else
+    {
+        auto& child = copy->children_[key[depth]];
+        child = update(child, key, depth + 1, match, listener, adding);
+        if (!child)
+        {
+            copy->children_.erase(key[depth]);
+        }
+    }
+
+    if (copy->empty())
+    {
+        return nullptr;
+    }
+    return copy;
+}
+
+}  // namespace client
+}  // namespace apollo
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "apollo/apollo_client.h"
+#include "apollo/apollo_types.h"
+#include "atomic_shared_ptr.h"
+
+namespace apollo
+{
+namespace client
+{
+/**
+ * Listeners of the changes of a namespace, each scoped to a key, a key prefix or every key.
+ *
+ * The listeners of a namespace are indexed by a trie of their keys, so notifying costs the length of the
+ * changed keys plus the number of listeners matched, whatever the number registered. The tries are immutable
+ * and replaced copy-on-write by add() and remove(), sharing the branches they did not change: notify() only
+ * loads the current index, without lock, and never waits for a registration.
+ */
+class ListenerRegistry
+{
+public:
+    ListenerRegistry();
+
+    ListenerId add(const NamespaceType& s_namespace,
+                   const std::string& key,
+                   KeyMatch match,
+                   NotificationCallbackPtr callback);
+
+    // False if the id is unknown, e.g. already removed.
+    bool remove(ListenerId id);
+
+    // Calls every listener of s_namespace matching at least one change, with the changes it matches.
+    void notify(const NamespaceType& s_namespace,
+                const Configures& olds,
+                const Configures& news,
+                const Changes& changes) const;
+
+    // Whether a listener is registered for s_namespace.
+    bool listens(const NamespaceType& s_namespace) const;
+
+private:
+    ListenerRegistry(const ListenerRegistry&) = delete;             // Disable copy constructor
+    ListenerRegistry& operator=(const ListenerRegistry&) = delete;  // Disable assignment operator
+
+    struct Listener
+    {
+        ListenerId id_;
+        NotificationCallbackPtr callback_;
+    };
+
+    struct Node;
+    using NodePtr = std::shared_ptr<const Node>;
+
+    struct Node
+    {
+        std::map<char, NodePtr> children_;
+        std::vector<Listener> prefix_listeners_;  // Listeners of the keys starting with the path to the node
+        std::vector<Listener> exact_listeners_;   // Listeners of the key equal to the path to the node
+
+        bool empty() const
+        {
+            return children_.empty() && prefix_listeners_.empty() && exact_listeners_.empty();
+        }
+    };
+
+    using Index = std::map<NamespaceType, NodePtr>;
+
+    struct Registration
+    {
+        NamespaceType namespace_;
+        std::string key_;
+        KeyMatch match_;
+    };
+
+    // Copies node and its descendants along the path of key, with listener added or removed there.
+    // The other branches are shared with node. Returns nullptr for a node left empty.
+    static NodePtr update(const NodePtr& node,
+                          const std::string& key,
+                          std::size_t depth,
+                          KeyMatch match,
+                          const Listener& listener,
+                          bool adding);
+
+    AtomicSharedPtr<const Index> index_;
+
+    std::mutex mutex_;  // Serializes add() and remove()
+    ListenerId next_id_ = 1;
+    std::map<ListenerId, Registration> registrations_;
+};
+
+}  // namespace client
+}  // namespace apollo
@@ -0,0 +1,71 @@
+#include "parsed_value_cache.h"
+
+namespace apollo
+{
+namespace client
+{
+ParsedValueCache::ParsedValueCache(std::size_t slot_count)
+    : slot_count_(slot_count)
+    , slots_(new std::atomic<const Entry*>[slot_count])
+{
+    for (std::size_t i = 0; i < slot_count_; ++i)
+    {
+        slots_[i].store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+ParsedValueCache::~ParsedValueCache()
+{
+    for (std::size_t i = 0; i < slot_count_; ++i)
+    {
+        const Entry* entry = slots_[i].load(std::memory_order_relaxed);
+        while (entry != nullptr)
+        {
+            const Entry* next = entry->next_;
+            delete entry;
+            entry = next;
+        }
+    }
+}
+
+const ParsedValuePtr& ParsedValueCache::get(std::size_t slot,
+                                            std::type_index type,
+                                            const std::string& value,
+                                            ValueParseFunction parse)
+{
+    auto& head = slots_[slot];
+    const Entry* first = head.load(std::memory_order_acquire);
+    const Entry* found = find(first, type);
+    if (found != nullptr)
+    {
+        return found->value_;
+    }
+
+    // Concurrent first reads may parse twice, only the entry published first is kept.
+    auto* entry = new Entry{type, parse(value), first};
+    while (!head.compare_exchange_weak(entry->next_, entry, std::memory_order_acq_rel, std::memory_order_acquire))
+    {
+        found = find(entry->next_, type);
+        if (found != nullptr)
+        {
+            delete entry;
+            return found->value_;
+        }
+    }
+    return entry->value_;
+}
+
+const ParsedValueCache::Entry* ParsedValueCache::find(const Entry* head, std::type_index type)
+{
+    for (const Entry* entry = head; entry != nullptr; entry = entry->next_)
+    {
+        if (entry->type_ == type)
+        {
+            return entry;
+        }
+    }
+    return nullptr;
+}
+
+}  // namespace client
+}  // namespace apollo
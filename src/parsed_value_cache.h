@@ -0,0 +1,48 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <typeindex>
+#include "apollo/apollo_value_parser.h"
+
+namespace apollo
+{
+namespace client
+{
+/**
+ * Typed values parsed out of one immutable release, by slot of its ConfiguresIndex and type.
+ *
+ * A value is parsed on its first read as a type and kept for the life of the release, a new release starts
+ * with an empty cache. Reads of a cached value take no lock and do not allocate: each slot holds a list of the
+ * types parsed so far, prepended to with a compare-and-swap. Invalid values are cached as nullptr.
+ */
+class ParsedValueCache
+{
+public:
+    explicit ParsedValueCache(std::size_t slot_count);
+    ~ParsedValueCache();
+
+    // Returns the value of slot parsed as type, parsed with parse on the first read.
+    const ParsedValuePtr& get(std::size_t slot, std::type_index type, const std::string& value, ValueParseFunction parse);
+
+private:
+    ParsedValueCache(const ParsedValueCache&) = delete;             // Disable copy constructor
+    ParsedValueCache& operator=(const ParsedValueCache&) = delete;  // Disable assignment operator
+
+    struct Entry
+    {
+        std::type_index type_;
+        ParsedValuePtr value_;
+        const Entry* next_;
+    };
+
+    static const Entry* find(const Entry* head, std::type_index type);
+
+    std::size_t slot_count_;
+    std::unique_ptr<std::atomic<const Entry*>[]> slots_;
+};
+
+}  // namespace client
+}  // namespace apollo
@@ -0,0 +1,211 @@
+#include <locale>
+#include <sstream>
+#include "apollo/apollo_client.h"
+
+namespace apollo
+{
+namespace client
+{
+namespace
+{
+constexpr double microseconds_per_second = 1e6;
+
+class PrometheusWriter
+{
+public:
+    explicit PrometheusWriter(const std::map<std::string, std::string>& labels)
+    {
+        out_.imbue(std::locale::classic());
+        out_.precision(9);
+        for (const auto& label : labels)
+        {
+            labels_ += (labels_.empty() ? "" : ",") + label.first + "=\"" + escape(label.second) + "\"";
+        }
+    }
+
+    void header(const std::string& name, const std::string& type, const std::string& help)
+    {
+        out_ << "# HELP " << name << ' ' << help << "\n# TYPE " << name << ' ' << type << '\n';
+    }
+
+    void sample(const std::string& name, const std::string& labels, double value)
+    {
+        out_ << name;
+        if (!labels_.empty() || !labels.empty())
+        {
+            out_ << '{' << labels_ << (labels_.empty() || labels.empty() ? "" : ",") << labels << '}';
+        }
+        out_ << ' ' << value << '\n';
+    }
+
+    void counter(const std::string& name, const std::string& help, double value)
+    {
+        header(name, "counter", help);
+        sample(name, "", value);
+    }
+
+    void gauge(const std::string& name, const std::string& help, double value)
+    {
+        header(name, "gauge", help);
+        sample(name, "", value);
+    }
+
+    // scale converts the recorded unit to the exported one, e.g. microseconds to seconds.
+    void histogram(const std::string& name, const std::string& help, const HistogramMetrics& histogram, double scale)
+    {
+        header(name, "histogram", help);
+        std::uint64_t cumulative = 0;
+        for (std::size_t i = 0; i < histogram.bounds_.size(); ++i)
+        {
+            cumulative += i < histogram.counts_.size() ? histogram.counts_[i] : 0;
+            std::ostringstream le;
+            le.imbue(std::locale::classic());
+            le.precision(9);
+            le << static_cast<double>(histogram.bounds_[i]) / scale;
+            sample(name + "_bucket", "le=\"" + le.str() + "\"", static_cast<double>(cumulative));
+        }
+        sample(name + "_bucket", "le=\"+Inf\"", static_cast<double>(histogram.count_));
+        sample(name + "_sum", "", static_cast<double>(histogram.sum_) / scale);
+        sample(name + "_count", "", static_cast<double>(histogram.count_));
+    }
+
+    void failures(const std::string& name, const std::string& help, const FailureMetrics& long_poll, const FailureMetrics& fetch)
+    {
+        header(name, "counter", help);
+        for (const auto& request : {std::make_pair("long_poll", &long_poll), std::make_pair("fetch", &fetch)})
+        {
+            std::string prefix = std::string("request=\"") + request.first + "\",cause=";
+            sample(name, prefix + "\"timeout\"", static_cast<double>(request.second->timeouts_));
+            sample(name, prefix + "\"network\"", static_cast<double>(request.second->network_errors_));
+            sample(name, prefix + "\"http\"", static_cast<double>(request.second->http_errors_));
+            sample(name, prefix + "\"parse\"", static_cast<double>(request.second->parse_errors_));
+        }
+    }
+
+    void staleness(const std::string& name, const std::string& help, const std::map<NamespaceType, std::chrono::milliseconds>& ages)
+    {
+        header(name, "gauge", help);
+        for (const auto& age : ages)
+        {
+            sample(name, "namespace=\"" + escape(age.first) + "\"", static_cast<double>(age.second.count()) / 1000.0);
+        }
+    }
+
+    std::string str() const
+    {
+        return out_.str();
+    }
+
+private:
+    static std::string escape(const std::string& value)
+    {
+        std::string escaped;
+        escaped.reserve(value.size());
+        for (char c : value)
+        {
+            if (c == '\\' || c == '"')
+            {
+                escaped += '\\';
+                escaped += c;
+            }
+            else if (c == '\n')
+            {
+                escaped += "\\n";
+            }
+            else
+            {
+                escaped += c;
+            }
+        }
+        return escaped;
+    }
+
+    std::ostringstream out_;
+    std::string labels_;
+};
+}  // namespace
+
+std::string formatPrometheusMetrics(const ClientMetrics& metrics, const std::map<std::string, std::string>& labels)
+{
+    PrometheusWriter writer(labels);
+    writer.histogram("apollo_client_long_poll_duration_seconds",
+                     "Round trip of the long polls, including the time the server held them.",
+                     metrics.long_poll_latency_,
+                     microseconds_per_second);
+    writer.histogram("apollo_client_fetch_duration_seconds",
+                     "Round trip of the configurations fetches.",
+                     metrics.fetch_latency_,
+                     microseconds_per_second);
+    writer.histogram("apollo_client_parse_duration_seconds",
+                     "Time spent parsing each response body.",
+                     metrics.parse_time_,
+                     microseconds_per_second);
+    writer.histogram("apollo_client_response_size_bytes",
+                     "Size of each response body once decoded.",
+                     metrics.payload_size_,
+                     1.0);
+    writer.histogram("apollo_client_propagation_delay_seconds",
+                     "From the long poll response to the publication of each changed namespace.",
+                     metrics.propagation_delay_,
+                     microseconds_per_second);
+    writer.failures("apollo_client_request_failures_total",
+                    "Failed requests by request and cause.",
+                    metrics.long_poll_failures_,
+                    metrics.fetch_failures_);
+    writer.staleness("apollo_client_namespace_staleness_seconds",
+                     "Time since the server last confirmed the release of the namespace is current.",
+                     metrics.staleness_);
+
+    writer.counter("apollo_client_long_polling_cycles_total",
+                   "Long polling cycles completed.",
+                   static_cast<double>(metrics.long_polling_.cycles_));
+    writer.counter("apollo_client_namespaces_published_total",
+                   "Namespaces published by long polling.",
+                   static_cast<double>(metrics.long_polling_.namespaces_published_));
+    writer.gauge("apollo_client_long_polling_shards",
+                 "Concurrent long polls the namespaces are split into.",
+                 static_cast<double>(metrics.long_polling_.shards_));
+    writer.counter("apollo_client_refreshes_total",
+                   "Consistency refreshes completed.",
+                   static_cast<double>(metrics.long_polling_.refreshes_));
+    writer.counter("apollo_client_refreshes_published_total",
+                   "Refreshes that published a release missed by long polling.",
+                   static_cast<double>(metrics.long_polling_.refreshes_published_));
+    writer.counter("apollo_client_responses_total",
+                   "Responses received.",
+                   static_cast<double>(metrics.transfer_.responses_));
+    writer.counter("apollo_client_compressed_responses_total",
+                   "Responses received compressed.",
+                   static_cast<double>(metrics.transfer_.compressed_responses_));
+    writer.counter("apollo_client_response_wire_bytes_total",
+                   "Bytes of the response bodies as received.",
+                   static_cast<double>(metrics.transfer_.wire_bytes_));
+    writer.counter("apollo_client_resolver_hits_total",
+                   "Host name lookups served from the cache.",
+                   static_cast<double>(metrics.resolver_.hits_));
+    writer.counter("apollo_client_resolver_misses_total",
+                   "Host name lookups that waited for the resolver.",
+                   static_cast<double>(metrics.resolver_.misses_));
+    writer.counter("apollo_client_resolver_refreshes_total",
+                   "Resolutions of expired host names started.",
+                   static_cast<double>(metrics.resolver_.refreshes_));
+    writer.counter("apollo_client_resolver_refresh_failures_total",
+                   "Refreshes of host names that failed, the expired addresses were kept.",
+                   static_cast<double>(metrics.resolver_.refresh_failures_));
+    writer.counter("apollo_client_listener_events_total",
+                   "Changes published to the listeners.",
+                   static_cast<double>(metrics.listener_.events_));
+    writer.counter("apollo_client_listener_coalesced_total",
+                   "Changes merged into one still queued for the listeners.",
+                   static_cast<double>(metrics.listener_.coalesced_));
+    writer.gauge("apollo_client_listener_queue_depth",
+                 "Changes queued for the listeners.",
+                 static_cast<double>(metrics.listener_.queue_depth_));
+    writer.gauge("apollo_client_listener_delivery_latency_max_seconds",
+                 "Highest time a change waited for its listener callback.",
+                 static_cast<double>(metrics.listener_.max_delivery_latency_.count()) / microseconds_per_second);
+    return writer.str();
+}
+
+}  // namespace client
+}  // namespace apollo
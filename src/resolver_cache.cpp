@@ -0,0 +1,187 @@
+#include "resolver_cache.h"
+#include <algorithm>
+
+namespace apollo
+{
+namespace client
+{
+using tcp = boost::asio::ip::tcp;
+
+// Delay before a failed background refresh is attempted again.
+static constexpr auto refresh_retry_interval = std::chrono::milliseconds(1000);
+
+ResolverCache::ResolverCache(boost::asio::io_context& io_context, int ttl_ms)
+    : io_context_(io_context)
+    , ttl_(ttl_ms > 0 ? ttl_ms : 0)
+{
+}
+
+ResolverCache::Results ResolverCache::resolve(const std::string& host,
+                                              const std::string& port,
+                                              boost::system::error_code& ec)
+{
+    std::string key = host + ":" + port;
+    Results results;
+    bool expired = false;
+    if (lookup(key, results, expired))
+    {
+        ec = {};
+        if (expired)
+        {
+            refreshes_.fetch_add(1, std::memory_order_relaxed);
+            boost::system::error_code refresh_ec;
+            tcp::resolver resolver(io_context_);
+            auto refreshed = resolver.resolve(host, port, refresh_ec);
+            if (!refresh_ec && !refreshed.empty())
+            {
+                store(key, refreshed);
+                return refreshed;
+            }
+            refreshFailed(key);
+        }
+        return results;
+    }
+
+    misses_.fetch_add(1, std::memory_order_relaxed);
+    tcp::resolver resolver(io_context_);
+    results = resolver.resolve(host, port, ec);
+    if (!ec)
+    {
+        store(key, results);
+    }
+    return results;
+}
+
+void ResolverCache::asyncResolve(const std::string& host, const std::string& port, ResolveHandler handler)
+{
+    std::string key = host + ":" + port;
+    Results results;
+    bool expired = false;
+    if (lookup(key, results, expired))
+    {
+        if (expired)
+        {
+            refresh(host, port);
+        }
+        handler({}, results);
+        return;
+    }
+
+    misses_.fetch_add(1, std::memory_order_relaxed);
+    auto resolver = std::make_shared<tcp::resolver>(io_context_);
+    std::weak_ptr<ResolverCache> weak_this = shared_from_this();
+    resolver->async_resolve(host,
+                            port,
+                            [weak_this, resolver, key, handler](boost::system::error_code ec, Results results)
+                            {
+                                auto shared_this = weak_this.lock();
+                                if (!ec && shared_this)
+                                {
+                                    shared_this->store(key, results);
+                                }
+                                handler(ec, results);
+                            });
+}
+
+void ResolverCache::expire(const std::string& host, const std::string& port)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto it = entries_.find(host + ":" + port);
+    if (it != entries_.end())
+    {
+        it->second.expires_at_ = std::chrono::steady_clock::time_point::min();
+    }
+}
+
+ResolverMetrics ResolverCache::stats() const
+{
+    ResolverMetrics stats;
+    stats.hits_ = hits_.load(std::memory_order_relaxed);
+    stats.misses_ = misses_.load(std::memory_order_relaxed);
+    stats.refreshes_ = refreshes_.load(std::memory_order_relaxed);
+    stats.refresh_failures_ = refresh_failures_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+bool ResolverCache::lookup(const std::string& key, Results& results, bool& refresh)
+{
+    if (ttl_.count() == 0)
+    {
+        return false;
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        auto it = entries_.find(key);
+        if (it == entries_.end())
+        {
+            return false;
+        }
+
+        results = it->second.results_;
+        if (it->second.expires_at_ <= std::chrono::steady_clock::now() && !it->second.refreshing_)
+        {
+            it->second.refreshing_ = true;
+            refresh = true;
+        }
+    }
+
+    hits_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void ResolverCache::store(const std::string& key, const Results& results)
+{
+    if (ttl_.count() == 0)
+    {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    Entry& entry = entries_[key];
+    entry.results_ = results;
+    entry.expires_at_ = std::chrono::steady_clock::now() + ttl_;
+    entry.refreshing_ = false;
+}
+
+void ResolverCache::refresh(const std::string& host, const std::string& port)
+{
+    refreshes_.fetch_add(1, std::memory_order_relaxed);
+    auto resolver = std::make_shared<tcp::resolver>(io_context_);
+    std::weak_ptr<ResolverCache> weak_this = shared_from_this();
+    std::string key = host + ":" + port;
+    resolver->async_resolve(host,
+                            port,
+                            [weak_this, resolver, key](boost::system::error_code ec, Results results)
+                            {
+                                auto shared_this = weak_this.lock();
+                                if (!shared_this)
+                                {
+                                    return;
+                                }
+
+                                if (!ec && !results.empty())
+                                {
+                                    shared_this->store(key, results);
+                                    return;
+                                }
+
+                                shared_this->refreshFailed(key);
+                            });
+}
+
+void ResolverCache::refreshFailed(const std::string& key)
+{
+    // Keep serving the last-known-good addresses, retry on a lookup once the retry interval elapsed.
+    refresh_failures_.fetch_add(1, std::memory_order_relaxed);
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto it = entries_.find(key);
+    if (it != entries_.end())
+    {
+        it->second.refreshing_ = false;
+        it->second.expires_at_ = std::chrono::steady_clock::now() + std::min(ttl_, refresh_retry_interval);
+    }
+}
+
+}  // namespace client
+}  // namespace apollo
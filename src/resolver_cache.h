@@ -0,0 +1,78 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <boost/asio.hpp>
+#include "apollo/apollo_types.h"
+
+namespace apollo
+{
+namespace client
+{
+/**
+ * Caches host name resolutions for ttl_ms.
+ *
+ * An expired entry found by asyncResolve() keeps being served while it is refreshed in the background on
+ * the io_context. resolve() may be called where nothing runs the io_context, e.g. by the synchronous
+ * requests of a client that does not poll, so it refreshes an expired entry inline. Either way an entry
+ * stays in use (last-known-good) for as long as its refresh fails. A ttl of 0 disables the cache, every
+ * lookup is resolved.
+ * Thread-safe, must be owned by a std::shared_ptr, see ResolverCachePtr.
+ */
+class ResolverCache : public std::enable_shared_from_this<ResolverCache>
+{
+public:
+    using Results = boost::asio::ip::tcp::resolver::results_type;
+    using ResolveHandler = std::function<void(boost::system::error_code ec, Results results)>;
+
+    ResolverCache(boost::asio::io_context& io_context, int ttl_ms = 60000);
+    ~ResolverCache() = default;
+
+    // Blocking lookup for the synchronous request path, an expired entry is refreshed before it returns.
+    Results resolve(const std::string& host, const std::string& port, boost::system::error_code& ec);
+
+    // Non-blocking lookup, handler is called on the io_context (or inline on a cache hit).
+    void asyncResolve(const std::string& host, const std::string& port, ResolveHandler handler);
+
+    // Marks the entry as expired, e.g. after connecting to its addresses failed, so it is refreshed.
+    void expire(const std::string& host, const std::string& port);
+
+    ResolverMetrics stats() const;
+
+private:
+    ResolverCache(const ResolverCache&) = delete;             // Disable copy constructor
+    ResolverCache& operator=(const ResolverCache&) = delete;  // Disable assignment operator
+
+    struct Entry
+    {
+        Results results_;
+        std::chrono::steady_clock::time_point expires_at_;
+        bool refreshing_ = false;
+    };
+
+    // Returns true and the cached results if present, and whether the caller is to refresh the expired entry.
+    bool lookup(const std::string& key, Results& results, bool& refresh);
+    void store(const std::string& key, const Results& results);
+    void refresh(const std::string& host, const std::string& port);
+    void refreshFailed(const std::string& key);  // Keeps the expired entry, retried after a while
+
+    boost::asio::io_context& io_context_;
+    const std::chrono::milliseconds ttl_;
+    mutable std::mutex mutex_;
+    std::map<std::string, Entry> entries_;
+    std::atomic<std::uint64_t> hits_{0};
+    std::atomic<std::uint64_t> misses_{0};
+    std::atomic<std::uint64_t> refreshes_{0};
+    std::atomic<std::uint64_t> refresh_failures_{0};
+};
+
+using ResolverCachePtr = std::shared_ptr<ResolverCache>;
+
+}  // namespace client
+}  // namespace apollo
@@ -0,0 +1,286 @@
+#include "snapshot_cache.h"
+#include <cctype>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <random>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <fcntl.h>
+#include <unistd.h>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include "frozen_configures.h"
+
+namespace apollo
+{
+namespace client
+{
+namespace
+{
+constexpr char snapshot_magic[4] = {'A', 'P', 'S', 'C'};
+constexpr std::uint32_t snapshot_version = 1;
+
+// Followed by entry_count_ FrozenConfigures::Entry, the release key and the arena.
+struct SnapshotHeader
+{
+    char magic_[4];
+    std::uint32_t version_;
+    std::int64_t notification_id_;
+    std::uint32_t release_key_size_;
+    std::uint32_t entry_count_;
+    std::uint64_t arena_size_;
+};
+static_assert(sizeof(SnapshotHeader) == 32, "snapshot header must not be padded");
+static_assert(sizeof(FrozenConfigures::Entry) == 16, "snapshot entry must not be padded");
+
+std::string encodeFileName(const std::string& s)
+{
+    static const char hex[] = "0123456789ABCDEF";
+    std::string out;
+    out.reserve(s.size());
+    for (unsigned char c : s)
+    {
+        if (std::isalnum(c) || c == '.' || c == '-' || c == '_')
+        {
+            out += static_cast<char>(c);
+        }
+        else
+        {
+            out += '%';
+            out += hex[c >> 4];
+            out += hex[c & 0x0F];
+        }
+    }
+    return out;
+}
+
+bool inArena(std::uint64_t offset, std::uint64_t size, std::uint64_t arena_size)
+{
+    return offset <= arena_size && size <= arena_size - offset;
+}
+
+bool writeAll(int fd, const void* data, std::size_t size)
+{
+    const auto* p = static_cast<const char*>(data);
+    while (size > 0)
+    {
+        auto n = ::write(fd, p, size);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return false;
+        }
+        p += n;
+        size -= static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+// The rename of a file is only durable once its directory is synced.
+bool syncDirectory(const std::string& dir)
+{
+    int fd = ::open(dir.empty() ? "." : dir.c_str(), O_RDONLY | O_DIRECTORY);
+    if (fd < 0)
+    {
+        return false;
+    }
+    bool synced = ::fsync(fd) == 0;
+    ::close(fd);
+    return synced;
+}
+}  // namespace
+
+SnapshotCache::SnapshotCache(const std::string& cache_dir,
+                             const std::string& app_id,
+                             const std::string& cluster_name,
+                             const std::string& label)
+    : cache_dir_(cache_dir)
+    , file_prefix_(encodeFileName(app_id) + "+" + encodeFileName(cluster_name) + "+" + encodeFileName(label) + "+")
+{
+    if (!cache_dir_.empty() && cache_dir_.back() != '/')
+    {
+        cache_dir_ += '/';
+    }
+}
+
+std::string SnapshotCache::path(const NamespaceType& s_namespace) const
+{
+    return cache_dir_ + file_prefix_ + encodeFileName(s_namespace) + ".snapshot";
+}
+
+bool SnapshotCache::load(const NamespaceType& s_namespace, Snapshot& snapshot) const
+{
+    namespace bip = boost::interprocess;
+
+    bip::mapped_region region;
+    try
+    {
+        bip::file_mapping file(path(s_namespace).c_str(), bip::read_only);
+        region = bip::mapped_region(file, bip::read_only);
+    }
+    catch (const bip::interprocess_exception&)
+    {
+        return false;  // Not cached yet, or not readable
+    }
+
+    const auto* data = static_cast<const char*>(region.get_address());
+    std::uint64_t size = region.get_size();
+    if (size < sizeof(SnapshotHeader))
+    {
+        return false;
+    }
+
+    SnapshotHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic_, snapshot_magic, sizeof(snapshot_magic)) != 0 || header.version_ != snapshot_version)
+    {
+        return false;
+    }
+
+    std::uint64_t entries_size = static_cast<std::uint64_t>(header.entry_count_) * sizeof(FrozenConfigures::Entry);
+    std::uint64_t expected_size = sizeof(SnapshotHeader) + entries_size + header.release_key_size_ + header.arena_size_;
+    if (size != expected_size)
+    {
+        return false;  // Truncated or trailing data
+    }
+
+    // The mapping is page aligned and the header size a multiple of the entry alignment.
+    const auto* entries = reinterpret_cast<const FrozenConfigures::Entry*>(data + sizeof(SnapshotHeader));
+    const char* release_key = data + sizeof(SnapshotHeader) + entries_size;
+    const char* arena = release_key + header.release_key_size_;
+
+    Configures configures;
+    for (std::uint32_t i = 0; i < header.entry_count_; ++i)
+    {
+        const FrozenConfigures::Entry& e = entries[i];
+        if (!inArena(e.key_offset_, e.key_size_, header.arena_size_) ||
+            !inArena(e.value_offset_, e.value_size_, header.arena_size_))
+        {
+            return false;
+        }
+
+        // Entries are sorted by key, each one is inserted at the end of the map.
+        configures.emplace_hint(configures.end(),
+                                std::piecewise_construct,
+                                std::forward_as_tuple(arena + e.key_offset_, e.key_size_),
+                                std::forward_as_tuple(arena + e.value_offset_, e.value_size_));
+    }
+
+    snapshot.release_key_.assign(release_key, header.release_key_size_);
+    snapshot.notification_id_ = static_cast<int>(header.notification_id_);
+    snapshot.configures_ = std::move(configures);
+    return true;
+}
+
+bool SnapshotCache::store(const NamespaceType& s_namespace,
+                          const std::string& release_key,
+                          int notification_id,
+                          const Configures& configures) const
+{
+    FrozenConfigures frozen;
+    try
+    {
+        frozen = FrozenConfigures(configures);
+    }
+    catch (const std::length_error&)
+    {
+        return false;  // The arena exceeds the 32-bit offsets of the file
+    }
+
+    SnapshotHeader header;
+    std::memcpy(header.magic_, snapshot_magic, sizeof(snapshot_magic));
+    header.version_ = snapshot_version;
+    header.notification_id_ = notification_id;
+    header.release_key_size_ = static_cast<std::uint32_t>(release_key.size());
+    header.entry_count_ = static_cast<std::uint32_t>(frozen.size());
+    header.arena_size_ = frozen.arena().size();
+
+    // Unique per writer, so concurrent writers never share a temporary file.
+    std::random_device random;
+    auto file_path = path(s_namespace);
+    auto tmp_path = file_path + ".tmp." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) +
+                    "." + std::to_string(random());
+
+    int fd = ::open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    // The file is synced before the rename, a crash never leaves the new name on partial content.
+    bool written = writeAll(fd, &header, sizeof(header)) &&
+                   writeAll(fd, frozen.entries().data(), frozen.entries().size() * sizeof(FrozenConfigures::Entry)) &&
+                   writeAll(fd, release_key.data(), release_key.size()) &&
+                   writeAll(fd, frozen.arena().data(), frozen.arena().size()) && ::fsync(fd) == 0;
+    written = ::close(fd) == 0 && written;
+    if (!written || std::rename(tmp_path.c_str(), file_path.c_str()) != 0)
+    {
+        std::remove(tmp_path.c_str());
+        return false;
+    }
+    return syncDirectory(cache_dir_);
+}
+
+SnapshotWriter::SnapshotWriter(const SnapshotCache& cache, FailureHandler on_failure)
+    : cache_(cache)
+    , on_failure_(std::move(on_failure))
+    , thread_([this]() { run(); })
+{
+}
+
+SnapshotWriter::~SnapshotWriter()
+{
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    ready_cv_.notify_one();
+    thread_.join();
+}
+
+void SnapshotWriter::write(const NamespaceType& s_namespace,
+                           std::string release_key,
+                           int notification_id,
+                           ConfiguresPtr configures)
+{
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        queued_[s_namespace] = Pending{std::move(release_key), notification_id, std::move(configures)};
+    }
+    ready_cv_.notify_one();
+}
+
+void SnapshotWriter::run()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true)
+    {
+        ready_cv_.wait(lock, [this]() { return stopping_ || !queued_.empty(); });
+        if (queued_.empty())
+        {
+            return;  // Stopping, every snapshot was written
+        }
+
+        auto it = queued_.begin();
+        NamespaceType s_namespace = it->first;
+        Pending pending = std::move(it->second);
+        queued_.erase(it);
+
+        lock.unlock();
+        if (!cache_.store(s_namespace, pending.release_key_, pending.notification_id_, *pending.configures_) &&
+            on_failure_)
+        {
+            on_failure_(s_namespace);
+        }
+        lock.lock();
+    }
+}
+
+}  // namespace client
+}  // namespace apollo
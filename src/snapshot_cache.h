@@ -0,0 +1,103 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "apollo/apollo_types.h"
+
+namespace apollo
+{
+namespace client
+{
+/**
+ * On-disk cache of the namespace releases, one file per namespace in the cache directory.
+ *
+ * A file holds a fixed header, the FrozenConfigures entry table, the release key and the arena,
+ * in the host byte order. Loading maps the file and copies the entries out of it, nothing is parsed.
+ * Files are written under a temporary name, synced, renamed over the previous one and their directory
+ * synced, so neither a reader nor a crash ever leaves a partially written file; a file that fails
+ * validation is ignored.
+ */
+class SnapshotCache
+{
+public:
+    struct Snapshot
+    {
+        std::string release_key_;
+        int notification_id_ = -1;
+        Configures configures_;
+    };
+
+    SnapshotCache(const std::string& cache_dir,
+                  const std::string& app_id,
+                  const std::string& cluster_name,
+                  const std::string& label = "");
+    ~SnapshotCache() = default;
+
+    // Returns false if the namespace is not cached or its file is invalid.
+    bool load(const NamespaceType& s_namespace, Snapshot& snapshot) const;
+
+    // Returns false if the file could not be written, e.g. a release too large to freeze, the previous
+    // file is kept in that case. Blocks until the file is on disk.
+    bool store(const NamespaceType& s_namespace,
+               const std::string& release_key,
+               int notification_id,
+               const Configures& configures) const;
+
+    // File of the namespace, {app_id}+{cluster}+{label}+{namespace}.snapshot with unsafe characters
+    // percent-encoded.
+    std::string path(const NamespaceType& s_namespace) const;
+
+private:
+    SnapshotCache(const SnapshotCache&) = delete;             // Disable copy constructor
+    SnapshotCache& operator=(const SnapshotCache&) = delete;  // Disable assignment operator
+
+    std::string cache_dir_;
+    std::string file_prefix_;
+};
+
+/**
+ * Writes the snapshots of a SnapshotCache on a thread of its own, off the strand of the client.
+ *
+ * At most one snapshot per namespace is queued: a release queued while the previous one of the namespace
+ * is still queued replaces it, only the latest release of a namespace is worth writing. Thread-safe.
+ */
+class SnapshotWriter
+{
+public:
+    // Called on the writer thread with the namespace whose file could not be written.
+    using FailureHandler = std::function<void(const NamespaceType& s_namespace)>;
+
+    SnapshotWriter(const SnapshotCache& cache, FailureHandler on_failure);
+    ~SnapshotWriter();  // Writes the snapshots still queued
+
+    void write(const NamespaceType& s_namespace, std::string release_key, int notification_id, ConfiguresPtr configures);
+
+private:
+    SnapshotWriter(const SnapshotWriter&) = delete;             // Disable copy constructor
+    SnapshotWriter& operator=(const SnapshotWriter&) = delete;  // Disable assignment operator
+
+    struct Pending
+    {
+        std::string release_key_;
+        int notification_id_;
+        ConfiguresPtr configures_;
+    };
+
+    void run();
+
+    const SnapshotCache& cache_;
+    FailureHandler on_failure_;
+    std::mutex mutex_;
+    std::condition_variable ready_cv_;  // A snapshot is queued or the writer stops
+    std::map<NamespaceType, Pending> queued_;
+    bool stopping_ = false;
+    std::thread thread_;
+};
+
+}  // namespace client
+}  // namespace apollo
@@ -0,0 +1,265 @@
+#include "url_builder.h"
+#include <boost/url.hpp>
+#include "apollo_utility.h"
+#include "nlohmann/json.hpp"
+
+namespace apollo
+{
+namespace client
+{
+namespace
+{
+constexpr std::size_t max_id_length = 11;  // "-2147483648"
+
+bool isUnreserved(unsigned char c)
+{
+    return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '-' || c == '.' ||
+           c == '_' || c == '~';
+}
+
+// A query parameter value as the url functions append it: encoded with unreserved_chars, then the '%'
+// of the result encoded again by the params view.
+void appendParamValue(std::string& out, const std::string& value)
+{
+    static constexpr char hex[] = "0123456789ABCDEF";
+    for (unsigned char c : value)
+    {
+        if (isUnreserved(c))
+        {
+            out += static_cast<char>(c);
+        }
+        else
+        {
+            out += "%25";
+            out += hex[c >> 4];
+            out += hex[c & 0x0F];
+        }
+    }
+}
+
+std::string paramValue(const std::string& value)
+{
+    std::string out;
+    out.reserve(value.size() * 5);
+    appendParamValue(out, value);
+    return out;
+}
+
+// Formats id into buffer, which holds max_id_length characters, returns the length.
+std::size_t formatId(int id, char* buffer)
+{
+    char digits[max_id_length];
+    std::size_t count = 0;
+    // Negated as unsigned, so INT_MIN does not overflow.
+    unsigned int magnitude = id < 0 ? 0u - static_cast<unsigned int>(id) : static_cast<unsigned int>(id);
+    do
+    {
+        digits[count++] = static_cast<char>('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude != 0);
+
+    std::size_t length = 0;
+    if (id < 0)
+    {
+        buffer[length++] = '-';
+    }
+    while (count > 0)
+    {
+        buffer[length++] = digits[--count];
+    }
+    return length;
+}
+
+// The notifications url up to its notifications value, left to boost::urls, which normalizes apollo_url.
+std::string notificationsPrefix(const std::string& app_id, const std::string& apollo_url, const std::string& cluster_name)
+{
+    boost::urls::url u(apollo_url);
+    u.set_path("/notifications/v2");
+    auto params = u.params();
+    params.append({"appId", boost::urls::encode(app_id, boost::urls::unreserved_chars)});
+    params.append({"cluster", boost::urls::encode(cluster_name, boost::urls::unreserved_chars)});
+    params.append({"notifications", ""});
+    return std::string(u.buffer());
+}
+
+// [{"namespaceName":"...","notificationId": of the first namespace, the same with ',' of the others.
+std::string notificationsFragment(const NamespaceType& s_namespace, bool first)
+{
+    return paramValue((first ? "[" : ",") + std::string("{\"namespaceName\":") + nlohmann::json(s_namespace).dump() +
+                      ",\"notificationId\":");
+}
+
+std::string notificationsSuffix(const std::string& label, bool empty)
+{
+    std::string suffix = paramValue(empty ? "[]" : "]");
+    if (!label.empty())
+    {
+        suffix += "&label=" + paramValue(label);
+    }
+    return suffix;
+}
+}  // namespace
+
+NotificationsURLBuilder::NotificationsURLBuilder(const std::string& app_id,
+                                                 const std::string& apollo_url,
+                                                 const std::string& cluster_name,
+                                                 const std::string& label,
+                                                 const NamespaceAttributesMap& namespace_attributes)
+{
+    std::string prefix = notificationsPrefix(app_id, apollo_url, cluster_name);
+    std::vector<std::string> fragments;
+    std::size_t capacity = prefix.size() + 3 * max_id_length + paramValue("[]").size();
+    for (const auto& p : namespace_attributes)
+    {
+        fragments.push_back(notificationsFragment(p.first, fragments.empty()));
+        capacity += fragments.back().size() + max_id_length + paramValue("}").size();
+    }
+    std::string suffix = notificationsSuffix(label, fragments.empty());
+
+    url_.reserve(capacity + suffix.size());
+    url_ = prefix;
+    auto attributes = namespace_attributes.begin();
+    for (const auto& fragment : fragments)
+    {
+        url_ += fragment;
+        char id[max_id_length];
+        int notification_id = (attributes++)->second->GetNotificationId();
+        std::size_t length = formatId(notification_id, id);
+        segments_.push_back({url_.size(), length, notification_id});
+        url_.append(id, length);
+        appendParamValue(url_, "}");
+    }
+    url_ += suffix;
+}
+
+const std::string& NotificationsURLBuilder::build(const NamespaceAttributesMap& namespace_attributes)
+{
+    std::ptrdiff_t shift = 0;  // Of the segments after the last id rewritten with a different length
+    auto segment = segments_.begin();
+    for (const auto& p : namespace_attributes)
+    {
+        if (segment == segments_.end())
+        {
+            break;
+        }
+
+        segment->offset_ = static_cast<std::size_t>(static_cast<std::ptrdiff_t>(segment->offset_) + shift);
+        int notification_id = p.second->GetNotificationId();
+        if (notification_id != segment->notification_id_)
+        {
+            char id[max_id_length];
+            std::size_t length = formatId(notification_id, id);
+            // Within the reserved capacity, replace() moves the tail without reallocating.
+            url_.replace(segment->offset_, segment->length_, id, length);
+            shift += static_cast<std::ptrdiff_t>(length) - static_cast<std::ptrdiff_t>(segment->length_);
+            segment->length_ = length;
+            segment->notification_id_ = notification_id;
+        }
+        ++segment;
+    }
+    return url_;
+}
+
+std::vector<NamespaceAttributesMap> partitionNotifications(const std::string& app_id,
+                                                           const std::string& apollo_url,
+                                                           const std::string& cluster_name,
+                                                           const std::string& label,
+                                                           const NamespaceAttributesMap& namespace_attributes,
+                                                           std::size_t max_namespaces,
+                                                           std::size_t max_url_length)
+{
+    // Sized with the longest ids, so a shard never outgrows max_url_length as its ids grow.
+    const std::size_t base = notificationsPrefix(app_id, apollo_url, cluster_name).size() +
+                             notificationsSuffix(label, false).size();
+    const std::size_t closing = max_id_length + paramValue("}").size();
+
+    std::vector<NamespaceAttributesMap> shards;
+    std::size_t length = 0;
+    for (const auto& p : namespace_attributes)
+    {
+        std::size_t fragment = notificationsFragment(p.first, false).size() + closing;
+        bool full = !shards.empty() && ((max_namespaces > 0 && shards.back().size() >= max_namespaces) ||
+                                        (max_url_length > 0 && length + fragment > max_url_length));
+        if (shards.empty() || full)
+        {
+            shards.emplace_back();
+            length = base;
+        }
+        shards.back().emplace(p.first, p.second);
+        length += fragment;
+    }
+    return shards;
+}
+
+ConfigsURLBuilder::ConfigsURLBuilder(const std::string& app_id,
+                                     const std::string& apollo_url,
+                                     const std::string& cluster_name,
+                                     const std::string& label,
+                                     const NamespaceAttributesMap& namespace_attributes)
+    : app_id_(app_id)
+    , apollo_url_(apollo_url)
+    , cluster_name_(cluster_name)
+    , label_(label)
+    , messages_suffix_(paramValue("}}"))
+{
+    for (const auto& p : namespace_attributes)
+    {
+        boost::urls::url u(apollo_url);
+        u.set_path(createNoCacheConfigsURLPath(app_id, cluster_name, p.first));
+        auto params = u.params();
+        if (!label.empty())
+        {
+            params.append({"label", boost::urls::encode(label, boost::urls::unreserved_chars)});
+        }
+
+        Template t;
+        t.base_ = std::string(u.buffer());
+        params.append({"releaseKey", ""});
+        t.release_key_prefix_ = std::string(u.buffer());
+        t.messages_prefix_ =
+            "&messages=" + paramValue("{\"details\":{\"" + app_id + '+' + cluster_name + '+' + p.first + "\":");
+        templates_.emplace(p.first, std::move(t));
+    }
+}
+
+std::string ConfigsURLBuilder::build(const NamespaceType& s_namespace,
+                                     const std::string& release_key,
+                                     int notification_id) const
+{
+    auto it = templates_.find(s_namespace);
+    if (it == templates_.end())
+    {
+        return createNoCacheConfigsURL(app_id_,
+                                       apollo_url_,
+                                       cluster_name_,
+                                       s_namespace,
+                                       label_,
+                                       release_key,
+                                       notification_id);
+    }
+
+    const Template& t = it->second;
+    if (release_key.empty())
+    {
+        return t.base_;
+    }
+
+    std::string url;
+    url.reserve(t.release_key_prefix_.size() + release_key.size() * 5 + t.messages_prefix_.size() + max_id_length +
+                messages_suffix_.size());
+    url += t.release_key_prefix_;
+    appendParamValue(url, release_key);
+    if (notification_id == -1)
+    {
+        return url;
+    }
+
+    char id[max_id_length];
+    url += t.messages_prefix_;
+    url.append(id, formatId(notification_id, id));
+    url += messages_suffix_;
+    return url;
+}
+
+}  // namespace client
+}  // namespace apollo
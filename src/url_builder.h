@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+#include "apollo_internal.h"
+
+namespace apollo
+{
+namespace client
+{
+/**
+ * The /notifications/v2 url of a client, kept up to date in place.
+ *
+ * The url is built once, byte for byte as createNotificationsV2URL() builds it, and build() only rewrites
+ * the notification ids that changed since. The buffer is reserved for the longest ids, so an id of a
+ * different length only moves the tail of the url: a poll allocates nothing, and copies nothing when
+ * no id changed. Not thread-safe, the client builds it on its strand.
+ */
+class NotificationsURLBuilder
+{
+public:
+    NotificationsURLBuilder(const std::string& app_id,
+                            const std::string& apollo_url,
+                            const std::string& cluster_name,
+                            const std::string& label,
+                            const NamespaceAttributesMap& namespace_attributes);
+
+    // The url with the current notification ids of namespace_attributes, valid until the next build().
+    // namespace_attributes must hold the namespaces the builder was created with.
+    const std::string& build(const NamespaceAttributesMap& namespace_attributes);
+
+private:
+    struct Segment
+    {
+        std::size_t offset_;  // Of the id in url_
+        std::size_t length_;
+        int notification_id_;
+    };
+
+    std::string url_;
+    std::vector<Segment> segments_;  // In the order of the namespaces in the map
+};
+
+/**
+ * Splits namespace_attributes into the shards of long polling, each polled by a /notifications/v2 url of
+ * its own.
+ *
+ * A shard holds consecutive namespaces of the map, at most max_namespaces of them, and its url stays within
+ * max_url_length bytes whatever its notification ids; 0 leaves either unbounded. A namespace whose url alone
+ * is longer than max_url_length gets a shard of its own. Returns no shard if namespace_attributes is empty.
+ */
+std::vector<NamespaceAttributesMap> partitionNotifications(const std::string& app_id,
+                                                           const std::string& apollo_url,
+                                                           const std::string& cluster_name,
+                                                           const std::string& label,
+                                                           const NamespaceAttributesMap& namespace_attributes,
+                                                           std::size_t max_namespaces,
+                                                           std::size_t max_url_length);
+
+/**
+ * The /configs urls of the namespaces of a client, built as createNoCacheConfigsURL() builds them.
+ *
+ * The path, the label and the messages of every namespace are encoded once, a url only encodes its
+ * release key and formats its notification id, into a string allocated once. Thread-safe once created.
+ */
+class ConfigsURLBuilder
+{
+public:
+    ConfigsURLBuilder(const std::string& app_id,
+                      const std::string& apollo_url,
+                      const std::string& cluster_name,
+                      const std::string& label,
+                      const NamespaceAttributesMap& namespace_attributes);
+
+    std::string build(const NamespaceType& s_namespace, const std::string& release_key, int notification_id) const;
+
+private:
+    struct Template
+    {
+        std::string base_;                // The url without release key
+        std::string release_key_prefix_;  // base_ followed by the releaseKey parameter name
+        std::string messages_prefix_;     // The messages parameter up to the notification id
+    };
+
+    std::string app_id_;
+    std::string apollo_url_;
+    std::string cluster_name_;
+    std::string label_;
+    std::map<NamespaceType, Template> templates_;
+    std::string messages_suffix_;
+};
+
+}  // namespace client
+}  // namespace apollo
@@ -1,15 +1,87 @@
 #define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
 #include <doctest/doctest.h>
 #include "http_client.h"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <future>
+#include <mutex>
+#include <thread>
 #include <boost/asio.hpp>
+#include <dirent.h>
+#include <unistd.h>
+#include "apollo_runtime_impl.h"
 #include "apollo_utility.h"
+#include "atomic_histogram.h"
+#include "atomic_shared_ptr.h"
+#include "config_service_selector.h"
+#include "content_decoder.h"
+#include "frozen_configures.h"
+#include "json_body.h"
+#include "json_push_parser.h"
+#include "listener_dispatcher.h"
+#include "listener_registry.h"
+#include "mock_apollo_server.h"
+#include "snapshot_cache.h"
+#include "url_builder.h"
+#include "apollo/apollo_client.h"
+#include "apollo/apollo_json_value.h"
 
 using namespace apollo::client;
+namespace
+{
+// A directory of its own for the cache files of a test, removed with them at the end of the test.
+class TemporaryDirectory
+{
+public:
+    TemporaryDirectory()
+    {
+        char path[] = "/tmp/apollo_test_XXXXXX";
+        REQUIRE(::mkdtemp(path) != nullptr);
+        path_ = path;
+    }
+
+    ~TemporaryDirectory()
+    {
+        DIR* dir = ::opendir(path_.c_str());
+        if (dir != nullptr)
+        {
+            while (struct dirent* entry = ::readdir(dir))
+            {
+                std::string name = entry->d_name;
+                if (name != "." && name != "..")
+                {
+                    ::unlink((path_ + "/" + name).c_str());
+                }
+            }
+            ::closedir(dir);
+        }
+        ::rmdir(path_.c_str());
+    }
+
+    const std::string& path() const
+    {
+        return path_;
+    }
+
+private:
+    TemporaryDirectory(const TemporaryDirectory&) = delete;
+    TemporaryDirectory& operator=(const TemporaryDirectory&) = delete;
+
+    std::string path_;
+};
+}  // namespace
+
 TEST_CASE("httpclient-sync-get")
 {
+    apollo::mock::MockApolloServer server;
+    server.setRelease("application", {{"key", "value"}}, "release-1");
+    server.start();
+
     boost::asio::io_context io_context;
     HttpClient client(io_context);
-    std::string url = "http://httpbin.org/get";
+    std::string url = server.url() + "/configs/app/default/application";
 
     auto result = client.get(url);
     CHECK(!result.second);
@@ -20,7 +92,7 @@ TEST_CASE("httpclient-not-support-ssl")
 {
     boost::asio::io_context io_context;
     HttpClient client(io_context);
-    std::string url = "https://httpbin.org/get";
+    std::string url = "https://127.0.0.1:1/get";
 
     auto result = client.get(url);
     CHECK(result.second);
@@ -55,9 +127,13 @@ TEST_CASE("httpclient-invalid-host")
 
 TEST_CASE("httpclient-async-get")
 {
+    apollo::mock::MockApolloServer server;
+    server.setRelease("application", {{"key", "value"}}, "release-1");
+    server.start();
+
     boost::asio::io_context io_context;
     HttpClient client(io_context);
-    std::string url = "http://httpbin.org/get";
+    std::string url = server.url() + "/configs/app/default/application";
 
     bool callback_called = false;
     client.getAsync(url,
@@ -72,6 +148,345 @@ TEST_CASE("httpclient-async-get")
     CHECK(callback_called);
 }
 
+TEST_CASE("httpclient-keep-alive-reuses-connection")
+{
+    apollo::mock::MockApolloServer server;
+    server.setRelease("application", {{"key", "value"}}, "release-1");
+    server.start();
+    std::string url = server.url() + "/configs/app/default/application";
+
+    boost::asio::io_context io_context;
+    HttpClient client(io_context);
+    auto pool = std::make_shared<ConnectionPool>(2, 60000);
+    client.setConnectionPool(pool);
+
+    for (int i = 0; i < 3; ++i)
+    {
+        auto result = client.get(url);
+        REQUIRE(!result.second);
+        CHECK(result.first.result() == http::status::ok);
+    }
+
+    int async_responses = 0;
+    client.getAsync(url,
+                    [&](beast::error_code ec, http::response<http::string_body> res)
+                    {
+                        CHECK(!ec);
+                        CHECK(res.result() == http::status::ok);
+                        ++async_responses;
+                    });
+    io_context.run();
+
+    CHECK(async_responses == 1);
+    CHECK(server.requestCount() == 4);
+    CHECK(server.connectionCount() == 1);
+    CHECK(pool->idleCount("127.0.0.1:" + std::to_string(server.port())) == 1);
+}
+
+TEST_CASE("httpclient-parses-body-while-reading")
+{
+    apollo::mock::MockApolloServer server;
+    Configures configures;
+    for (int i = 0; i < 1000; ++i)
+    {
+        configures.emplace("key" + std::to_string(i), std::string(100, 'v') + std::to_string(i));
+    }
+    server.setRelease("application", configures, "release-1");
+    server.start();
+
+    boost::asio::io_context io_context;
+    HttpClient client(io_context);
+
+    auto result = client.get<ConfigsBody>(server.url() + "/configs/app/default/application");
+    REQUIRE(!result.second);
+    CHECK(result.first.result() == http::status::ok);
+    CHECK(result.first.body().release_key_ == "release-1");
+    CHECK(result.first.body().configures_ == configures);
+
+    // Other statuses are not parsed.
+    auto missing = client.get<ConfigsBody>(server.url() + "/configs/app/default/missing");
+    CHECK(!missing.second);
+    CHECK(missing.first.result() == http::status::not_found);
+    CHECK(missing.first.body().configures_.empty());
+
+    std::size_t notifications = 0;
+    client.getAsync<NotificationsBody>(
+        server.url() + "/notifications/v2?appId=app&cluster=default&notifications=" +
+            R"(%5B%7B%22namespaceName%22%3A%22application%22%2C%22notificationId%22%3A-1%7D%5D)",
+        [&](beast::error_code ec, http::response<NotificationsBody> res)
+        {
+            CHECK(!ec);
+            REQUIRE(res.body().size() == 1);
+            CHECK(res.body()[0].namespace_name_ == "application");
+            CHECK(res.body()[0].notification_id_ == 1);
+            notifications = res.body().size();
+        });
+    io_context.run();
+    CHECK(notifications == 1);
+}
+
+TEST_CASE("content-decoder")
+{
+    std::string body;
+    for (int i = 0; i < 2000; ++i)
+    {
+        body += "\"key" + std::to_string(i) + "\":\"value" + std::to_string(i % 7) + "\",";
+    }
+
+    std::string zlib_wrapped = apollo::mock::encodeContent(body, "deflate");
+    std::map<std::string, std::string> encoded = {{"gzip", apollo::mock::encodeContent(body, "gzip")},
+                                                  {"deflate", zlib_wrapped},
+                                                  {"raw-deflate", zlib_wrapped.substr(2, zlib_wrapped.size() - 6)}};
+    for (const auto& p : encoded)
+    {
+        CAPTURE(p.first);
+        CHECK(p.second.size() < body.size() / 4);
+        std::string coding = p.first == "raw-deflate" ? "deflate" : p.first;
+
+        ContentDecoder decoder;
+        REQUIRE(decoder.reset(coding));
+        std::string out;
+        CHECK(decoder.write(p.second.data(), p.second.size(), out));
+        CHECK(decoder.finish());
+        CHECK(out == body);
+
+        // Split anywhere, including inside the header and the trailer.
+        REQUIRE(decoder.reset(coding));
+        out.clear();
+        for (char c : p.second)
+        {
+            REQUIRE(decoder.write(&c, 1, out));
+        }
+        CHECK(decoder.finish());
+        CHECK(out == body);
+
+        // Truncated
+        REQUIRE(decoder.reset(coding));
+        out.clear();
+        CHECK(decoder.write(p.second.data(), p.second.size() - 1, out));
+        CHECK(!decoder.finish());
+    }
+
+    ContentDecoder decoder;
+    std::string out;
+    auto gzip = encoded["gzip"];
+    gzip[gzip.size() - 5] ^= 1;  // CRC32
+    REQUIRE(decoder.reset("gzip"));
+    CHECK(!decoder.write(gzip.data(), gzip.size(), out));
+    CHECK(!decoder.finish());
+
+    REQUIRE(decoder.reset("gzip"));
+    CHECK(!decoder.write(body.data(), body.size(), out));
+
+    CHECK(decoder.reset("identity"));
+    CHECK(decoder.identity());
+    CHECK(!decoder.reset("br"));
+}
+
+TEST_CASE("httpclient-decodes-compressed-response")
+{
+    apollo::mock::MockApolloServer server;
+    Configures configures;
+    for (int i = 0; i < 1000; ++i)
+    {
+        configures.emplace("key" + std::to_string(i), std::string(100, 'v') + std::to_string(i));
+    }
+    server.setRelease("application", configures, "release-1");
+    server.setCompression(true);
+    server.start();
+    std::string url = server.url() + "/configs/app/default/application";
+
+    boost::asio::io_context io_context;
+    HttpClient client(io_context);
+
+    // Not requested, not compressed.
+    auto plain = client.get(url);
+    REQUIRE(!plain.second);
+    auto stats = client.transferStats();
+    CHECK(stats.responses_ == 1);
+    CHECK(stats.compressed_responses_ == 0);
+    CHECK(stats.wire_bytes_ == plain.first.body().size());
+    CHECK(stats.decoded_bytes_ == plain.first.body().size());
+
+    client.setCompression(true);
+    auto result = client.get<ConfigsBody>(url);
+    REQUIRE(!result.second);
+    CHECK(result.first.body().release_key_ == "release-1");
+    CHECK(result.first.body().configures_ == configures);
+    CHECK(result.first.find(http::field::content_encoding) == result.first.end());
+
+    auto text = client.get(url);
+    REQUIRE(!text.second);
+    CHECK(text.first.body() == plain.first.body());
+
+    stats = client.transferStats();
+    CHECK(stats.responses_ == 3);
+    CHECK(stats.compressed_responses_ == 2);
+    CHECK(stats.decoded_bytes_ == 3 * plain.first.body().size());
+    CHECK(stats.wire_bytes_ < plain.first.body().size() + plain.first.body().size() / 2);
+
+    Opts opts;
+    opts.compressed_transfer_ = true;
+    auto apollo_client = makeApolloClient(server.url(), "test_app", std::move(opts));
+    CHECK(apollo_client->getConfigures("application") == configures);
+    auto metrics = apollo_client->getTransferMetrics();
+    CHECK(metrics.compressed_responses_ >= 1);
+    CHECK(metrics.wire_bytes_ < metrics.decoded_bytes_ / 4);
+}
+
+TEST_CASE("httpclient-keep-alive-disabled")
+{
+    apollo::mock::MockApolloServer server;
+    server.setRelease("application", {{"key", "value"}}, "release-1");
+    server.start();
+    std::string url = server.url() + "/configs/app/default/application";
+
+    boost::asio::io_context io_context;
+    HttpClient client(io_context);
+    client.setConnectionPool(std::make_shared<ConnectionPool>(0, 60000));
+
+    CHECK(!client.get(url).second);
+    CHECK(!client.get(url).second);
+    CHECK(server.connectionCount() == 2);
+}
+
+TEST_CASE("httpclient-keep-alive-drops-stale-connection")
+{
+    apollo::mock::MockApolloServer server;
+    server.setRelease("application", {{"key", "value"}}, "release-1");
+    server.setCloseAfterResponse(true);
+    server.start();
+    std::string url = server.url() + "/configs/app/default/application";
+
+    boost::asio::io_context io_context;
+    HttpClient client(io_context);
+    client.setConnectionPool(std::make_shared<ConnectionPool>(2, 60000));
+
+    CHECK(!client.get(url).second);
+    // Give the server time to close the pooled connection.
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    auto result = client.get(url);
+    CHECK(!result.second);
+    CHECK(result.first.result() == http::status::ok);
+    CHECK(server.connectionCount() == 2);
+}
+
+TEST_CASE("connection-pool-idle-timeout")
+{
+    apollo::mock::MockApolloServer server;
+    server.setRelease("application", {{"key", "value"}}, "release-1");
+    server.start();
+    std::string url = server.url() + "/configs/app/default/application";
+
+    boost::asio::io_context io_context;
+    HttpClient client(io_context);
+    auto pool = std::make_shared<ConnectionPool>(2, 10);
+    client.setConnectionPool(pool);
+
+    CHECK(!client.get(url).second);
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    CHECK(!client.get(url).second);
+    CHECK(server.connectionCount() == 2);
+}
+
+TEST_CASE("resolver-cache-hit-and-miss")
+{
+    boost::asio::io_context io_context;
+    auto cache = std::make_shared<ResolverCache>(io_context, 60000);
+
+    boost::system::error_code ec;
+    auto first = cache->resolve("127.0.0.1", "8080", ec);
+    CHECK(!ec);
+    CHECK(!first.empty());
+    auto second = cache->resolve("127.0.0.1", "8080", ec);
+    CHECK(!ec);
+    CHECK(second.begin()->endpoint() == first.begin()->endpoint());
+
+    bool async_called = false;
+    cache->asyncResolve("127.0.0.1",
+                        "8080",
+                        [&](boost::system::error_code async_ec, ResolverCache::Results results)
+                        {
+                            CHECK(!async_ec);
+                            CHECK(!results.empty());
+                            async_called = true;
+                        });
+    CHECK(async_called);
+
+    auto stats = cache->stats();
+    CHECK(stats.misses_ == 1);
+    CHECK(stats.hits_ == 2);
+    CHECK(stats.refreshes_ == 0);
+}
+
+TEST_CASE("resolver-cache-serves-stale-entry-while-refreshing")
+{
+    boost::asio::io_context io_context;
+    auto cache = std::make_shared<ResolverCache>(io_context, 1);
+
+    boost::system::error_code ec;
+    cache->resolve("127.0.0.1", "8080", ec);
+    CHECK(!ec);
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+
+    // The expired entry is served immediately, the refresh runs on the io_context.
+    bool async_called = false;
+    cache->asyncResolve("127.0.0.1",
+                        "8080",
+                        [&](boost::system::error_code async_ec, ResolverCache::Results results)
+                        {
+                            CHECK(!async_ec);
+                            CHECK(!results.empty());
+                            async_called = true;
+                        });
+    CHECK(async_called);
+    CHECK(cache->stats().refreshes_ == 1);
+    io_context.run();
+
+    auto stats = cache->stats();
+    CHECK(stats.misses_ == 1);
+    CHECK(stats.hits_ == 1);
+    CHECK(stats.refresh_failures_ == 0);
+}
+
+TEST_CASE("resolver-cache-refreshes-inline-without-executor")
+{
+    // Nothing runs the io_context, as for the synchronous requests of a client that does not poll.
+    boost::asio::io_context io_context;
+    auto cache = std::make_shared<ResolverCache>(io_context, 1);
+
+    boost::system::error_code ec;
+    cache->resolve("127.0.0.1", "8080", ec);
+    CHECK(!ec);
+
+    // Each expired lookup refreshes the entry itself, none is left refreshing forever.
+    for (int i = 1; i <= 2; ++i)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        auto results = cache->resolve("127.0.0.1", "8080", ec);
+        CHECK(!ec);
+        CHECK(!results.empty());
+        CHECK(cache->stats().refreshes_ == static_cast<std::uint64_t>(i));
+    }
+
+    auto stats = cache->stats();
+    CHECK(stats.misses_ == 1);
+    CHECK(stats.hits_ == 2);
+    CHECK(stats.refresh_failures_ == 0);
+}
+
+TEST_CASE("resolver-cache-disabled")
+{
+    boost::asio::io_context io_context;
+    auto cache = std::make_shared<ResolverCache>(io_context, 0);
+
+    boost::system::error_code ec;
+    cache->resolve("127.0.0.1", "8080", ec);
+    cache->resolve("127.0.0.1", "8080", ec);
+    CHECK(cache->stats().misses_ == 2);
+    CHECK(cache->stats().hits_ == 0);
+}
+
 TEST_CASE("notification-to-json")
 {
     Notification notification;
@@ -124,6 +539,150 @@ TEST_CASE("releaseKey-configures-from-json")
     CHECK(configures["portal.elastic.cluster.name"] == "hermes-es-fws");
 }
 
+TEST_CASE("releaseKey-configures-from-json-skips-other-members")
+{
+    std::string json =
+        R"({"appId":"app","messages":{"details":{"a+b":[1,2.5,true,null,{"x":"y"}]}},"releaseKey":"rk",)"
+        R"("configurations":{"k1":"v1","k2":"","k1":"v1-last","escaped":"\"\u00e9\n"},"extra":[["nested"]]})";
+    std::string release_key;
+    Configures configures{{"stale", "value"}};
+    CHECK(fromJsonString(json, release_key, configures));
+    CHECK(release_key == "rk");
+    CHECK(configures == Configures{{"k1", "v1-last"}, {"k2", ""}, {"escaped", "\"\xC3\xA9\n"}});
+}
+
+TEST_CASE("releaseKey-configures-from-json-rejects-invalid")
+{
+    std::string release_key;
+    Configures configures;
+    CHECK(!fromJsonString(R"({"releaseKey":"rk"})", release_key, configures));
+    CHECK(!fromJsonString(R"({"configurations":{}})", release_key, configures));
+    CHECK(!fromJsonString(R"({"releaseKey":1,"configurations":{}})", release_key, configures));
+    CHECK(!fromJsonString(R"({"releaseKey":{},"configurations":{}})", release_key, configures));
+    CHECK(!fromJsonString(R"({"releaseKey":"rk","configurations":[]})", release_key, configures));
+    CHECK(!fromJsonString(R"({"releaseKey":"rk","configurations":{"k":1}})", release_key, configures));
+    CHECK(!fromJsonString(R"({"releaseKey":"rk","configurations":{"k":{}}})", release_key, configures));
+    CHECK(!fromJsonString(R"({"releaseKey":"rk","configurations":{"k":"v"})", release_key, configures));
+    CHECK(!fromJsonString(R"([{"releaseKey":"rk","configurations":{}}])", release_key, configures));
+    CHECK(!fromJsonString("", release_key, configures));
+    CHECK(fromJsonString(R"({"releaseKey":"rk","configurations":{}})", release_key, configures));
+}
+
+namespace
+{
+// Records SAX events as text, to compare the push parser with nlohmann's own parser.
+class RecordingSax : public JsonSax
+{
+public:
+    bool null() override
+    {
+        return record("null");
+    }
+    bool boolean(bool val) override
+    {
+        return record(val ? "true" : "false");
+    }
+    bool number_integer(number_integer_t val) override
+    {
+        return record("int:" + std::to_string(val));
+    }
+    bool number_unsigned(number_unsigned_t val) override
+    {
+        return record("uint:" + std::to_string(val));
+    }
+    bool number_float(number_float_t, const string_t& s) override
+    {
+        return record("float:" + s);
+    }
+    bool string(string_t& val) override
+    {
+        return record("string:" + val);
+    }
+    bool binary(binary_t&) override
+    {
+        return record("binary");
+    }
+    bool start_object(std::size_t) override
+    {
+        return record("{");
+    }
+    bool key(string_t& val) override
+    {
+        return record("key:" + val);
+    }
+    bool end_object() override
+    {
+        return record("}");
+    }
+    bool start_array(std::size_t) override
+    {
+        return record("[");
+    }
+    bool end_array() override
+    {
+        return record("]");
+    }
+    bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception&) override
+    {
+        return false;
+    }
+
+    std::string events_;
+
+private:
+    bool record(const std::string& event)
+    {
+        events_ += event + "\n";
+        return true;
+    }
+};
+}  // namespace
+
+TEST_CASE("json-push-parser-matches-nlohmann")
+{
+    std::vector<std::string> documents = {
+        R"({"releaseKey":"rk","configurations":{"a":"1","b":"x\"y\\z\/\b\f\n\r\t"}})",
+        R"( [ 0, -1, 12345678901234567890, -9223372036854775808, 1.5, -2e-3, 3E+2, true, false, null ] )",
+        R"({"unicode":"\u00e9\u4e2d\ud83d\ude00","nested":[[],{},[{"k":[1,{"v":null}]}]],"empty":""})",
+        R"("just a string")",
+        R"(42)",
+        "{\n\t\"spaced\" :\r\n [ 1 , 2 ]\n}\n",
+    };
+
+    for (const auto& document : documents)
+    {
+        RecordingSax expected;
+        REQUIRE(nlohmann::json::sax_parse(document, &expected));
+
+        // Pushed one byte at a time, every token spans chunks.
+        RecordingSax actual;
+        JsonPushParser parser(actual);
+        for (char c : document)
+        {
+            REQUIRE(parser.feed(&c, 1));
+        }
+        CHECK(parser.finish());
+        CHECK(actual.events_ == expected.events_);
+    }
+}
+
+TEST_CASE("json-push-parser-rejects-invalid")
+{
+    std::vector<std::string> documents = {
+        "",      "{",     "[1,]",     "{\"a\":1,}", "{\"a\" 1}", "{1:2}",        "[1 2]",       "01",
+        "1.",    "-",     "1e",       "tru",        "nul",        "truex",        "\"\\x\"", "\"\x01\"",
+        "[]]",   "{}}",   "[1] [2]",  "\"abc",      "\"\\u12\"", "\"\\udc00\"", "\"\\ud800x\"", "{]",
+    };
+
+    for (const auto& document : documents)
+    {
+        RecordingSax sax;
+        JsonPushParser parser(sax);
+        bool ok = parser.feed(document.data(), document.size()) && parser.finish();
+        CHECK_MESSAGE(!ok, document);
+    }
+}
+
 TEST_CASE("create-notifications-v2-url")
 {
     NamespaceAttributesMap namespace_attributes =
@@ -160,6 +719,102 @@ TEST_CASE("create-no-cache-configs-url")
     CHECK(url2 == expected_url2);
 }
 
+TEST_CASE("notifications-url-builder-matches-create-url")
+{
+    NamespaceAttributesMap namespace_attributes = {
+        {"application", std::make_shared<NamespaceAttributes>("", -1)},
+        {"name \"quoted\" + space", std::make_shared<NamespaceAttributes>("", 7)},
+        {"\xC3\xA9t\xC3\xA9.yaml", std::make_shared<NamespaceAttributes>("", 123)}};
+
+    for (const std::string label : {"", "gray release+1"})
+    {
+        NotificationsURLBuilder builder("app id", "http://apollo-server.com:8080", "default", label, namespace_attributes);
+        auto expected = [&]()
+        { return createNotificationsV2URL("app id", "http://apollo-server.com:8080", "default", label, namespace_attributes); };
+        CHECK(builder.build(namespace_attributes) == expected());
+
+        // Ids of other lengths move the rest of the url, ids left unchanged are kept.
+        for (int id : {5, 100000, -2147483647 - 1, 2147483647, 0, 42})
+        {
+            namespace_attributes.begin()->second->SetNotificationId(id);
+            std::next(namespace_attributes.begin(), 2)->second->SetNotificationId(id / 3);
+            CHECK(builder.build(namespace_attributes) == expected());
+        }
+    }
+
+    NamespaceAttributesMap none;
+    CHECK(NotificationsURLBuilder("app", "http://apollo-server.com", "default", "", none).build(none) ==
+          createNotificationsV2URL("app", "http://apollo-server.com", "default", "", none));
+}
+
+TEST_CASE("partition-notifications-bounds-shards")
+{
+    NamespaceAttributesMap namespace_attributes;
+    for (int i = 0; i < 50; ++i)
+    {
+        namespace_attributes.emplace("namespace-" + std::to_string(i) + std::string(i % 7, '+'),
+                                     std::make_shared<NamespaceAttributes>("", i));
+    }
+
+    auto partition = [&](std::size_t max_namespaces, std::size_t max_url_length)
+    {
+        return partitionNotifications(
+            "app", "http://apollo-server.com", "default", "label", namespace_attributes, max_namespaces, max_url_length);
+    };
+    CHECK(partition(0, 0).size() == 1);
+    CHECK(partition(8, 0).size() == 7);
+    CHECK(partition(8, 0).back().size() == 2);
+    CHECK(partition(0, 0).front().size() == namespace_attributes.size());
+
+    // Every namespace is polled once, in order, by a url within the bound even with the longest ids.
+    auto shards = partition(0, 1500);
+    CHECK(shards.size() > 1);
+    auto expected = namespace_attributes.begin();
+    for (auto& shard : shards)
+    {
+        for (auto& p : shard)
+        {
+            REQUIRE(expected != namespace_attributes.end());
+            CHECK(p.first == expected->first);
+            CHECK(p.second == (expected++)->second);
+        }
+        NamespaceAttributesMap longest;
+        for (const auto& p : shard)
+        {
+            longest.emplace(p.first, std::make_shared<NamespaceAttributes>("", -2147483647 - 1));
+        }
+        CHECK(createNotificationsV2URL("app", "http://apollo-server.com", "default", "label", longest).size() <= 1500);
+    }
+    CHECK(expected == namespace_attributes.end());
+
+    // A namespace longer than the bound is polled alone.
+    CHECK(partition(0, 10).size() == namespace_attributes.size());
+    NamespaceAttributesMap none;
+    CHECK(partitionNotifications("app", "http://apollo-server.com", "default", "", none, 8, 1500).empty());
+}
+
+TEST_CASE("configs-url-builder-matches-create-url")
+{
+    NamespaceAttributesMap namespace_attributes = {{"application", std::make_shared<NamespaceAttributes>()},
+                                                   {"name with space/+", std::make_shared<NamespaceAttributes>()}};
+
+    for (const std::string label : {"", "gray release+1"})
+    {
+        ConfigsURLBuilder builder("app", "http://apollo-server.com", "default", label, namespace_attributes);
+        for (const std::string s_namespace : {"application", "name with space/+", "unknown"})
+        {
+            for (const std::string release_key : {"", "20240101-abc+/="})
+            {
+                for (int id : {-1, 0, 12, -2147483647 - 1})
+                {
+                    CHECK(builder.build(s_namespace, release_key, id) ==
+                          createNoCacheConfigsURL("app", "http://apollo-server.com", "default", s_namespace, label, release_key, id));
+                }
+            }
+        }
+    }
+}
+
 TEST_CASE("create-no-cache-configs-messages")
 {
     std::string app_id = "app";
@@ -172,6 +827,1199 @@ TEST_CASE("create-no-cache-configs-messages")
     CHECK(message == expected_message);
 }
 
+TEST_CASE("configures-diff")
+{
+    Configures old_config{{"a", "1"}, {"b", "2"}, {"c", "3"}, {"e", "5"}};
+    Configures new_config{{"b", "2"}, {"c", "30"}, {"d", "4"}, {"e", "5"}, {"f", "6"}};
+
+    auto changes = ConfiguresDiff(old_config, new_config);
+    REQUIRE(changes.size() == 4);
+    CHECK((changes[0].change_type_ == ChangeType::Updated && changes[0].key_ == "c" && changes[0].value_ == "30"));
+    CHECK((changes[1].change_type_ == ChangeType::Added && changes[1].key_ == "d" && changes[1].value_ == "4"));
+    CHECK((changes[2].change_type_ == ChangeType::Added && changes[2].key_ == "f" && changes[2].value_ == "6"));
+    CHECK((changes[3].change_type_ == ChangeType::Deleted && changes[3].key_ == "a" && changes[3].value_ == "1"));
+
+    CHECK(ConfiguresDiff(old_config, old_config).empty());
+    CHECK(ConfiguresDiff(old_config, Configures(old_config)).empty());
+    CHECK(ConfiguresDiff({}, new_config).size() == new_config.size());
+    CHECK(ConfiguresDiff(old_config, {}).size() == old_config.size());
+}
+
+TEST_CASE("namespace-attributes-snapshot")
+{
+    NamespaceAttributes attributes;
+    auto empty_snapshot = attributes.GetSnapshot();
+    REQUIRE(empty_snapshot);
+    CHECK(empty_snapshot->empty());
+
+    attributes.SetConfigures({{"key1", "value1"}, {"key2", "value2"}});
+    auto snapshot = attributes.GetSnapshot();
+    REQUIRE(snapshot);
+    CHECK(snapshot->size() == 2);
+    CHECK(snapshot->at("key1") == "value1");
+
+    // A published snapshot is immutable, readers keep the release they loaded.
+    attributes.SetConfigures({{"key1", "value1-new"}});
+    CHECK(snapshot->size() == 2);
+    CHECK(snapshot->at("key1") == "value1");
+    CHECK(attributes.GetSnapshot()->at("key1") == "value1-new");
+    CHECK(attributes.GetConfigures() == Configures{{"key1", "value1-new"}});
+}
+
+TEST_CASE("atomic-shared-ptr-publishes-to-concurrent-readers")
+{
+    AtomicSharedPtr<const int> published(std::make_shared<const int>(0));
+    std::weak_ptr<const int> first = published.load();
+    constexpr int stores = 2000;
+
+    // Readers never see a released value, and a later load never goes back to an older value.
+    std::atomic<bool> stop{false};
+    std::atomic<int> errors{0};
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 4; ++i)
+    {
+        readers.emplace_back(
+            [&]()
+            {
+                int last = 0;
+                while (!stop.load())
+                {
+                    auto value = published.load();
+                    if (!value || *value < last)
+                    {
+                        ++errors;
+                    }
+                    last = value ? *value : last;
+                }
+            });
+    }
+
+    for (int value = 1; value <= stores; ++value)
+    {
+        published.store(std::make_shared<const int>(value));
+    }
+    stop.store(true);
+    for (auto& reader : readers)
+    {
+        reader.join();
+    }
+
+    CHECK(errors.load() == 0);
+    CHECK(*published.load() == stores);
+    CHECK(first.expired());  // The values replaced are released once no reader holds them
+}
+
+TEST_CASE("configures-index")
+{
+    Configures empty;
+    ConfiguresIndex empty_index(empty);
+    CHECK(empty_index.size() == 0);
+    CHECK(empty_index.find("key") == nullptr);
+
+    Configures configures;
+    for (int i = 0; i < 1000; ++i)
+    {
+        configures.emplace("key" + std::to_string(i), "value" + std::to_string(i));
+    }
+    ConfiguresIndex index(configures);
+    CHECK(index.size() == configures.size());
+    for (const auto& p : configures)
+    {
+        const std::string* value = index.find(p.first);
+        REQUIRE(value != nullptr);
+        CHECK(value == &p.second);
+    }
+    CHECK(index.find("key1000") == nullptr);
+    CHECK(index.find("") == nullptr);
+}
+
+TEST_CASE("namespace-attributes-get-value")
+{
+    NamespaceAttributes attributes;
+    CHECK(attributes.GetValue("key1") == nullptr);
+
+    attributes.SetConfigures({{"key1", "value1"}, {"key2", "value2"}});
+    auto value = attributes.GetValue("key1");
+    REQUIRE(value);
+    CHECK(*value == "value1");
+    CHECK(attributes.GetValue("missing") == nullptr);
+
+    // The value pins the release it was read from.
+    attributes.SetConfigures({{"key1", "value1-new"}});
+    CHECK(*value == "value1");
+    CHECK(*attributes.GetValue("key1") == "value1-new");
+    CHECK(attributes.GetValue("key2") == nullptr);
+}
+
+TEST_CASE("value-parser")
+{
+    bool b = false;
+    CHECK((ValueParser<bool>::parse("TRUE", b) && b));
+    CHECK((ValueParser<bool>::parse("off", b) && !b));
+    CHECK(!ValueParser<bool>::parse("maybe", b));
+
+    int i = 0;
+    CHECK((ValueParser<int>::parse("-42", i) && i == -42));
+    CHECK(!ValueParser<int>::parse("42x", i));
+    CHECK(!ValueParser<int>::parse("4294967296", i));
+    CHECK(!ValueParser<int>::parse(" 42", i));
+    CHECK(!ValueParser<int>::parse("+42", i));
+    CHECK(!ValueParser<int>::parse("-", i));
+    i = 7;
+    CHECK(!ValueParser<int>::parse("12abc", i));
+    CHECK(i == 7);  // A rejected value leaves the output untouched
+    unsigned u = 0;
+    CHECK(!ValueParser<unsigned>::parse("-1", u));
+    std::uint64_t u64 = 0;
+    CHECK(!ValueParser<std::uint64_t>::parse(" -1", u64));
+    CHECK(!ValueParser<std::uint64_t>::parse("\t1", u64));
+    CHECK((ValueParser<std::uint64_t>::parse("18446744073709551615", u64) && u64 == 18446744073709551615ULL));
+
+    double d = 0;
+    CHECK((ValueParser<double>::parse("1.5e3", d) && d == 1500.0));
+    CHECK(!ValueParser<double>::parse("", d));
+    CHECK(!ValueParser<double>::parse(" 1.5", d));
+
+    std::chrono::milliseconds ms{0};
+    CHECK((ValueParser<std::chrono::milliseconds>::parse("1500", ms) && ms.count() == 1500));
+    CHECK((ValueParser<std::chrono::milliseconds>::parse("2s", ms) && ms.count() == 2000));
+    CHECK((ValueParser<std::chrono::milliseconds>::parse("1m", ms) && ms.count() == 60000));
+    CHECK(!ValueParser<std::chrono::milliseconds>::parse("2 weeks", ms));
+}
+
+namespace
+{
+int parsed_ints = 0;
+
+ParsedValuePtr countingParseInt(const std::string& value)
+{
+    ++parsed_ints;
+    return parseValue<int>(value);
+}
+}  // namespace
+
+TEST_CASE("json-value-parser")
+{
+    nlohmann::json json;
+    CHECK((ValueParser<nlohmann::json>::parse(R"({"limits": [1, 2], "name": "apollo"})", json) &&
+           json["limits"][1] == 2 && json["name"] == "apollo"));
+    CHECK(!ValueParser<nlohmann::json>::parse("{\"unterminated\": ", json));
+    CHECK(json["name"] == "apollo");
+    CHECK(!ValueParser<nlohmann::json>::parse("", json));
+
+    // Parsed once per release, like the other typed values.
+    NamespaceAttributes attributes;
+    attributes.SetConfigures({{"limits", R"({"qps": 100})"}});
+    auto limits = attributes.GetParsedValue("limits", typeid(nlohmann::json), &parseValue<nlohmann::json>);
+    REQUIRE(limits);
+    CHECK((*static_cast<const nlohmann::json*>(limits.get()))["qps"] == 100);
+    CHECK(attributes.GetParsedValue("limits", typeid(nlohmann::json), &parseValue<nlohmann::json>) == limits);
+}
+
+TEST_CASE("namespace-attributes-parsed-value")
+{
+    NamespaceAttributes attributes;
+    attributes.SetConfigures({{"port", "8080"}, {"name", "apollo"}});
+    parsed_ints = 0;
+
+    // Parsed once per release and type, then served from the cache.
+    auto port = attributes.GetParsedValue("port", typeid(int), &countingParseInt);
+    REQUIRE(port);
+    CHECK(*static_cast<const int*>(port.get()) == 8080);
+    CHECK(attributes.GetParsedValue("port", typeid(int), &countingParseInt).get() == port.get());
+    CHECK(parsed_ints == 1);
+    auto port_string = attributes.GetParsedValue("port", typeid(std::string), &parseValue<std::string>);
+    CHECK(*static_cast<const std::string*>(port_string.get()) == "8080");
+
+    // Invalid values are cached as nullptr as well.
+    CHECK(attributes.GetParsedValue("name", typeid(int), &countingParseInt) == nullptr);
+    CHECK(attributes.GetParsedValue("name", typeid(int), &countingParseInt) == nullptr);
+    CHECK(parsed_ints == 2);
+    CHECK(attributes.GetParsedValue("missing", typeid(int), &countingParseInt) == nullptr);
+
+    // A new release is parsed again, the old value stays pinned to its release.
+    attributes.SetConfigures({{"port", "9090"}});
+    CHECK(*static_cast<const int*>(attributes.GetParsedValue("port", typeid(int), &countingParseInt).get()) == 9090);
+    CHECK(*static_cast<const int*>(port.get()) == 8080);
+    CHECK(parsed_ints == 3);
+}
+
+TEST_CASE("frozen-configures")
+{
+    Configures configures = {{"b.key", "value-b"}, {"a.key", "value-a"}, {"c.key", ""}};
+    FrozenConfigures frozen(configures);
+    REQUIRE(frozen.size() == 3);
+    CHECK(frozen.key(0) == "a.key");
+    CHECK(frozen.value(0) == "value-a");
+    CHECK(frozen.key(2) == "c.key");
+    CHECK(frozen.value(2) == "");
+    CHECK(frozen.find("b.key") == 1);
+    CHECK(frozen.find("d.key") == frozen.size());
+    CHECK(frozen.thaw() == configures);
+    CHECK(frozen.memoryUsage() >= frozen.arena().size());
+
+    FrozenConfigures empty(Configures{});
+    CHECK(empty.empty());
+    CHECK(empty.find("a.key") == 0);
+    CHECK(empty.thaw().empty());
+}
+
+TEST_CASE("frozen-configures-builder")
+{
+    FrozenConfiguresBuilder builder;
+    builder.add("key2", "value2");
+    builder.add("key1", "value1");
+    builder.add("key2", "value2-last");
+    auto frozen = builder.build();
+
+    REQUIRE(frozen.size() == 2);
+    CHECK(frozen.key(0) == "key1");
+    CHECK(frozen.value(1) == "value2-last");
+    CHECK(frozen.thaw() == Configures{{"key1", "value1"}, {"key2", "value2-last"}});
+}
+
+TEST_CASE("listener-dispatcher-coalesces-per-namespace")
+{
+    auto release = [](const std::string& value) { return std::make_shared<const Configures>(Configures{{"key", value}}); };
+
+    ListenerDispatcher dispatcher(1);
+    std::promise<void> unblock;
+    auto unblocked = unblock.get_future().share();
+    std::mutex mutex;
+    std::vector<std::string> delivered;
+    auto delivery = [&](const NamespaceType& n, const Configures& olds, const Configures& news)
+    {
+        if (olds.at("key") == "v0")
+        {
+            unblocked.wait();
+        }
+        std::unique_lock<std::mutex> lock(mutex);
+        delivered.push_back(n + ":" + olds.at("key") + "->" + news.at("key"));
+    };
+
+    // The first change blocks the only thread, the next ones of namespace1 are merged while they wait.
+    int source = 0;
+    dispatcher.dispatch(&source, "namespace1", release("v0"), release("v1"), delivery);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    dispatcher.dispatch(&source, "namespace1", release("v1"), release("v2"), delivery);
+    dispatcher.dispatch(&source, "namespace2", release("w1"), release("w2"), delivery);
+    dispatcher.dispatch(&source, "namespace1", release("v2"), release("v3"), delivery);
+    CHECK(dispatcher.stats().queue_depth_ == 2);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    unblock.set_value();
+    dispatcher.flush(&source);
+
+    CHECK(delivered == std::vector<std::string>{"namespace1:v0->v1", "namespace2:w1->w2", "namespace1:v1->v3"});
+    auto stats = dispatcher.stats();
+    CHECK(stats.events_ == 4);
+    CHECK(stats.coalesced_ == 1);
+    CHECK(stats.callbacks_ == 3);
+    CHECK(stats.queue_depth_ == 0);
+    CHECK(stats.max_queue_depth_ == 2);
+    CHECK(stats.max_delivery_latency_ >= std::chrono::milliseconds(20));
+    CHECK(stats.max_callback_duration_ >= std::chrono::milliseconds(40));
+
+    // Without a thread changes are delivered by dispatch itself.
+    ListenerDispatcher inline_dispatcher(0);
+    delivered.clear();
+    inline_dispatcher.dispatch(&source, "namespace1", release("v3"), release("v4"), delivery);
+    CHECK(delivered == std::vector<std::string>{"namespace1:v3->v4"});
+}
+
+TEST_CASE("listener-dispatcher-released-by-its-own-callback")
+{
+    // Releases the dispatcher it holds, and tells once its destructor returned.
+    struct Holder
+    {
+        ~Holder()
+        {
+            dispatcher_.reset();
+            released_.set_value();
+        }
+
+        std::shared_ptr<ListenerDispatcher> dispatcher_;
+        std::promise<void>& released_;
+    };
+
+    std::promise<void> released;
+    auto done = released.get_future();
+    std::promise<void> dropped;
+    auto owner_dropped = dropped.get_future().share();
+    auto dispatcher = std::make_shared<ListenerDispatcher>(2);
+    std::shared_ptr<Holder> holder(new Holder{dispatcher, released});
+
+    // The delivery holds the last reference once the owner dropped its own, the dispatcher is destroyed on
+    // the thread that delivered it.
+    auto news = std::make_shared<const Configures>(Configures{{"key", "value"}});
+    dispatcher->dispatch(nullptr,
+                         "namespace1",
+                         news,
+                         news,
+                         [holder, owner_dropped](const NamespaceType&, const Configures&, const Configures&)
+                         { owner_dropped.wait(); });
+    holder.reset();
+    dispatcher.reset();
+    dropped.set_value();
+
+    CHECK(done.wait_for(std::chrono::seconds(5)) == std::future_status::ready);
+}
+
+TEST_CASE("listener-registry-matches-keys-and-prefixes")
+{
+    std::map<std::string, std::vector<std::string>> received;
+    auto listener = [&received](const std::string& name)
+    {
+        return std::make_shared<NotificationCallback>(
+            [&received, name](const NamespaceType&, const Configures&, const Configures&, Changes&& changes)
+            {
+                for (const auto& change : changes)
+                {
+                    received[name].push_back(change.key_);
+                }
+            });
+    };
+
+    ListenerRegistry registry;
+    auto all = listener("all");
+    auto db = listener("db");
+    auto db_host = listener("db.host");
+    auto other_namespace = listener("other");
+    auto removed = listener("removed");
+    registry.add("application", "", KeyMatch::Prefix, all);
+    registry.add("application", "db.", KeyMatch::Prefix, db);
+    registry.add("application", "db.host", KeyMatch::Exact, db_host);
+    registry.add("other", "", KeyMatch::Prefix, other_namespace);
+    auto removed_id = registry.add("application", "db.", KeyMatch::Prefix, removed);
+    {
+        auto expired = listener("expired");
+        registry.add("application", "", KeyMatch::Prefix, expired);
+    }
+    CHECK(registry.remove(removed_id));
+    CHECK(!registry.remove(removed_id));
+    CHECK(registry.listens("application"));
+    CHECK(!registry.listens("unknown"));
+
+    Configures olds{{"db.host", "a"}, {"db.hostname", "a"}, {"cache.size", "1"}};
+    Configures news{{"db.host", "b"}, {"db.hostname", "b"}, {"db", "c"}};
+    registry.notify("application", olds, news, ConfiguresDiff(olds, news));
+
+    CHECK(received["all"].size() == 4);
+    CHECK(received["db"] == std::vector<std::string>{"db.host", "db.hostname"});
+    CHECK(received["db.host"] == std::vector<std::string>{"db.host"});
+    CHECK(received.count("other") == 0);
+    CHECK(received.count("removed") == 0);
+    CHECK(received.count("expired") == 0);
+}
+
+TEST_CASE("prometheus-metrics-format")
+{
+    AtomicHistogram histogram({1000, 1000000});
+    histogram.record(500);
+    histogram.record(1000);
+    histogram.record(2000000);
+    auto snapshot = histogram.snapshot();
+    CHECK(snapshot.counts_ == std::vector<std::uint64_t>{2, 0, 1});
+    CHECK(snapshot.count_ == 3);
+    CHECK(snapshot.sum_ == 2001500);
+
+    ClientMetrics metrics;
+    metrics.long_poll_latency_ = snapshot;
+    metrics.fetch_failures_.timeouts_ = 3;
+    metrics.resolver_.hits_ = 5;
+    metrics.staleness_["app\"lication"] = std::chrono::milliseconds(1500);
+    auto text = formatPrometheusMetrics(metrics, {{"app_id", "test"}});
+
+    CHECK(text.find("# TYPE apollo_client_long_poll_duration_seconds histogram\n") != std::string::npos);
+    CHECK(text.find("apollo_client_long_poll_duration_seconds_bucket{app_id=\"test\",le=\"0.001\"} 2\n") !=
+          std::string::npos);
+    CHECK(text.find("apollo_client_long_poll_duration_seconds_bucket{app_id=\"test\",le=\"1\"} 2\n") !=
+          std::string::npos);
+    CHECK(text.find("apollo_client_long_poll_duration_seconds_bucket{app_id=\"test\",le=\"+Inf\"} 3\n") !=
+          std::string::npos);
+    CHECK(text.find("apollo_client_long_poll_duration_seconds_sum{app_id=\"test\"} 2.0015\n") != std::string::npos);
+    CHECK(text.find("apollo_client_request_failures_total{app_id=\"test\",request=\"fetch\",cause=\"timeout\"} 3\n") !=
+          std::string::npos);
+    CHECK(text.find("apollo_client_namespace_staleness_seconds{app_id=\"test\",namespace=\"app\\\"lication\"} 1.5\n") !=
+          std::string::npos);
+    CHECK(text.find("apollo_client_resolver_hits_total{app_id=\"test\"} 5\n") != std::string::npos);
+}
+
+TEST_CASE("snapshot-cache")
+{
+    TemporaryDirectory dir;
+    SnapshotCache cache(dir.path(), "snapshot_cache_test", "default");
+    Configures configures{{"key1", "value1"}, {"key2", ""}, {"", "empty key"}, {"key3", std::string(1000, 'x')}};
+
+    SnapshotCache::Snapshot snapshot;
+    CHECK(!cache.load("application", snapshot));
+
+    REQUIRE(cache.store("application", "release-1", 7, configures));
+    REQUIRE(cache.load("application", snapshot));
+    CHECK(snapshot.release_key_ == "release-1");
+    CHECK(snapshot.notification_id_ == 7);
+    CHECK(snapshot.configures_ == configures);
+
+    // Namespaces are encoded into safe file names.
+    REQUIRE(cache.store("a/b c", "release-2", 8, {}));
+    REQUIRE(cache.load("a/b c", snapshot));
+    CHECK(snapshot.configures_.empty());
+    CHECK(cache.path("a/b c").find("a%2Fb%20c") != std::string::npos);
+
+    // A truncated file is ignored.
+    {
+        std::ofstream out(cache.path("application"), std::ios::binary | std::ios::trunc);
+        out << "APSC";
+    }
+    CHECK(!cache.load("application", snapshot));
+
+    // The releases of another cluster or label are cached apart.
+    SnapshotCache labeled(dir.path(), "snapshot_cache_test", "default", "gray");
+    CHECK(labeled.path("application") != cache.path("application"));
+    CHECK(SnapshotCache(dir.path(), "snapshot_cache_test", "other").path("application") != cache.path("application"));
+
+    // The writer keeps the latest release queued per namespace, and writes it before it is destroyed.
+    {
+        SnapshotWriter writer(labeled, nullptr);
+        writer.write("application", "release-3", 9, std::make_shared<const Configures>(Configures{{"k", "old"}}));
+        writer.write("application", "release-4", 10, std::make_shared<const Configures>(configures));
+    }
+    REQUIRE(labeled.load("application", snapshot));
+    CHECK(snapshot.release_key_ == "release-4");
+    CHECK(snapshot.configures_ == configures);
+}
+
+TEST_CASE("apollo-client-starts-from-snapshot-cache")
+{
+    TemporaryDirectory dir;
+    Configures configures{{"key", "value1"}};
+    {
+        apollo::mock::MockApolloServer server;
+        server.setRelease("namespace1", configures, "release-1");
+        server.start();
+
+        Opts opts;
+        opts.namespaces_ = {"namespace1"};
+        opts.cache_dir_ = dir.path();
+        makeApolloClient(server.url(), "snapshot_cache_client_test", std::move(opts));
+    }
+
+    // The server is gone, the client starts from the cache written by the previous one.
+    Opts opts;
+    opts.namespaces_ = {"namespace1"};
+    opts.cache_dir_ = dir.path();
+    opts.connection_timeout_ms_ = 100;
+    auto client = makeApolloClient("http://127.0.0.1:1", "snapshot_cache_client_test", std::move(opts));
+    CHECK(*client->getSnapshot("namespace1") == configures);
+}
+
+TEST_CASE("mock-server-holds-long-poll")
+{
+    apollo::mock::MockApolloServer server;
+    server.setRelease("namespace1", {{"key", "value1"}}, "release-1");
+    server.setRelease("namespace2", {{"key", "value2"}}, "release-2");
+    server.setLongPollHold(std::chrono::milliseconds(300));
+    server.start();
+
+    boost::asio::io_context io_context;
+    HttpClient client(io_context);
+    NamespaceAttributesMap namespace_attributes = {{"namespace1", std::make_shared<NamespaceAttributes>("", 1)}};
+    auto url = createNotificationsV2URL("app", server.url(), "default", "", namespace_attributes);
+
+    // Without release the long poll is held, then answered 304.
+    auto start = std::chrono::steady_clock::now();
+    auto result = client.get(url);
+    REQUIRE(!result.second);
+    CHECK(result.first.result() == http::status::not_modified);
+    CHECK(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(250));
+
+    // A release of another namespace does not end the hold, a release of the namespace does.
+    server.scheduleRelease(std::chrono::milliseconds(20), "namespace2", {{"key", "value2-new"}}, "release-3");
+    server.scheduleRelease(std::chrono::milliseconds(50), "namespace1", {{"key", "value1-new"}}, "release-4");
+    start = std::chrono::steady_clock::now();
+    result = client.get(url);
+    REQUIRE(!result.second);
+    CHECK(result.first.result() == http::status::ok);
+    CHECK(std::chrono::steady_clock::now() - start < std::chrono::milliseconds(250));
+    Notifications notifications;
+    REQUIRE(fromJsonString(result.first.body(), notifications));
+    REQUIRE(notifications.size() == 1);
+    CHECK(notifications[0].namespace_name_ == "namespace1");
+    CHECK(notifications[0].notification_id_ == 2);
+
+    // The current release key is answered 304.
+    auto configs_url = createNoCacheConfigsURL("app", server.url(), "default", "namespace1", "", "release-4", 2);
+    result = client.get(configs_url);
+    REQUIRE(!result.second);
+    CHECK(result.first.result() == http::status::not_modified);
+}
+
+TEST_CASE("mock-server-injects-failures")
+{
+    using Endpoint = apollo::mock::MockApolloServer::Endpoint;
+    using Failure = apollo::mock::MockApolloServer::Failure;
+
+    apollo::mock::MockApolloServer server;
+    server.setRelease("application", {{"key", "value"}}, "release-1");
+    server.failRequests(Endpoint::Configs, Failure::ServerError, 2);
+    server.failRequests(Endpoint::Any, Failure::MalformedBody);
+    server.failRequests(Endpoint::Configs, Failure::CloseConnection, 2);
+    server.start();
+
+    boost::asio::io_context io_context;
+    HttpClient client(io_context);
+    std::string url = server.url() + "/configs/app/default/application";
+
+    CHECK(client.get(url).first.result() == http::status::internal_server_error);
+    CHECK(client.get(url).first.result() == http::status::internal_server_error);
+
+    auto malformed = client.get(url);
+    REQUIRE(!malformed.second);
+    std::string release_key;
+    Configures configures;
+    CHECK(!fromJsonString(malformed.first.body(), release_key, configures));
+
+    // The request closed on a kept-alive connection is retried once on a new one, closed as well.
+    CHECK(client.get(url).second);
+    auto result = client.get(url);
+    REQUIRE(!result.second);
+    CHECK(result.first.result() == http::status::ok);
+    CHECK(server.failureCount() == 5);
+}
+
+TEST_CASE("httpclient-rejects-empty-json-body")
+{
+    using Endpoint = apollo::mock::MockApolloServer::Endpoint;
+    using Failure = apollo::mock::MockApolloServer::Failure;
+
+    apollo::mock::MockApolloServer server;
+    server.setRelease("application", {{"key", "value"}}, "release-1");
+    server.failRequests(Endpoint::Any, Failure::EmptyBody, 2);
+    server.start();
+
+    boost::asio::io_context io_context;
+    HttpClient client(io_context);
+
+    // A 200 with Content-Length: 0 is not an empty release.
+    auto configs = client.get<ConfigsBody>(server.url() + "/configs/app/default/application");
+    CHECK(configs.second == boost::system::errc::bad_message);
+    auto notifications = client.get<NotificationsBody>(
+        server.url() + "/notifications/v2?appId=app&cluster=default&notifications=" +
+        R"(%5B%7B%22namespaceName%22%3A%22application%22%2C%22notificationId%22%3A-1%7D%5D)");
+    CHECK(notifications.second == boost::system::errc::bad_message);
+
+    // Nor does a client start from it.
+    server.failRequests(Endpoint::Configs, Failure::EmptyBody);
+    Opts opts;
+    opts.namespaces_ = {"application"};
+    CHECK_THROWS_AS(makeApolloClient(server.url(), "test_app", std::move(opts)), std::runtime_error);
+
+    // Bodies of other statuses are still not parsed.
+    auto missing = client.get<ConfigsBody>(server.url() + "/configs/app/default/missing");
+    CHECK(!missing.second);
+    CHECK(missing.first.result() == http::status::not_found);
+}
+
+TEST_CASE("apollo-client-init-from-mock-server")
+{
+    apollo::mock::MockApolloServer server;
+    Opts opts;
+    opts.namespaces_.clear();
+    for (int i = 0; i < 20; ++i)
+    {
+        auto ns = "namespace" + std::to_string(i);
+        server.setRelease(ns, {{"key", "value" + std::to_string(i)}}, "release-" + std::to_string(i));
+        opts.namespaces_.push_back(ns);
+    }
+    opts.initial_fetch_concurrency_ = 4;
+    server.start();
+
+    auto client = makeApolloClient(server.url(), "test_app", std::move(opts));
+    for (int i = 0; i < 20; ++i)
+    {
+        auto value = client->getValue("namespace" + std::to_string(i), "key");
+        REQUIRE(value);
+        CHECK(*value == "value" + std::to_string(i));
+    }
+
+    CHECK(*client->getValueOr("namespace0", "key", "default") == "value0");
+    CHECK(*client->getValueOr("namespace0", "unknown", "default") == "default");
+    auto default_value = std::make_shared<const std::string>("default");
+    CHECK(client->getValueOr("namespace0", "key", default_value) == client->getValue("namespace0", "key"));
+    CHECK(client->getValueOr("namespace0", "unknown", default_value) == default_value);
+    CHECK(client->getValueOr("unknown", "key", default_value) == default_value);
+
+    CHECK(*client->get<std::string>("namespace0", "key") == "value0");
+    CHECK(client->get<int>("namespace0", "key") == nullptr);
+    CHECK(client->getOr<int>("namespace0", "key", 7) == 7);
+    CHECK(client->get<int>("unknown", "key") == nullptr);
+}
+
+TEST_CASE("apollo-client-init-fails-if-any-namespace-fails")
+{
+    apollo::mock::MockApolloServer server;
+    server.setRelease("namespace1", {{"key", "value"}}, "release-1");
+    server.start();
+
+    Opts opts;
+    opts.namespaces_ = {"namespace1", "missing_namespace"};
+    CHECK_THROWS_AS(makeApolloClient(server.url(), "test_app", std::move(opts)), std::runtime_error);
+}
+
+TEST_CASE("apollo-client-long-polling-publishes-changes")
+{
+    apollo::mock::MockApolloServer server;
+    server.setRelease("namespace1", {{"key", "value1"}}, "release-1");
+    server.setRelease("namespace2", {{"key", "value2"}}, "release-2");
+    server.start();
+
+    Opts opts;
+    opts.namespaces_ = {"namespace1", "namespace2"};
+    opts.update_fetch_concurrency_ = 1;
+    auto client = makeApolloClient(server.url(), "test_app", std::move(opts));
+
+    std::atomic<int> notified{0};
+    auto callback = std::make_shared<NotificationCallback>(
+        [&notified](const NamespaceType&, const Configures&, const Configures&, Changes&&) { ++notified; });
+    client->setNotificationsListener(callback);
+    std::atomic<int> key_notified{0};
+    auto key_callback = std::make_shared<NotificationCallback>(
+        [&key_notified](const NamespaceType&, const Configures&, const Configures&, Changes&&) { ++key_notified; });
+    client->addNotificationsListener("namespace1", key_callback, "key", KeyMatch::Exact);
+    client->startLongPolling(10);
+
+    server.setRelease("namespace1", {{"key", "value1-new"}}, "release-3");
+    server.setRelease("namespace2", {{"key", "value2-new"}}, "release-4");
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (notified < 2 && std::chrono::steady_clock::now() < deadline)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    client->stopLongPolling();
+
+    CHECK(notified == 2);
+    CHECK(key_notified == 1);
+    CHECK(*client->getValue("namespace1", "key") == "value1-new");
+    CHECK(*client->getValue("namespace2", "key") == "value2-new");
+
+    auto metrics = client->getLongPollingMetrics();
+    CHECK(metrics.cycles_ >= 1);
+    CHECK(metrics.namespaces_published_ == 2);
+    CHECK(metrics.fetch_failures_ == 0);
+    CHECK(metrics.last_cycle_namespaces_ >= 1);
+    CHECK(metrics.last_cycle_first_publish_ <= metrics.last_cycle_last_publish_);
+    CHECK(metrics.last_cycle_last_publish_ <= metrics.max_cycle_last_publish_);
+
+    auto listener = client->getListenerMetrics();
+    CHECK(listener.events_ == 2);
+    CHECK(listener.callbacks_ == 2);
+    CHECK(listener.queue_depth_ == 0);
+
+    auto client_metrics = client->getClientMetrics();
+    CHECK(client_metrics.long_poll_latency_.count_ >= 1);
+    CHECK(client_metrics.fetch_latency_.count_ == 4);  // Two at creation, two after the change
+    CHECK(client_metrics.propagation_delay_.count_ == 2);
+    CHECK(client_metrics.payload_size_.count_ == client_metrics.transfer_.responses_);
+    CHECK(client_metrics.fetch_failures_.http_errors_ == 0);
+    CHECK(client_metrics.staleness_.size() == 2);
+    CHECK(client_metrics.long_polling_.namespaces_published_ == 2);
+}
+
+TEST_CASE("apollo-client-long-polling-recovers-from-failures")
+{
+    using Endpoint = apollo::mock::MockApolloServer::Endpoint;
+    using Failure = apollo::mock::MockApolloServer::Failure;
+
+    apollo::mock::MockApolloServer server;
+    server.setRelease("namespace1", {{"key", "value1"}}, "release-1");
+    server.setLongPollHold(std::chrono::milliseconds(2000));
+    server.start();
+
+    Opts opts;
+    opts.namespaces_ = {"namespace1"};
+    auto client = makeApolloClient(server.url(), "test_app", std::move(opts));
+
+    // The first fetch of the release fails, long polling fetches it again.
+    server.failRequests(Endpoint::Notifications, Failure::ServerError);
+    server.failRequests(Endpoint::Configs, Failure::MalformedBody);
+    client->startLongPolling(10);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    // The held long poll is answered as soon as the release is published.
+    auto start = std::chrono::steady_clock::now();
+    server.setRelease("namespace1", {{"key", "value1-new"}}, "release-2");
+    auto deadline = start + std::chrono::seconds(5);
+    while (*client->getValue("namespace1", "key") != "value1-new" && std::chrono::steady_clock::now() < deadline)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    client->stopLongPolling();
+
+    CHECK(*client->getValue("namespace1", "key") == "value1-new");
+    CHECK(elapsed < std::chrono::milliseconds(1500));
+    CHECK(server.failureCount() == 2);
+
+    auto metrics = client->getClientMetrics();
+    CHECK(metrics.long_poll_failures_.http_errors_ == 1);
+    CHECK(metrics.fetch_failures_.parse_errors_ == 1);
+}
+
+TEST_CASE("apollo-client-long-polling-shards")
+{
+    apollo::mock::MockApolloServer server;
+    Opts opts;
+    opts.namespaces_.clear();
+    for (int i = 0; i < 40; ++i)
+    {
+        opts.namespaces_.push_back("namespace" + std::to_string(i));
+        server.setRelease(opts.namespaces_.back(), {{"key", "value"}}, "release-" + std::to_string(i));
+    }
+    server.setLongPollHold(std::chrono::milliseconds(2000));
+    server.start();
+
+    opts.long_polling_max_namespaces_ = 8;
+    auto client = makeApolloClient(server.url(), "test_app", std::move(opts));
+    CHECK(client->getLongPollingMetrics().shards_ == 5);
+    client->startLongPolling(10);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    // Every shard holds a long poll of its own, releases of different shards are published without
+    // waiting for the hold of the others to end.
+    auto start = std::chrono::steady_clock::now();
+    server.setRelease("namespace0", {{"key", "value-new"}}, "release-new-0");
+    server.setRelease("namespace9", {{"key", "value-new"}}, "release-new-9");
+    auto deadline = start + std::chrono::seconds(5);
+    while ((*client->getValue("namespace0", "key") != "value-new" ||
+            *client->getValue("namespace9", "key") != "value-new") &&
+           std::chrono::steady_clock::now() < deadline)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    // Each shard polls with its own notification ids: a second release of a shard is published as well.
+    server.setRelease("namespace9", {{"key", "value-newer"}}, "release-newer-9");
+    while (*client->getValue("namespace9", "key") != "value-newer" && std::chrono::steady_clock::now() < deadline)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    client->stopLongPolling();
+
+    CHECK(*client->getValue("namespace0", "key") == "value-new");
+    CHECK(*client->getValue("namespace9", "key") == "value-newer");
+    CHECK(*client->getValue("namespace1", "key") == "value");
+    CHECK(elapsed < std::chrono::milliseconds(1500));
+    CHECK(client->getLongPollingMetrics().cycles_ >= 3);
+}
+
+TEST_CASE("config-service-selector-prefers-fast-healthy-instances")
+{
+    using std::chrono::microseconds;
+    ConfigServiceSelector selector("http://apollo-server.com");
+    const std::string target = "/notifications/v2?appId=app&cluster=default";
+
+    // Without instance the requests go to the fallback url, whatever base they were built against.
+    CHECK(selector.route("http://other:8080" + target) == "http://apollo-server.com" + target);
+
+    selector.update({"http://10.0.0.1:8080", "http://10.0.0.2:8080/config"});
+    CHECK(selector.route("http://apollo-server.com" + target) == "http://10.0.0.1:8080" + target);
+
+    // Instances never measured are tried first, then the fastest is kept.
+    selector.record("http://10.0.0.1:8080" + target, false, microseconds(50000));
+    CHECK(selector.route("http://apollo-server.com" + target) == "http://10.0.0.2:8080/config" + target);
+    selector.record("http://10.0.0.2:8080/config" + target, false, microseconds(1000));
+    selector.record("http://10.0.0.2:8080/config" + target, false, microseconds(3000));
+    CHECK(selector.route("http://apollo-server.com" + target) == "http://10.0.0.2:8080/config" + target);
+
+    // A failure fails over at once, the failure rate decays at every discovery until the instance is retried.
+    selector.record("http://10.0.0.2:8080/config" + target, true);
+    CHECK(selector.route("http://apollo-server.com" + target) == "http://10.0.0.1:8080" + target);
+    for (int i = 0; i < 10; ++i)
+    {
+        selector.decay();
+    }
+    CHECK(selector.route("http://apollo-server.com" + target) == "http://10.0.0.2:8080/config" + target);
+
+    // Instances listed again keep their measurements.
+    selector.update({"http://10.0.0.2:8080/config", "http://10.0.0.3:8080"});
+    auto metrics = selector.metrics();
+    REQUIRE(metrics.size() == 2);
+    CHECK(metrics[0].requests_ == 3);
+    CHECK(metrics[0].failures_ == 1);
+    CHECK(metrics[0].latency_ == microseconds(1600));
+    CHECK(!metrics[0].selected_);
+    CHECK(metrics[1].requests_ == 0);
+    CHECK(metrics[1].selected_);
+
+    std::vector<std::string> urls;
+    CHECK(parseConfigServices(R"([{"appName":"APOLLO-CONFIGSERVICE","instanceId":"a","homepageUrl":"http://10.0.0.1:8080/"},
+                                  {"appName":"APOLLO-CONFIGSERVICE","instanceId":"b","homepageUrl":"not a url"},
+                                  {"appName":"APOLLO-CONFIGSERVICE","instanceId":"c"}])",
+                              urls));
+    CHECK(urls == std::vector<std::string>{"http://10.0.0.1:8080"});
+    CHECK(!parseConfigServices("{}", urls));
+    CHECK(createConfigServicesURL("http://meta-server:8080", "app id") ==
+          "http://meta-server:8080/services/config?appId=app%2520id");
+}
+
+TEST_CASE("apollo-client-routes-to-fastest-config-service")
+{
+    using Endpoint = apollo::mock::MockApolloServer::Endpoint;
+    using Failure = apollo::mock::MockApolloServer::Failure;
+
+    apollo::mock::MockApolloServer meta;
+    apollo::mock::MockApolloServer slow;
+    apollo::mock::MockApolloServer fast;
+    for (auto* server : {&slow, &fast})
+    {
+        server->setRelease("namespace1", {{"key", "value1"}}, "release-1");
+        server->setLongPollHold(std::chrono::milliseconds(2000));
+    }
+    slow.setLatency(std::chrono::milliseconds(150));
+    meta.setConfigServices({slow.url(), fast.url()});
+    for (auto* server : {&meta, &slow, &fast})
+    {
+        server->start();
+    }
+
+    Opts opts;
+    opts.namespaces_ = {"namespace1"};
+    opts.meta_server_url_ = meta.url();
+    auto client = makeApolloClient(meta.url(), "test_app", std::move(opts));
+    CHECK(*client->getValue("namespace1", "key") == "value1");
+
+    // Both instances were measured at creation, the fast one serves the long polls.
+    auto metrics = client->getClientMetrics().config_services_;
+    REQUIRE(metrics.size() == 2);
+    CHECK(metrics[0].url_ == slow.url());
+    CHECK(metrics[0].latency_ >= std::chrono::milliseconds(100));
+    CHECK(!metrics[0].selected_);
+    CHECK(metrics[1].selected_);
+
+    client->startLongPolling(10);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    auto slow_requests = slow.requestCount();
+    CHECK(fast.requestCount() > 0);
+
+    // The fast instance fails from now on: the release it notifies is fetched from the slow one.
+    fast.failRequests(Endpoint::Any, Failure::ServerError, 1000);
+    for (auto* server : {&slow, &fast})
+    {
+        server->setRelease("namespace1", {{"key", "value1-new"}}, "release-2");
+    }
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (*client->getValue("namespace1", "key") != "value1-new" && std::chrono::steady_clock::now() < deadline)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    client->stopLongPolling();
+
+    CHECK(*client->getValue("namespace1", "key") == "value1-new");
+    CHECK(slow.requestCount() > slow_requests);
+    metrics = client->getClientMetrics().config_services_;
+    REQUIRE(metrics.size() == 2);
+    CHECK(metrics[0].selected_);
+    CHECK(metrics[1].failures_ >= 1);
+}
+
+TEST_CASE("apollo-client-starts-from-cache-before-discovery")
+{
+    using Endpoint = apollo::mock::MockApolloServer::Endpoint;
+    using Failure = apollo::mock::MockApolloServer::Failure;
+
+    apollo::mock::MockApolloServer meta;
+    apollo::mock::MockApolloServer server;
+    server.setRelease("namespace1", {{"key", "value1"}}, "release-1");
+    server.setLongPollHold(std::chrono::milliseconds(2000));
+    meta.setConfigServices({server.url()});
+    meta.failRequests(Endpoint::Services, Failure::Slow);
+    server.start();
+    meta.start();
+    TemporaryDirectory dir;
+    {
+        Opts opts;
+        opts.namespaces_ = {"namespace1"};
+        opts.cache_dir_ = dir.path();
+        makeApolloClient(server.url(), "discovery_cache_test", std::move(opts));
+    }
+
+    // The cache is complete, the client starts without waiting for the slow meta server.
+    Opts opts;
+    opts.namespaces_ = {"namespace1"};
+    opts.cache_dir_ = dir.path();
+    opts.meta_server_url_ = meta.url();
+    auto started = std::chrono::steady_clock::now();
+    auto client = makeApolloClient(meta.url(), "discovery_cache_test", std::move(opts));
+    CHECK(std::chrono::steady_clock::now() - started < std::chrono::milliseconds(500));
+    CHECK(*client->getValue("namespace1", "key") == "value1");
+    CHECK(meta.requestCount() == 0);
+
+    // The config services are discovered as soon as polling starts.
+    client->startLongPolling(10);
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (client->getClientMetrics().config_services_.empty() && std::chrono::steady_clock::now() < deadline)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    client->stopLongPolling();
+
+    auto metrics = client->getClientMetrics().config_services_;
+    REQUIRE(metrics.size() == 1);
+    CHECK(metrics[0].url_ == server.url());
+}
+
+TEST_CASE("apollo-client-refresh-publishes-missed-release")
+{
+    apollo::mock::MockApolloServer server;
+    server.setRelease("namespace1", {{"key", "value1"}}, "release-1");
+    server.setRelease("namespace2", {{"key", "value2"}}, "release-2");
+    server.start();
+
+    Opts opts;
+    opts.namespaces_ = {"namespace1", "namespace2"};
+    opts.refresh_interval_ms_ = 100;
+    auto client = makeApolloClient(server.url(), "test_app", std::move(opts));
+    client->startLongPolling(10);
+
+    // Unchanged releases are answered 304.
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (client->getLongPollingMetrics().refreshes_not_modified_ < 4 && std::chrono::steady_clock::now() < deadline)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    CHECK(client->getLongPollingMetrics().refreshes_published_ == 0);
+
+    // The notification is lost, only the refresh can find the release.
+    server.setRelease("namespace2", {{"key", "value2-new"}}, "release-3", false);
+    while (*client->getValue("namespace2", "key") != "value2-new" && std::chrono::steady_clock::now() < deadline)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    client->stopLongPolling();
+
+    CHECK(*client->getValue("namespace2", "key") == "value2-new");
+    auto metrics = client->getLongPollingMetrics();
+    CHECK(metrics.refreshes_not_modified_ >= 4);
+    CHECK(metrics.refreshes_published_ == 1);
+    CHECK(metrics.cycles_ == 0);
+}
+
+TEST_CASE("apollo-client-refresh-does-not-overwrite-newer-release")
+{
+    using Endpoint = apollo::mock::MockApolloServer::Endpoint;
+    using Failure = apollo::mock::MockApolloServer::Failure;
+
+    apollo::mock::MockApolloServer server;
+    server.setRelease("namespace1", {{"key", "value1"}}, "release-1");
+    server.setLongPollHold(std::chrono::milliseconds(3000));
+    server.start();
+
+    Opts opts;
+    opts.namespaces_ = {"namespace1"};
+    opts.refresh_interval_ms_ = 300;
+    auto client = makeApolloClient(server.url(), "test_app", std::move(opts));
+
+    std::mutex mutex;
+    std::vector<std::string> published;
+    auto callback = std::make_shared<NotificationCallback>(
+        [&](const NamespaceType&, const Configures&, const Configures& news, Changes&&)
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            published.push_back(news.at("key"));
+        });
+    client->setNotificationsListener(callback);
+
+    // The first refresh is answered with the missed release-2, a second late: meanwhile long polling
+    // publishes release-3, which the late answer must not overwrite.
+    server.setRelease("namespace1", {{"key", "value2"}}, "release-2", false);
+    server.failRequests(Endpoint::Configs, Failure::Slow);
+    client->startLongPolling(10);
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (server.failureCount() == 0 && std::chrono::steady_clock::now() < deadline)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    REQUIRE(server.failureCount() == 1);
+    server.setRelease("namespace1", {{"key", "value3"}}, "release-3");
+    std::this_thread::sleep_for(std::chrono::milliseconds(1200));
+    client->stopLongPolling();
+
+    CHECK(*client->getValue("namespace1", "key") == "value3");
+    std::unique_lock<std::mutex> lock(mutex);
+    CHECK(published == std::vector<std::string>{"value3"});
+}
+
+TEST_CASE("apollo-client-stopped-by-callback-waits-for-other-callbacks")
+{
+    apollo::mock::MockApolloServer server;
+    server.setRelease("namespace1", {{"key", "value1"}}, "release-1");
+    server.setRelease("namespace2", {{"key", "value2"}}, "release-2");
+    server.start();
+
+    Opts opts;
+    opts.namespaces_ = {"namespace1", "namespace2"};
+    opts.listener_threads_ = 2;
+    auto client = makeApolloClient(server.url(), "test_app", std::move(opts));
+
+    // The callback of namespace2 stops and releases the client while the one of namespace1 still runs.
+    std::mutex mutex;
+    ClientPtr owner = client;
+    std::atomic<bool> slow_started{false};
+    std::atomic<bool> slow_finished{false};
+    std::atomic<bool> finished_before_stopped{false};
+    std::promise<void> released;
+    auto done = released.get_future();
+    auto callback = std::make_shared<NotificationCallback>(
+        [&](const NamespaceType& s_namespace, const Configures&, const Configures&, Changes&&)
+        {
+            if (s_namespace == "namespace1")
+            {
+                slow_started = true;
+                std::this_thread::sleep_for(std::chrono::milliseconds(300));
+                slow_finished = true;
+                return;
+            }
+
+            auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+            while (!slow_started && std::chrono::steady_clock::now() < deadline)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            ClientPtr stopping;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                stopping = std::move(owner);
+            }
+            stopping->stopLongPolling();
+            finished_before_stopped = slow_finished.load();
+            stopping.reset();
+            released.set_value();
+        });
+    client->setNotificationsListener(callback);
+    client->startLongPolling(10);
+    client.reset();
+
+    server.setRelease("namespace1", {{"key", "value1-new"}}, "release-3");
+    server.setRelease("namespace2", {{"key", "value2-new"}}, "release-4");
+    REQUIRE(done.wait_for(std::chrono::seconds(5)) == std::future_status::ready);
+    CHECK(finished_before_stopped);
+}
+
+TEST_CASE("apollo-client-shared-runtime")
+{
+    apollo::mock::MockApolloServer server;
+    server.setRelease("application", {{"key", "value"}}, "release-1");
+    server.start();
+
+    RuntimeOpts runtime_opts;
+    runtime_opts.thread_count_ = 2;
+    auto runtime = makeApolloRuntime(std::move(runtime_opts));
+    CHECK(runtime->threadCount() == 2);
+
+    std::atomic<int> notified{0};
+    auto callback = std::make_shared<NotificationCallback>(
+        [&notified](const NamespaceType&, const Configures&, const Configures&, Changes&&) { ++notified; });
+
+    // One client per tenant, all on the runtime's threads and keep-alive connections.
+    std::vector<ClientPtr> clients;
+    for (int i = 0; i < 10; ++i)
+    {
+        Opts opts;
+        opts.runtime_ = runtime;
+        clients.push_back(makeApolloClient(server.url(), "tenant" + std::to_string(i), std::move(opts)));
+        CHECK(*clients.back()->getValue("application", "key") == "value");
+    }
+    CHECK(server.connectionCount() == 1);
+
+    for (auto& client : clients)
+    {
+        client->setNotificationsListener(callback);
+        client->startLongPolling(10);
+    }
+
+    server.setRelease("application", {{"key", "value-new"}}, "release-2");
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (notified < 10 && std::chrono::steady_clock::now() < deadline)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+
+    for (auto& client : clients)
+    {
+        client->stopLongPolling();
+        CHECK(*client->getValue("application", "key") == "value-new");
+    }
+    CHECK(notified == 10);
+
+    // Stopped clients get no more callbacks, and can be restarted.
+    server.setRelease("application", {{"key", "value-3"}}, "release-3");
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    CHECK(notified == 10);
+
+    clients[0]->startLongPolling(10);
+    while (notified < 11 && std::chrono::steady_clock::now() < deadline)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    clients[0]->stopLongPolling();
+    CHECK(notified == 11);
+    CHECK(runtime->threadCount() == 2);
+
+    RuntimeOpts invalid;
+    invalid.thread_count_ = 0;
+    CHECK_THROWS_AS(makeApolloRuntime(std::move(invalid)), std::invalid_argument);
+}
+
+TEST_CASE("apollo-runtime-released-by-its-own-handler")
+{
+    auto runtime = std::make_shared<ApolloRuntimeImpl>(RuntimeOpts());
+    auto& io_context = runtime->ioContext();
+    std::promise<void> released;
+    auto done = released.get_future();
+
+    // The handler holds the last reference, the runtime is destroyed on one of its threads.
+    boost::asio::post(io_context,
+                      [runtime = std::move(runtime), &released]() mutable
+                      {
+                          runtime.reset();
+                          released.set_value();
+                      });
+    CHECK(done.wait_for(std::chrono::seconds(5)) == std::future_status::ready);
+}
+
+TEST_CASE("apollo-client-stop-long-polling-aborts-request-in-flight")
+{
+    apollo::mock::MockApolloServer server;
+    server.setRelease("namespace1", {{"key", "value1"}}, "release-1");
+    server.start();
+
+    Opts opts;
+    opts.namespaces_ = {"namespace1"};
+    auto client = makeApolloClient(server.url(), "test_app", std::move(opts));
+
+    // Every response is held for 5 seconds, as the server holds a long poll without changes.
+    server.setLatency(std::chrono::milliseconds(5000));
+    client->startLongPolling(10);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    auto start = std::chrono::steady_clock::now();
+    client->stopLongPolling();
+    CHECK(std::chrono::steady_clock::now() - start < std::chrono::seconds(1));
+
+    // Long polling can be started again once stopped.
+    server.setLatency(std::chrono::milliseconds(0));
+    server.setRelease("namespace1", {{"key", "value1-new"}}, "release-2");
+    client->startLongPolling(10);
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (*client->getValue("namespace1", "key") != "value1-new" && std::chrono::steady_clock::now() < deadline)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    client->stopLongPolling();
+    CHECK(*client->getValue("namespace1", "key") == "value1-new");
+}
+
 TEST_CASE("logger")
 {
     // Create a mock logger